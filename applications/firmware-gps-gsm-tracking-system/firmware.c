@@ -16,14 +16,29 @@
  * 2. GSM modem    --> BENQ MOD 9001 GSM/GPRS MODEM
  * 3. GPS receiver --> ALTINA SIRF III G-mouse GGM 309 GPS receiver
  *
- * Data at UART is received using interrupts. When communicating with GPS receiver, we use ISR to 
- * save data bytes in array. When a required number of bytes (747) have been received we disable 
- * the generation of UART RX interrupt.
+ * Data at UART is received using interrupts. The single EUSART is shared between GSM modem and GPS 
+ * receiver through a multiplexer; uart_select() is the only place where the multiplexer is switched. 
+ * Each channel has its own buffer and index. Bytes from GPS receiver go to a ring buffer from which 
+ * complete and checksum verified GPGGA sentences are taken. The GPS receiver is left only at the end 
+ * of a NMEA sentence. While GPS receiver is connected, modem is told to buffer new message 
+ * indications and flushes them when GSM modem is connected back, so no indication is lost.
+ *
+ * Fixes are converted to fixed point and kept in a small log. Besides the fix taken when a LOC? 
+ * SMS arrives, a fix is logged periodically. The reply SMS carries all logged fixes in compact 
+ * form; first fix as absolute values and every next one as difference from previous one, using 
+ * URL safe base64 characters (see README for format).
+ *
+ * The main loop is a small cooperative scheduler. Interrupt handler only raises event flags, tasks 
+ * run when the event they wait on is pending and the processor sleeps otherwise. While waiting for 
+ * a SMS the processor is in SLEEP mode and is woken up by the falling edge of the start bit on RX 
+ * line (EUSART auto wake-up). While waiting for a reply from modem/GPS receiver or for a timeout 
+ * it is in IDLE mode so that EUSART and timer 0 keep running. Watchdog is enabled and is fed by 
+ * the scheduler every time the processor wakes up.
  */
 #include <p18f4550.h>   
 
-/* Turn off features not needed to save power */
-#pragma config WDT=OFF, FOSC=ECPLLIO_EC, PLLDIV=1, CPUDIV=OSC1_PLL2
+/* Turn off features not needed to save power, watchdog period is 4 ms x 4096 = ~16 seconds */
+#pragma config WDT=ON, WDTPS=4096, FOSC=ECPLLIO_EC, PLLDIV=1, CPUDIV=OSC1_PLL2
 #pragma config MCLRE=ON, CCP2MX=OFF,VREGEN=OFF, IESO=ON,DEBUG=OFF 
 #pragma config LVP=OFF, FCMEN=ON, BOR=ON, BORV=3, PWRT=ON, PBADEN=OFF
 #pragma config STVREN=ON, XINST=OFF,EBTR0=OFF,EBTR1=OFF,EBTR2=OFF,EBTR3=OFF
@@ -45,10 +60,68 @@
 #define  LED_ON     0x01
 #define  LED_OFF    0x00
 
+/* Channels sharing EUSART */
+#define  CH_GSM     0x00
+#define  CH_GPS     0x01
+
+/* NMEA line assembler is looking for '$' */
+#define  NMEA_HUNT  0xFF
+
+/* Events raised by interrupt handler for the scheduler */
+#define  EV_UART_RX 0x01
+#define  EV_TIMER   0x02
+
+/* Low power modes entered when there is nothing to do */
+#define  IDLE_MODE  0x01
+#define  SLEEP_MODE 0x00
+
+/* Timer 0 runs at 48 MHz/4/256 = 46875 Hz, so 16 bit counter overflows after 1398 ms */
+#define  TIMER_MAX_MS       1000
+#define  START_UP_DELAY_MS  20000
+#define  REPLY_TIMEOUT_MS   1500
+#define  LED_HOLD_MS        60
+#define  NMEA_BOUNDARY_MS   250
+#define  GPS_FIX_TIMEOUT_MS 3000
+#define  URC_FLUSH_MS       200
+
+/* A fix is logged every LOG_WDT_WAKES watchdog wake-ups (~16 seconds each) */
+#define  LOG_WDT_WAKES      18
+#define  FIX_LOG_SIZE       8
+
+/* Compact report; fix count follows version character */
+#define  REPORT_VERSION     'A'
+#define  SMS_MAX_LEN        160
+#define  DELTA_MAX_LEN      28
+
 unsigned int k, loc;
-volatile unsigned int x;
 signed char a;
-unsigned char msg_index, success, gsm;
+unsigned char msg_index, success;
+unsigned char sms_pending, pending_index;
+
+/* Channel currently connected to EUSART, index in GSM reply buffer and GPS ring buffer head/tail 
+ * (8 bit so that they are read/written atomically) */
+volatile unsigned char uart_ch;
+volatile unsigned char gsm_x;
+volatile unsigned char gps_head, gps_last;
+unsigned char gps_tail;
+unsigned char nmea_len, gga_ready, gga_saved;
+unsigned char wdt_wakes;
+
+/* Position in fixed point; latitude/longitude in 1/10000 minute (north/east positive), altitude 
+ * in meters above mean sea level and time as UTC seconds of day */
+typedef struct {
+	unsigned long tod;
+	signed long lat;
+	signed long lon;
+	signed int alt;
+} fix_t;
+
+fix_t cur_fix;
+fix_t fix_log[FIX_LOG_SIZE];
+unsigned char fix_first, fix_count, fix_sent;
+unsigned char fld, msg_len;
+volatile unsigned char events;
+unsigned char timer_armed;
 
 /* Command to be sent to the GSM modem */
 const rom unsigned char at_cmd_1[] = "ATE0\r";
@@ -60,15 +133,31 @@ const rom unsigned char at_cmd_6[] = "AT+CNMI=1,1,0,0,1\r";
 const rom unsigned char at_cmd_7[] = "AT+CMGD=1,4\r";
 const rom unsigned char at_cmd_8[] = "AT+CMGR=";
 const rom unsigned char at_cmd_9[] = "AT+CMGS=";
+const rom unsigned char at_cmd_10[] = "AT+CNMI=0,1,0,0,0\r";
+const rom unsigned char at_cmd_11[] = "AT+CNMI=1,1,0,0,0\r";
+const rom unsigned char at_cmd_12[] = "AT+CMGD=";
+
+/* URL safe base64 alphabet, all characters exist in GSM 7 bit default alphabet */
+const rom unsigned char b64_tab[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
 
 /* Buffers to hold data to be processed */
 unsigned char gsm_buf[150];
 unsigned char mob_no_buf[12];
-unsigned char gps_buf[750];
-unsigned char msg_buf[45]; 
+unsigned char gps_ring[256];
+unsigned char nmea_line[83];
+unsigned char gps_buf[83];
+unsigned char msg_buf[SMS_MAX_LEN + 1]; 
 
 /* Function prototypes */
 void start_up_delay(void);
+void timer_init(void);
+void timer_start(unsigned int);
+void timer_stop(void);
+unsigned char take_events(unsigned char);
+void low_power_wait(unsigned char);
+void sleep_ms(unsigned int);
+unsigned char modem_reply_done(void);
+unsigned char wait_modem_reply(unsigned int);
 void safe_op(void);
 void gsm_uart_init(void);
 void high_isr(void); 
@@ -81,21 +170,41 @@ void cmd_3(void);
 void cmd_4(void);
 void cmd_5(void);
 void cmd_6(void);
-void long_delay(void);
 void clr_buf(void);
 void clean_sim(void);
 void wait_4_msg(void);  
+void arm_sms_wake(void);
+unsigned char find_sms_index(void);
 void get_index(void);
+void delete_msg(void);
+void urc_buffer_on(void);
+void urc_buffer_off(void);
 void read_msg(void);
 void check_msg(void);
 void get_mob_no(void);
 void send_msg_cmd(void);
 void gps_handler(void);
+void log_last_fix(void);
 void gps_uart_init(void);
+void uart_select(unsigned char);
+void wait_nmea_boundary(void);
+unsigned char hex_val(unsigned char);
+void nmea_task(void);
 void save_nmea_data(void);
 unsigned int search_gpgga(unsigned int);
-unsigned int ext_req_field(unsigned int);
+unsigned long parse_fixed(unsigned char);
+void skip_field(void);
+unsigned char ext_req_field(unsigned int);
+void log_fix(void);
+void put_fixed(unsigned long, unsigned char);
+void put_delta(signed long);
+void build_report(void);
+unsigned char sms_sent(void);
+void drop_sent_fixes(void);
 void send_loc(void); 
+void log_task(void);
+void sms_task(void);
+void led_task(void);
 
 /* Install/Define critical interrupt handler */
 #pragma code high_vector = 0x08
@@ -107,41 +216,156 @@ void interrupt_at_high_vector(void) {
 #pragma code
 
 /* Based on with whom data should be read; GPS receiver or GSM modem, the data read is placed 
- * in appropriate buffer. Then other function process data in these buffers whenever required. */
+ * in appropriate buffer. Then other function process data in these buffers whenever required. 
+ * Nothing else is done here; tasks waiting for data are told about it through event flags. */
 #pragma interrupt high_isr 
 void high_isr(void) {
-	if(gsm == ON) {
-		INTCONbits.GIEH = 0;
-		gsm_buf[x] = RCREG;              
-		x++;             
-		PIR1bits.RCIF = 0;
-		INTCONbits.GIEH = 1;          
-	}else {
-		INTCONbits.GIEH = 0;
-		gps_buf[x] = RCREG;              
-		x++;             
-		PIR1bits.RCIF = 0;
-		INTCONbits.GIEH = 1;          
-	} 
+	unsigned char data;
+
+	if(PIR1bits.RCIF == 1) {
+		/* Overrun stops reception until receiver is reset */
+		if(RCSTAbits.OERR == 1) {
+			RCSTAbits.CREN = 0;
+			RCSTAbits.CREN = 1;
+		}
+		data = RCREG;
+		if(uart_ch == CH_GSM) {
+			if(gsm_x < sizeof(gsm_buf)) {
+				gsm_buf[gsm_x] = data;
+				gsm_x++;
+			}
+		}else {
+			/* Ring of 256 bytes, 8 bit index wraps by itself. Newest byte is dropped if full, 
+			 * the sentence it belongs to then fails checksum. */
+			if((unsigned char)(gps_head + 1) != gps_tail) {
+				gps_ring[gps_head] = data;
+				gps_head++;
+			}
+			gps_last = data;
+		}
+		events |= EV_UART_RX;
+	}
+
+	if(INTCONbits.TMR0IF == 1) {
+		T0CONbits.TMR0ON = 0;
+		INTCONbits.TMR0IF = 0;
+		events |= EV_TIMER;
+	}
 }
 
 /* When the system is powered on, let it settle. */
 void start_up_delay(void) {
-	unsigned int count_s;
-	count_s = 0;
-	while(count_s != 305) {       
-		for(k=65000; k>5; k--);   
-		count_s++;
-	}  
+	sleep_ms(START_UP_DELAY_MS);
+}
+
+/* Timer 0 in 16 bit mode with 1:256 prescaler is used as one shot timer for all timeouts */
+void timer_init(void) {
+	T0CON = 0B00000111;       // timer off, 16 bit, internal clock, 1:256 prescaler
+	RCONbits.IPEN = 1;        // enable priority levels on interrupts
+	INTCON2bits.TMR0IP = 1;   // make timer 0 interrupt high priority
+	INTCONbits.TMR0IF = 0;
+	INTCONbits.TMR0IE = 1;
+	INTCONbits.GIEH = 1;
+}
+
+/* Start one shot timer, given time must not exceed TIMER_MAX_MS */
+void timer_start(unsigned int ms) {
+	unsigned int ticks;
+	ticks = 0 - (unsigned int)(((unsigned long)ms * 375) / 8);
+	T0CONbits.TMR0ON = 0;
+	INTCONbits.GIEH = 0;
+	events &= ~EV_TIMER;
+	INTCONbits.GIEH = 1;
+	INTCONbits.TMR0IF = 0;
+	TMR0H = (unsigned char)(ticks >> 8);
+	TMR0L = (unsigned char)ticks;
+	timer_armed = 1;
+	T0CONbits.TMR0ON = 1;
+}
+
+void timer_stop(void) {
+	T0CONbits.TMR0ON = 0;
+	INTCONbits.TMR0IF = 0;
+	timer_armed = 0;
+}
+
+/* Return and clear the pending events out of given mask */
+unsigned char take_events(unsigned char mask) {
+	unsigned char pending;
+	INTCONbits.GIEH = 0;
+	pending = events & mask;
+	events &= ~mask;
+	INTCONbits.GIEH = 1;
+	if(pending & EV_TIMER)
+		timer_armed = 0;
+	return pending;
 }
 
-void long_delay(void) {
-	unsigned char count_a;
-	count_a = 0;
-	while(count_a != 25) {       
-		for(k=65000; k>5; k--);   
-		count_a++;
-	}  
+/* Enter low power mode if no event is pending. Interrupts are disabled while checking events 
+ * so an event raised just before SLEEP instruction still wakes up processor; the interrupt is 
+ * serviced as soon as GIEH is set again. In SLEEP mode only a RX edge (when auto wake-up is 
+ * armed) or watchdog can wake up processor, so SLEEP_MODE must not be used while timer or 
+ * reception of data is in progress. */
+void low_power_wait(unsigned char mode) {
+	ClrWdt();
+	INTCONbits.GIEH = 0;
+	if(events == 0) {
+		OSCCONbits.IDLEN = mode;
+		Sleep();
+		Nop();
+		if(RCONbits.TO == 0)
+			wdt_wakes++;
+	}
+	INTCONbits.GIEH = 1;
+	ClrWdt();
+}
+
+/* Sleep in IDLE mode for given time */
+void sleep_ms(unsigned int ms) {
+	unsigned int chunk;
+	while(ms != 0) {
+		chunk = (ms > TIMER_MAX_MS) ? TIMER_MAX_MS : ms;
+		ms = ms - chunk;
+		timer_start(chunk);
+		while(take_events(EV_TIMER) == 0) {
+			take_events(EV_UART_RX);
+			low_power_wait(IDLE_MODE);
+		}
+	}
+}
+
+/* Check if modem has sent final result code (OK/ERROR) or SMS text prompt ("> ") */
+unsigned char modem_reply_done(void) {
+	unsigned char i, n;
+	n = gsm_x;
+	for(i=1; (i+1)<n; i++) {
+		if(gsm_buf[i-1] == LF && gsm_buf[i] == 'O' && gsm_buf[i+1] == 'K')
+			return 1;
+		if(gsm_buf[i-1] == LF && gsm_buf[i] == 'E' && gsm_buf[i+1] == 'R')
+			return 1;
+		if(gsm_buf[i] == '>' && gsm_buf[i+1] == SPACE)
+			return 1;
+	}
+	return 0;
+}
+
+/* Sleep in IDLE mode until modem has replied or timeout has occurred. This replaces fixed busy 
+ * delay after every command; processor wakes up only for received characters. */
+unsigned char wait_modem_reply(unsigned int timeout) {
+	unsigned int chunk;
+	while(timeout != 0) {
+		chunk = (timeout > TIMER_MAX_MS) ? TIMER_MAX_MS : timeout;
+		timeout = timeout - chunk;
+		timer_start(chunk);
+		while(take_events(EV_TIMER) == 0) {
+			if(take_events(EV_UART_RX) && modem_reply_done()) {
+				timer_stop();
+				return 1;
+			}
+			low_power_wait(IDLE_MODE);
+		}
+	}
+	return modem_reply_done();
 }
 
 /* Set appropriate bits for proper operation */
@@ -157,6 +381,7 @@ void safe_op(void) {
 
 /* Prepare the port for communication with GSM modem */
 void gsm_uart_init(void) {
+	unsigned char dummy;
 	INTCONbits.GIEH = 0;
 	while(INTCONbits.GIEH != 0) {
 		INTCONbits.GIEH = 0;
@@ -170,6 +395,8 @@ void gsm_uart_init(void) {
 	RCONbits.IPEN = 1;        // enable priority levels on interrupts
 	IPR1bits.RCIP = 1;        // Make receive interrupt high priority
 	IPR1bits.TXIP = 0;        // Make transmit interrupt low priority 
+	while(PIR1bits.RCIF == 1) // discard anything latched while multiplexer was switching
+		dummy = RCREG;
 	PIR1bits.RCIF = 0;        // clear receive flag
 	PIR1bits.TXIF = 0;        // clear transmit flag
 	PIE1bits.RCIE = 1;        // Enable receive interrupt         
@@ -179,6 +406,7 @@ void gsm_uart_init(void) {
 
 /* Prepare the port for communication with GPS receiver */
 void gps_uart_init(void) {   
+	unsigned char dummy;
 	INTCONbits.GIEH = 0;
 	while(INTCONbits.GIEH != 0) {
 		INTCONbits.GIEH = 0;
@@ -190,12 +418,64 @@ void gps_uart_init(void) {
 	SPBRG=155;                // 155 for 48MHz ---> 4800 baud
 	RCONbits.IPEN = 1;        // enable priority levels on interrupts
 	IPR1bits.RCIP = 1;        // Make receive interrupt high priority
+	while(PIR1bits.RCIF == 1) // discard anything latched while multiplexer was switching
+		dummy = RCREG;
 	PIR1bits.RCIF = 0;        // clear receive flag
 	PIE1bits.RCIE = 1;        // Enable receive interrupt   
 	INTCONbits.PEIE = 1;      // Enable peripherals interrupt            
 	INTCONbits.GIEH = 1;      // Enable global interrupt 
 }
 
+/* Connect EUSART to the given channel. GPS receiver is left only at the end of a NMEA sentence. 
+ * Bytes still in receive FIFO belong to the channel being left; those from GSM modem are stored 
+ * in its buffer while those from GPS receiver (start of next sentence at most) are discarded, so 
+ * no byte ends up in the buffer of other channel. */
+void uart_select(unsigned char ch) {
+	unsigned char data;
+
+	if(ch == uart_ch)
+		return;
+
+	if(uart_ch == CH_GPS)
+		wait_nmea_boundary();
+
+	PIE1bits.RCIE = 0;
+	while(PIR1bits.RCIF == 1) {
+		data = RCREG;
+		if(uart_ch == CH_GSM && gsm_x < sizeof(gsm_buf)) {
+			gsm_buf[gsm_x] = data;
+			gsm_x++;
+		}
+	}
+
+	if(ch == CH_GSM) {
+		PORTBbits.RB0 = 1;        // A/B ---> gsm modem connected
+		uart_ch = CH_GSM;
+		gsm_uart_init();
+	}else {
+		PORTBbits.RB0 = 0;        // A/B ---> gps receiver connected
+		nmea_len = NMEA_HUNT;     // a partial sentence may be arriving, skip it
+		gps_last = NULL;
+		uart_ch = CH_GPS;
+		gps_uart_init();
+	}
+}
+
+/* Wait until last byte received from GPS receiver is end of a NMEA sentence. A sentence takes 
+ * at most 170 ms at 4800 baud; if receiver is silent there is nothing to wait for. */
+void wait_nmea_boundary(void) {
+	if(gps_last == LF)
+		return;
+	timer_start(NMEA_BOUNDARY_MS);
+	while(take_events(EV_TIMER) == 0) {
+		if(take_events(EV_UART_RX) && gps_last == LF) {
+			timer_stop();
+			return;
+		}
+		low_power_wait(IDLE_MODE);
+	}
+}
+
 /* Configure GPIO pins to control multiplexer (share RX pin of PIC18F4550 between 
  * GSM Modem and GPS receiver) */
 void gpio_port(void) {         
@@ -283,50 +563,50 @@ void modem_init(void) {
 
 /* Turn Echo off ("ATE0\r") */
 void cmd_1(void) { 
-	x = 0;
-	while(x != 0) 
-		x=0;
+	gsm_x = 0;
+	while(gsm_x != 0) 
+		gsm_x=0;
 	for(a=0; a<5; a++)             
 		tx_char(at_cmd_1[a]);                            
-	long_delay();   
+	wait_modem_reply(REPLY_TIMEOUT_MS);   
 }
 
 /* Just ping modem for basic AT command ("AT\r") */
 void cmd_2(void) { 
-	x = 0;
-	while (x != 0) 
-		x=0;
+	gsm_x = 0;
+	while (gsm_x != 0) 
+		gsm_x=0;
 	for(a=0; a<3; a++)             
 		tx_char(at_cmd_2[a]);                       
-	long_delay();            
+	wait_modem_reply(REPLY_TIMEOUT_MS);            
 }
 
 /* Put in SMS text mode ("AT+CMGF=1\r") */
 void cmd_3(void) { 
-	x = 0;
-	while( x!= 0) 
-		x=0;
+	gsm_x = 0;
+	while( gsm_x!= 0) 
+		gsm_x=0;
 	for(a=0; a<10; a++)             
 		tx_char(at_cmd_3[a]);                         
-	long_delay();            
+	wait_modem_reply(REPLY_TIMEOUT_MS);            
 }
 
 /* Configure to send English character SMS and some more parameters 
  * ("AT+CSMP=17,168,0,0\r") */
 void cmd_4(void) {
-	x = 0;
-	while(x!= 0) 
-		x=0;  
+	gsm_x = 0;
+	while(gsm_x!= 0) 
+		gsm_x=0;  
 	for(a=0; a<19; a++)             
 		tx_char(at_cmd_4[a]);                          
-	long_delay();                           
+	wait_modem_reply(REPLY_TIMEOUT_MS);                           
 }
 
 /* Set SMS message storage area as SIM for every purpose ("AT+CPMS=") */
 void cmd_5(void) { 
-	x = 0;
-	while(x != 0) 
-		x=0;
+	gsm_x = 0;
+	while(gsm_x != 0) 
+		gsm_x=0;
 	for(a=0; a<8; a++)             
 		tx_char(at_cmd_5[a]);              
 	tx_char('"');
@@ -344,17 +624,17 @@ void cmd_5(void) {
 	tx_char('M');
 	tx_char('"'); 
 	tx_char(CR);              
-	long_delay();                                                    
+	wait_modem_reply(REPLY_TIMEOUT_MS);                                                    
 }
 
 /* Set the new message indicators ("AT+CNMI=1,1,0,0,1\r") */
 void cmd_6(void) { 
-	x = 0;
-	while(x != 0) 
-		x=0;
+	gsm_x = 0;
+	while(gsm_x != 0) 
+		gsm_x=0;
 	for(a=0; a<18; a++)             
 		tx_char(at_cmd_6[a]);                
-	long_delay();                                          
+	wait_modem_reply(REPLY_TIMEOUT_MS);                                          
 }
 
 /* Transmits a single character out of UART port */
@@ -373,53 +653,109 @@ void clr_buf(void) {
 
 /* Delete all SMS from SIM */
 void clean_sim(void) {
-	x = 0;
-	while(x!= 0) 
-		x=0;
+	gsm_x = 0;
+	while(gsm_x!= 0) 
+		gsm_x=0;
 	for(a=0; a<12; a++)             
 		tx_char(at_cmd_7[a]);                
-	long_delay();  
-	long_delay();
+	wait_modem_reply(2 * REPLY_TIMEOUT_MS);
 	cmd_2();                  
 	if(gsm_buf[13]=='3' && gsm_buf[13]=='1' && gsm_buf[13]=='4' )                            
-		long_delay();                                                       
+		sleep_ms(REPLY_TIMEOUT_MS);                                                       
 }
 
-/* Wait until a SMS arrives */
-void wait_4_msg(void) {
+/* Arm EUSART auto wake-up so that new message indication ("+CMTI") from modem wakes up the 
+ * processor from SLEEP mode. The characters received while oscillator/PLL is starting up may 
+ * be lost, get_index() takes care of this. */
+void arm_sms_wake(void) {
 	unsigned char dummy;
-	x = 0;
-	while(x != 0) 
-		x=0;
+	gsm_x = 0;
+	while(gsm_x != 0) 
+		gsm_x=0;
 	dummy = RCREG;
-	PIR1bits.RCIF = 0;
-	while(PIR1bits.RCIF != 1);
-	long_delay();                 
+	take_events(EV_UART_RX);
+	BAUDCONbits.WUE = 1;
+}
+
+/* Wait until the new message indication has been received completely */
+void wait_4_msg(void) {
+	wait_modem_reply(REPLY_TIMEOUT_MS);                 
 }
 
-/* Get the index of SMS received */
+/* Look for new message indication ("+CMTI: "SM",<index>") in GSM buffer and return index 
+ * of new SMS or NULL if not found */
+unsigned char find_sms_index(void) {
+	unsigned char i, n;
+	n = gsm_x;
+	for(i=0; (i+4)<n; i++) {
+		if(gsm_buf[i] == 'S' && gsm_buf[i+1] == 'M' && gsm_buf[i+3] == COMMA)
+			return gsm_buf[i+4];
+	}
+	return NULL;
+}
+
+/* Get the index of SMS received. As SIM is cleaned before waiting for a new SMS, if the indication 
+ * was garbled while waking up, the new SMS is at first location. */
 void get_index(void) {
-	x = 0;
-	while(x!= 0) 
-		x=0;
-	while(gsm_buf[x] != 'S')             
-		x++;             
-	msg_index = gsm_buf[x+4];           
+	msg_index = find_sms_index();
+	if(msg_index == NULL)
+		msg_index = '1';
+}
+
+/* Delete the SMS just handled from SIM ("AT+CMGD="). Other SMS that may have arrived meanwhile 
+ * are kept. */
+void delete_msg(void) {
+	gsm_x = 0;
+	while(gsm_x != 0) 
+		gsm_x=0;
+	for(a=0; a<8; a++)             
+		tx_char(at_cmd_12[a]);                    
+	tx_char(msg_index);        
+	tx_char(CR);               
+	wait_modem_reply(2 * REPLY_TIMEOUT_MS); 
+}
+
+/* Ask modem to buffer new message indications as GPS receiver is about to be connected to 
+ * EUSART and modem output can not be seen ("AT+CNMI=0,1,0,0,0\r") */
+void urc_buffer_on(void) {
+	gsm_x = 0;
+	while(gsm_x != 0) 
+		gsm_x=0;
+	for(a=0; a<18; a++)             
+		tx_char(at_cmd_10[a]);                
+	wait_modem_reply(REPLY_TIMEOUT_MS);                                          
+}
+
+/* Ask modem to send new message indications directly again and flush the ones buffered while 
+ * GPS receiver was connected ("AT+CNMI=1,1,0,0,0\r"). If a SMS arrived meanwhile, remember its 
+ * index so that it is handled right after the current one. */
+void urc_buffer_off(void) {
+	unsigned char index;
+	gsm_x = 0;
+	while(gsm_x != 0) 
+		gsm_x=0;
+	for(a=0; a<18; a++)             
+		tx_char(at_cmd_11[a]);                
+	wait_modem_reply(REPLY_TIMEOUT_MS);                                          
+	sleep_ms(URC_FLUSH_MS);
+	index = find_sms_index();
+	if(index != NULL) {
+		sms_pending = 1;
+		pending_index = index;
+	}
 }
 
 /* Once a SMS message has arrived and its index has been found, read it from 
  * SIM to local buffer ("AT+CMGR="). */
 void read_msg(void) { 
-	x = 0;
-	while( x!= 0) 
-		x=0;
+	gsm_x = 0;
+	while( gsm_x!= 0) 
+		gsm_x=0;
 	for(a=0;a<8;a++)             
 		tx_char(at_cmd_8[a]);                    
 	tx_char(msg_index);        
 	tx_char(CR);               
-	long_delay();          
-	long_delay();
-	long_delay(); 
+	wait_modem_reply(3 * REPLY_TIMEOUT_MS); 
 }
 
 /* Once a SMS message is received, validate it to contain LOC? string to authenticate sender */
@@ -429,6 +765,10 @@ void check_msg(void) {
 	b = 0;
 	count_c = 0;     
 	while(count_c != 8) {       
+		if(b > 120) {
+			success = 0;
+			return;
+		}
 		if(gsm_buf[b] == '"') {
 			count_c++;
 			b++;
@@ -436,8 +776,13 @@ void check_msg(void) {
 			b++;
 		}
 	}
-	while(gsm_buf[b]!= LF)          
+	while(gsm_buf[b]!= LF) {
+		if(b > 120) {
+			success = 0;
+			return;
+		}
 		b++;          
+	}
 	if(gsm_buf[b+1]=='L' && gsm_buf[b+2]=='O' && gsm_buf[b+3]=='C' && gsm_buf[b+4]=='?')
 		success = 1;          
 	else          
@@ -468,51 +813,129 @@ void send_msg_cmd(void) {
 		tx_char(mob_no_buf[a]);                    
 	tx_char('"');
 	tx_char(CR);
-	long_delay();               
+	wait_modem_reply(REPLY_TIMEOUT_MS);               
 } 
 
-/* Configure the UART for communication with GPS receiver, toggle the multiplxer GPIO,
- * save data from GPS receiver, search for GPGGA string and extract latitude, longitude 
- * and altitude from this string. */
+/* Let modem buffer new message indications, connect GPS receiver to UART, wait for a GPGGA 
+ * sentence, connect GSM modem back, extract latitude, longitude and altitude from the sentence 
+ * and log this fix. If no new sentence arrived in time nothing is logged, the previous sentence 
+ * was logged when it arrived and logging it again would add a duplicate point to the report. */
 void gps_handler(void) {                    
-	gps_uart_init();        
-	PORTBbits.RB0 = 0;           // A/B // gps gets connected to UART port.    
+	urc_buffer_on();
+	uart_select(CH_GPS);
 	save_nmea_data();                            
-	loc = search_gpgga(0);  
-	ext_req_field(loc);             
+	uart_select(CH_GSM);
+	urc_buffer_off();
+	if(gga_ready == 1) {
+		loc = search_gpgga(0);  
+		if(ext_req_field(loc) == 1)
+			log_fix();
+	}
+}
+
+/* Reply to a location request must carry a location; if fix log is empty (all fixes already 
+ * reported and no new one in time) log the last known fix from the previous sentence in gps_buf */
+void log_last_fix(void) {
+	if(fix_count == 0 && gga_saved == 1) {
+		loc = search_gpgga(0);  
+		if(ext_req_field(loc) == 1)
+			log_fix();
+	}
+}
+
+/* Convert ASCII hex digit to its value */
+unsigned char hex_val(unsigned char c) {
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	if(c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return 0xFF;
+}
+
+/* Assemble NMEA sentences from bytes in GPS ring buffer. A complete GPGGA sentence whose 
+ * checksum matches is copied to gps_buf (null terminated). gps_buf always holds the latest good 
+ * sentence, so a previous fix is still available if receiver does not send a new one in time. */
+void nmea_task(void) {
+	unsigned char c, i, sum;
+
+	while(gps_tail != gps_head) {
+		c = gps_ring[gps_tail];
+		gps_tail++;
+
+		if(c == '$') {
+			nmea_line[0] = c;
+			nmea_len = 1;
+		}else if(nmea_len == NMEA_HUNT) {
+			continue;
+		}else if(c == CR || c == LF) {
+			/* "$GPGGA,...*CS" has at least 10 characters */
+			if(nmea_len > 9 && nmea_line[nmea_len-3] == '*' && nmea_line[1] == 'G' 
+					&& nmea_line[2] == 'P' && nmea_line[3] == 'G' && nmea_line[4] == 'G' 
+					&& nmea_line[5] == 'A') {
+				sum = 0;
+				for(i=1; i<(nmea_len-3); i++)
+					sum ^= nmea_line[i];
+				if(((hex_val(nmea_line[nmea_len-2]) << 4) | hex_val(nmea_line[nmea_len-1])) == sum) {
+					for(i=0; i<nmea_len; i++)
+						gps_buf[i] = nmea_line[i];
+					gps_buf[i] = NULL;
+					gga_ready = 1;
+					gga_saved = 1;
+				}
+			}
+			nmea_len = NMEA_HUNT;
+		}else if(nmea_len < (sizeof(nmea_line) - 1)) {
+			nmea_line[nmea_len] = c;
+			nmea_len++;
+		}else {
+			nmea_len = NMEA_HUNT; // longer than a NMEA sentence can be
+		}
+	}
 }
 
-/* Keep clearing interrupt bit until handful of data characters have been received 
- * from GPS receiver that can be parsed to look for GPGGA string */
+/* Sleep in IDLE mode and assemble sentences as bytes arrive from GPS receiver until a new 
+ * GPGGA sentence has been received. Receiver sends it every second; if it does not, give up 
+ * after timeout leaving gga_ready 0; the last one received stays in gps_buf (gga_saved). */
 void save_nmea_data(void) {      
-	x = 0;
-	while(x!= 0) 
-		x=0;
-	while(x != 747);
-	INTCONbits.GIEH = 0;        
+	unsigned int waited;
+	gga_ready = 0;
+	waited = 0;
+	while(gga_ready == 0 && waited < GPS_FIX_TIMEOUT_MS) {
+		timer_start(TIMER_MAX_MS);
+		while(gga_ready == 0 && take_events(EV_TIMER) == 0) {
+			if(take_events(EV_UART_RX))
+				nmea_task();
+			else
+				low_power_wait(IDLE_MODE);
+		}
+		waited = waited + TIMER_MAX_MS;
+	}
+	timer_stop();
 }
 
-/* From the data received try to figure out starting position of GPGGA string */
+/* From the data received try to figure out starting position of GPGGA string. Returns 0 
+ * if there is none. */
 unsigned int search_gpgga(unsigned int y) {
 
 	/* The y has starting address from where it should start searching '$' character */
-	while(gps_buf[y] != '$') {
+	while((y + 5) < sizeof(gps_buf)) {
+		/* check for gpgga string */
+		if(gps_buf[y]=='$' && gps_buf[y+1]=='G' && gps_buf[y+2]=='P' && gps_buf[y+3]=='G'
+				&& gps_buf[y+4]=='G' && gps_buf[y+5]=='A') {
+			return(y+5); // return address of 'A'
+		}
 		y++;
 	}
-
-	/* check for gpgga string */
-	if(gps_buf[y+1]=='G' && gps_buf[y+2]=='P' && gps_buf[y+3]=='G'
-			&& gps_buf[y+4]=='G' && gps_buf[y+5]=='A') {
-		return(y+5); // return address of 'A'
-	}else {
-		search_gpgga(y+10); // start search from new location in buffer
-	}
+	return 0;
 }
 
 /* Send location info to given mobile number using SMS */
 void send_loc(void) {
 	unsigned char c;
 	c = 0;
+	gsm_x = 0;
+	while(gsm_x != 0) 
+		gsm_x=0;
 	/* We have appended null character already at the end so send data 
 	 * until it is found */
 	while(msg_buf[c] != NULL) {
@@ -521,142 +944,286 @@ void send_loc(void) {
 	}
 
 	tx_char(CTRLZ); 
-	long_delay();    
+	wait_modem_reply(3 * REPLY_TIMEOUT_MS);    
 }
 
-/* Parse the data received from GPS receiver and extract required fields */
-unsigned int ext_req_field(unsigned int p) { 
-	unsigned char comma_count;  // variable to hold count of commas.
-	unsigned char z;
+/* Check if modem has confirmed that SMS has been sent ("+CMGS: <mr>") */
+unsigned char sms_sent(void) {
+	unsigned char i, n;
+	n = gsm_x;
+	for(i=0; (i+4)<n; i++) {
+		if(gsm_buf[i] == 'C' && gsm_buf[i+1] == 'M' && gsm_buf[i+2] == 'G' && gsm_buf[i+3] == 'S' 
+				&& gsm_buf[i+4] == ':')
+			return 1;
+	}
+	return 0;
+}
 
-	// cross check returned value also.
-	if( gps_buf[p] == 'A')  {
-		p=p+2;
-		while(gps_buf[p] != COMMA){
-			p++;                           
+/* Parse unsigned decimal number in GPGGA field starting at gps_buf[fld], as fixed point number 
+ * with given number of fraction digits (extra digits are dropped, missing ones are taken as 0). 
+ * fld is moved to the start of next field. */
+unsigned long parse_fixed(unsigned char digits) {
+	unsigned long val;
+	unsigned char frac, c;
+	val = 0;
+	frac = 0xFF;
+	while(fld < sizeof(gps_buf)) {
+		c = gps_buf[fld];
+		if(c == COMMA || c == '*' || c == NULL)
+			break;
+		fld++;
+		if(c == '.') {
+			frac = 0;
+		}else if(c >= '0' && c <= '9') {
+			if(frac == 0xFF) {
+				val = (val * 10) + (c - '0');
+			}else if(frac < digits) {
+				val = (val * 10) + (c - '0');
+				frac++;
+			}
 		}
+	}
+	if(frac == 0xFF)
+		frac = 0;
+	while(frac < digits) {
+		val = val * 10;
+		frac++;
+	}
+	if(fld < sizeof(gps_buf) && gps_buf[fld] == COMMA)
+		fld++;
+	return val;
+}
 
-		p++;                // p now have address of 1st digit of
-		z=0;                // latitude coordinate.
-		msg_buf[z]='L';     // append 'LA' to msg_buf to indicate
-		z++;                // that following value is latitude.
-		msg_buf[z]='A';
-		z++;
-		msg_buf[z]=SPACE;
-		z++;
-
-		/* Save latitude coordinates */
-		while(gps_buf[p] != COMMA) {
-			msg_buf[z]=gps_buf[p]; 
-			z++;
-			p++;
-		}
+/* Move fld to the start of next field */
+void skip_field(void) {
+	while(fld < sizeof(gps_buf) && gps_buf[fld] != COMMA && gps_buf[fld] != NULL)
+		fld++;
+	if(fld < sizeof(gps_buf) && gps_buf[fld] == COMMA)
+		fld++;
+}
 
-		p=p+3;               // p now have address of 1st digit of
-		msg_buf[z]=COMMA;
-		z++;
-		msg_buf[z]=CR;
-		z++;
-		msg_buf[z]=LF;
-		z++;
-		msg_buf[z]='L';      // longitude coordinate.
-		z++;
-		msg_buf[z]='O';      // append 'LO' to msg_buf to indicate
-		z++;                 // that following value is longitude.
-		msg_buf[z]=SPACE;
-		z++;
-
-		/* Save longitude coordinate */
-		while(gps_buf[p] != COMMA) {
-			msg_buf[z]=gps_buf[p];
-			z++;
-			p++;
+/* Parse the data received from GPS receiver and extract required fields (time, latitude, 
+ * longitude and altitude) in cur_fix. Return 1 if receiver has a valid fix. 
+ * $GPGGA,hhmmss.sss,ddmm.mmmm,N,dddmm.mmmm,E,fix,sats,hdop,alt,M,... */
+unsigned char ext_req_field(unsigned int p) { 
+	unsigned long val;
+	unsigned char fix_ok, negative;
+
+	// cross check returned value also.
+	if(gps_buf[p] != 'A')
+		return 0;
+	fld = (unsigned char)p + 2;
+
+	/* UTC time */
+	val = parse_fixed(0);
+	cur_fix.tod = ((val / 10000) * 3600) + (((val / 100) % 100) * 60) + (val % 100);
+
+	/* Latitude, ddmm.mmmm -> 1/10000 minute */
+	val = parse_fixed(4);
+	cur_fix.lat = (signed long)(((val / 1000000) * 600000) + (val % 1000000));
+	if(gps_buf[fld] == 'S')
+		cur_fix.lat = -cur_fix.lat;
+	skip_field();
+
+	/* Longitude, dddmm.mmmm -> 1/10000 minute */
+	val = parse_fixed(4);
+	cur_fix.lon = (signed long)(((val / 1000000) * 600000) + (val % 1000000));
+	if(gps_buf[fld] == 'W')
+		cur_fix.lon = -cur_fix.lon;
+	skip_field();
+
+	/* Position fix indicator, 0 means fix not available */
+	fix_ok = (gps_buf[fld] >= '1' && gps_buf[fld] <= '9') ? 1 : 0;
+	skip_field();
+	skip_field();             // satellites used
+	skip_field();             // HDOP
+
+	/* MSL altitude in meters, fraction dropped */
+	negative = 0;
+	if(gps_buf[fld] == '-') {
+		negative = 1;
+		fld++;
+	}
+	cur_fix.alt = (signed int)parse_fixed(0);
+	if(negative == 1)
+		cur_fix.alt = -cur_fix.alt;
+
+	return fix_ok;
+}
+
+/* Append cur_fix to fix log, oldest fix is dropped if log is full */
+void log_fix(void) {
+	unsigned char slot;
+	if(fix_count == FIX_LOG_SIZE) {
+		fix_first = (fix_first + 1) % FIX_LOG_SIZE;
+		fix_count--;
+	}
+	slot = (fix_first + fix_count) % FIX_LOG_SIZE;
+	fix_log[slot] = cur_fix;
+	fix_count++;
+}
+
+/* Append unsigned value to msg_buf as given number of base64 characters, most significant 
+ * 6 bits first */
+void put_fixed(unsigned long v, unsigned char nchars) {
+	while(nchars != 0) {
+		nchars--;
+		msg_buf[msg_len] = b64_tab[(unsigned char)(v >> (nchars * 6)) & 0x3F];
+		msg_len++;
+	}
+}
+
+/* Append signed difference to msg_buf. Value is zigzag encoded (0, -1, 1, -2 ... -> 0, 1, 2, 3 ...) 
+ * and sent 5 bits per character, least significant first; bit 5 tells that more characters 
+ * follow. Small differences take single character. */
+void put_delta(signed long d) {
+	unsigned long z;
+	z = (d < 0) ? ((((unsigned long)(-(d + 1))) << 1) | 1) : (((unsigned long)d) << 1);
+	while(z > 0x1F) {
+		msg_buf[msg_len] = b64_tab[0x20 | ((unsigned char)z & 0x1F)];
+		msg_len++;
+		z = z >> 5;
+	}
+	msg_buf[msg_len] = b64_tab[(unsigned char)z];
+	msg_len++;
+}
+
+/* Build compact report of logged fixes in msg_buf, oldest first. First fix is absolute: time 
+ * (3 chars), latitude + 90 degree (5 chars), longitude + 180 degree (5 chars), altitude + 1000 m 
+ * (3 chars). Every next fix is differences from previous one in time, latitude, longitude and 
+ * altitude. As many fixes as fit in one SMS are added, fix_sent tells how many. */
+void build_report(void) {
+	unsigned char i, slot, prev;
+	signed long dt;
+
+	msg_len = 0;
+	msg_buf[msg_len] = REPORT_VERSION;
+	msg_len++;
+	msg_len++;                // fix count, filled below
+
+	fix_sent = 0;
+	for(i=0; i<fix_count; i++) {
+		slot = (fix_first + i) % FIX_LOG_SIZE;
+		if(i == 0) {
+			put_fixed(fix_log[slot].tod, 3);
+			put_fixed((unsigned long)(fix_log[slot].lat + 54000000), 5);
+			put_fixed((unsigned long)(fix_log[slot].lon + 108000000), 5);
+			put_fixed((unsigned long)(fix_log[slot].alt + 1000), 3);
+		}else {
+			if((msg_len + DELTA_MAX_LEN) > SMS_MAX_LEN)
+				break;
+			prev = (slot + FIX_LOG_SIZE - 1) % FIX_LOG_SIZE;
+			dt = (signed long)fix_log[slot].tod - (signed long)fix_log[prev].tod;
+			if(dt < 0)
+				dt = dt + 86400;      // crossed UTC midnight
+			put_delta(dt);
+			put_delta(fix_log[slot].lat - fix_log[prev].lat);
+			put_delta(fix_log[slot].lon - fix_log[prev].lon);
+			put_delta((signed long)fix_log[slot].alt - (signed long)fix_log[prev].alt);
 		}
+		fix_sent++;
+	}
 
-		p++;
-		comma_count = 0;
+	msg_buf[1] = b64_tab[fix_sent];
+	msg_buf[msg_len] = NULL;
+}
 
-		/* After this loop ends the p will contain  address of first digit of altitude coordinates */ 
-		while(comma_count != 4) {
-			if(gps_buf[p] == COMMA ) {
-				comma_count++;
-				p++;
-			}else {
-				p++;
-			}
-		} 
-		msg_buf[z]=COMMA;
-		z++;
-		msg_buf[z]=CR;
-		z++; 
-		msg_buf[z]=LF;
-		z++;          
-		msg_buf[z]='A';        // append 'AL' to msg_buf to indicate
-		z++;                   // that following value is altitude.
-		msg_buf[z]='L'; 
-		z++;
-		msg_buf[z]=SPACE;
-		z++;
-
-		/* Save altitude coordinate */
-		while(gps_buf[p] != COMMA ) {
-			msg_buf[z] = gps_buf[p];
-			z++;
-			p++;
-		} 
-		msg_buf[z]=COMMA;
-		z++; 
-		msg_buf[z]= NULL;// append null character to mark end
+/* Remove fixes delivered in last report from log */
+void drop_sent_fixes(void) {
+	fix_first = (fix_first + fix_sent) % FIX_LOG_SIZE;
+	fix_count = fix_count - fix_sent;
+	fix_sent = 0;
+}
 
+/* Runs periodically to log a fix, so that the next report shows where the tracker has been */
+void log_task(void) {
+	gps_handler();
+	if(sms_pending == 0)
+		arm_sms_wake();
+}
+
+/* Runs when modem sends something while we are waiting for a SMS; reads the SMS and if it 
+ * asks for location, replies with location. Prepares for next SMS before returning. */
+void sms_task(void) {
+	PORTAbits.RA0 = LED_ON;
+	if(sms_pending == 1) {
+		/* Indication was flushed by modem after GPS receiver was disconnected */
+		sms_pending = 0;
+		msg_index = pending_index;
 	}else {
-		/* Something went wrong, start searching $gpgga again */
-		search_gpgga(p+10);
+		wait_4_msg();       
+		get_index();  
+	}
+	read_msg();
+	check_msg();
+	PORTAbits.RA6 = LED_ON;
+	if(success == 1) {  
+		/* Find location before asking modem to send SMS, so that modem does not wait 
+		 * for SMS text while GPS receiver is connected */
+		get_mob_no();      
+		PORTCbits.RC0 = LED_ON; 
+		gps_handler();
+		log_last_fix();
+		PORTCbits.RC1 = LED_ON; 
+		build_report();
+		send_msg_cmd();           
+		send_loc(); 
+		if(sms_sent() == 1)
+			drop_sent_fixes();
+		PORTCbits.RC2 = LED_ON;
 	}
+
+	delete_msg();
+	clr_buf(); 
+	timer_start(LED_HOLD_MS);
+	if(sms_pending == 0)
+		arm_sms_wake();
+}
+
+/* Runs when LED hold timer expires */
+void led_task(void) {
+	PORTAbits.RA0 = LED_OFF;
+	PORTAbits.RA6 = LED_OFF;
+	PORTCbits.RC0 = LED_OFF;
+	PORTCbits.RC1 = LED_OFF;
+	PORTCbits.RC2 = LED_OFF;  
 }
 
 /* Entry point */
 void main(void) {
+	unsigned char pending;
+
+	timer_init();
 	start_up_delay();      
 	safe_op();
+	uart_ch = CH_GSM;  
 	gsm_uart_init();    
 	gpio_port(); 
 	PORTBbits.RB0 = 1; // A/B // gsm modem connected      
-	gsm = ON;  
 	modem_init();
 	PORTAbits.RA1 = LED_ON;
+	clr_buf(); 
+	clean_sim();
+	arm_sms_wake();
 
-	/* Keep looping until powered off */
+	/* Keep looping until powered off; run tasks whose event is pending otherwise sleep. Deep 
+	 * sleep is possible only when no timer is running. */
 	while(1) {
-		clr_buf(); 
-		clean_sim();
-		PORTAbits.RA0 = LED_ON;
-		wait_4_msg();       
-		get_index();  
-		read_msg();
-		check_msg();
-		PORTAbits.RA6 = LED_ON;
-		if(success == 1) {  
-			get_mob_no();      
-			send_msg_cmd();           
-			gsm = OFF;
-			PORTCbits.RC0 = LED_ON; 
-			gps_handler();
-			PORTCbits.RC1 = LED_ON; 
-			gsm = ON;
-			gsm_uart_init();  
-			PORTBbits.RB0 = 1;        // A/B ---> gsm modem connected  
-			INTCONbits.GIEH = 1;      // Enable all unmasked interrupt           
-			send_loc(); 
-			PORTCbits.RC2 = LED_ON;
-			for(k=60000; k>5; k--); 
-			PORTAbits.RA0 = LED_OFF;
-			PORTAbits.RA6 = LED_OFF;
-			PORTCbits.RC0 = LED_OFF;
-			PORTCbits.RC1 = LED_OFF;
-			PORTCbits.RC2 = LED_OFF;  
-		}else {
-			PORTAbits.RA0 = LED_OFF;
-			PORTAbits.RA6 = LED_OFF;
-		} 
+		ClrWdt();
+		pending = take_events(EV_UART_RX | EV_TIMER);
+		if((pending & EV_UART_RX) || sms_pending == 1)
+			sms_task();
+		if(pending & EV_TIMER)
+			led_task();
+		if(wdt_wakes >= LOG_WDT_WAKES) {
+			wdt_wakes = 0;
+			log_task();
+		}
+		if(pending == 0 && sms_pending == 0) {
+			if(timer_armed == 1)
+				low_power_wait(IDLE_MODE);
+			else
+				low_power_wait(SLEEP_MODE);
+		}
 	}            	                 
 }
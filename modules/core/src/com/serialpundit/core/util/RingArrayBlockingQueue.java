@@ -57,8 +57,9 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
     private int headUpdateStatus = 0;
     private int tailUpdateStatus = 0;
 
-    // condition used with blocking await/signal
+    // conditions used with blocking await/signal
     private final Condition waitForElementToBeAvailableCond;
+    private final Condition waitForSpaceToBeAvailableCond;
 
     /**
      * <p>Allocate and create queue with default initial capacity (DEFAULT_CAPACITY), default expansion 
@@ -73,6 +74,7 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
         expandBy = DEFAULT_EXPANSION_BY;
         buffer = (E[]) new Object[capacity];
         waitForElementToBeAvailableCond = dequeueLock.newCondition();
+        waitForSpaceToBeAvailableCond = enqueueLock.newCondition();
     }
 
     /**
@@ -92,6 +94,7 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
         expandBy = DEFAULT_EXPANSION_BY;
         buffer = (E[]) new Object[capacity];
         waitForElementToBeAvailableCond = dequeueLock.newCondition();
+        waitForSpaceToBeAvailableCond = enqueueLock.newCondition();
     }
 
     /**
@@ -99,7 +102,8 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
      * maximum allowable size.</p>
      * 
      * @param capacity initial size of queue.
-     * @param expandBy number that should be added to current size of queue to expand it.
+     * @param expandBy minimum number that should be added to current size of queue to expand it (queue 
+     *        size is doubled if that is more).
      * @param maxCapacity maximum size of queue.
      * @throws IllegalArgumentException if capacity/maxCapacity/expandBy is zero or negative.
      */
@@ -121,68 +125,64 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
 
         // when take() blocks, another thread will call signal() on condition associated with 
         // dequeueLock i.e. waitForElementToBeAvailableCond. Similar approach applies for 
-        // enque as well.
+        // enque as well i.e. put() blocks on waitForSpaceToBeAvailableCond associated with 
+        // enqueueLock.
         waitForElementToBeAvailableCond = dequeueLock.newCondition();
+        waitForSpaceToBeAvailableCond = enqueueLock.newCondition();
     }
 
     /*
-     * Expand the array by expandBy value. The situation to expand the array arises only when rate of 
-     * insertion was higher than rate of removal. If the tail rolled over, this method will re-arrange
-     * all elements as it would have been in big linear 1-D array. After expansion next location is 
-     * calculated as :
-     * next location = number of element at the time this method was called + 1;
+     * Expand the array. The situation to expand the array arises only when rate of insertion was higher 
+     * than rate of removal. Size grows geometrically i.e. it is doubled (but at-least increased by 
+     * expandBy), so that a burst of insertions causes only a few expansions. If the tail rolled over, 
+     * this method will re-arrange all elements as it would have been in big linear 1-D array using two 
+     * block copies. After expansion, head is 0 and next location to insert is :
+     * next location = number of element in queue at the time this method was called;
+     * 
+     * Caller must hold both enqueueLock and dequeueLock.
      */
     @SuppressWarnings("unchecked")
     private boolean expandQueue() {
 
-        int x = 0;
-        int y = 0;
-        int z = 0;
-
         // If we have reached maximum allowable size, consumer must read the elements from queue to make 
         // room for new elements to be inserted into queue. There is no way out, so return false;
-        if(buffer.length == maxCapacity) {
+        if(buffer.length >= maxCapacity) {
             return false;
         }
 
-        enqueueLock.lock();
-        dequeueLock.lock();
-
         // Size of new queue can never be greater than maxCapacity.
-        int newLength = buffer.length + expandBy;
+        long newLength = (long) buffer.length + Math.max(buffer.length, expandBy);
         if(newLength >= maxCapacity) {
             newLength = maxCapacity;
         }
 
-        try {
-            E[] tmp = (E[]) new Object[newLength];
+        E[] tmp = (E[]) new Object[(int) newLength];
+        int count = totalElementsInQueue.get();
 
-            if(tail > head) {
-                // tail kept increasing linearly and finally the queue was full.
-                for(x = 0; x < buffer.length; x++) {
-                    tmp[x] = buffer[x];
-                }
-            }else {
-                // tail kept increasing and rolled over, but than found that queue is full.
-                y = head;
-                for(x = 0; x < (buffer.length - head); x++) {
-                    tmp[x] = buffer[y];
-                    y++;
-                }
-                for(z = 0; z <= tail; z++) {
-                    tmp[x] = buffer[z];
-                    x++;
-                }
-            }
-
-            // new bigger queue
-            buffer = tmp;
+        // find the element which will be removed next.
+        int first = head;
+        if(headUpdateStatus == -1) {
+            first = 0;
+        }else if(headUpdateStatus == -2) {
+            first = head + 1;
+        }else {
+        }
+        if(first >= buffer.length) {
+            first = 0;
+        }
 
-        } finally {
-            dequeueLock.unlock();
-            enqueueLock.unlock();
+        // copy [first, end of array) and than the rolled over part [0, remaining).
+        int firstPart = Math.min(count, buffer.length - first);
+        System.arraycopy(buffer, first, tmp, 0, firstPart);
+        if(firstPart < count) {
+            System.arraycopy(buffer, 0, tmp, firstPart, count - firstPart);
         }
 
+        // new bigger queue
+        buffer = tmp;
+        head = 0;
+        headUpdateStatus = 0;
+
         return true;
     }
 
@@ -220,7 +220,9 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
                 /* buffer can not be expanded further. */
 
                 if(totalElementBeforeInsertion >= maxCapacity) {
-                    // Queue is already full and can not be expanded.
+                    // Queue is already full and can not be expanded. Wait until a consumer signals that 
+                    // space is available; await releases enqueueLock so other producers are not blocked 
+                    // meanwhile.
                     if(timeout == -1) {
                         return false;
                     }
@@ -228,125 +230,78 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
                         // handle spurious signal, wait until queue really has space.
                         while(totalElementsInQueue.get() >= buffer.length) {
                             try {
-                                Thread.sleep(200);
-                            } catch (InterruptedException ie) {
+                                waitForSpaceToBeAvailableCond.await();
+                            }catch (InterruptedException ie) {
+                                waitForSpaceToBeAvailableCond.signal(); // propagate to non-interrupted thread
                                 throw ie;
                             }
                         }
-
-                        // check if updating tail before insertion is needed or not.
-                        if(tailUpdateStatus == -1) {
-                            tail = 0;
-                            tailUpdateStatus = 0;
-                        }else if(tailUpdateStatus == -2) {
-                            tail++;
-                            tailUpdateStatus = 0;
-                        }else {
-                        }
-
-                        buffer[tail] = e;
-                        totalElementsInQueue.incrementAndGet();
-                        elementAdded = true;
-
-                        // update tail an associated status as required.
-                        if((totalElementBeforeInsertion + 1) >= buffer.length) {
-                            if(tail == (buffer.length - 1)) {
-                                tailUpdateStatus = -1;
-                            }else {
-                                tailUpdateStatus = -2;
-                            }
-                        }else {
-                            if(tail == (buffer.length - 1)) {
-                                tail = 0;
-                                tailUpdateStatus = 0;
-                            }else {
-                                tail++;
-                                tailUpdateStatus = 0;
-                            }
-                        }
                     }
                     else {
-                        try {
-                            Thread.sleep(unit.toMillis(timeout));
-
-                            if (totalElementsInQueue.get() >= buffer.length) {
+                        long nanosTimeout = unit.toNanos(timeout);
+                        while(totalElementsInQueue.get() >= buffer.length) {
+                            if(nanosTimeout <= 0) {
                                 // timed out while waiting.
                                 return false;
-                            }else {
-                                if(tailUpdateStatus == -1) {
-                                    tail = 0;
-                                    tailUpdateStatus = 0;
-                                }else if(tailUpdateStatus == -2) {
-                                    tail++;
-                                    tailUpdateStatus = 0;
-                                }else {
-                                }
-                                buffer[tail] = e;
-                                totalElementsInQueue.incrementAndGet();
-                                elementAdded = true;
-
-                                if((totalElementBeforeInsertion + 1) >= buffer.length) {
-                                    if(tail == (buffer.length - 1)) {
-                                        tailUpdateStatus = -1;
-                                    }else {
-                                        tailUpdateStatus = -2;
-                                    }
-                                }else {
-                                    if(tail == (buffer.length - 1)) {
-                                        tail = 0;
-                                        tailUpdateStatus = 0;
-                                    }else {
-                                        tail++;
-                                        tailUpdateStatus = 0;
-                                    }
-                                }
                             }
-                        } catch (InterruptedException ie) {
-                            throw ie;
+                            try {
+                                nanosTimeout = waitForSpaceToBeAvailableCond.awaitNanos(nanosTimeout);
+                            }catch (InterruptedException ie) {
+                                waitForSpaceToBeAvailableCond.signal(); // propagate to non-interrupted thread
+                                throw ie;
+                            }
                         }
                     }
+
+                    // consumers have removed elements while we were waiting.
+                    totalElementBeforeInsertion = totalElementsInQueue.get();
+                }
+
+                // check if updating tail before insertion is needed or not.
+                if(tailUpdateStatus == -1) {
+                    tail = 0;
+                    tailUpdateStatus = 0;
+                }else if(tailUpdateStatus == -2) {
+                    tail++;
+                    tailUpdateStatus = 0;
                 }else {
-                    if(tailUpdateStatus == -1) {
+                }
+
+                buffer[tail] = e;
+                totalElementsInQueue.incrementAndGet();
+                elementAdded = true;
+
+                // update tail an associated status as required.
+                if((totalElementBeforeInsertion + 1) >= buffer.length) {
+                    if(tail == (buffer.length - 1)) {
+                        tailUpdateStatus = -1;
+                    }else {
+                        tailUpdateStatus = -2;
+                    }
+                }else {
+                    if(tail == (buffer.length - 1)) {
                         tail = 0;
                         tailUpdateStatus = 0;
-                    }else if(tailUpdateStatus == -2) {
+                    }else {
                         tail++;
                         tailUpdateStatus = 0;
-                    }else {
                     }
 
-                    buffer[tail] = e;
-                    totalElementsInQueue.incrementAndGet();
-                    elementAdded = true;
-
-                    if((totalElementBeforeInsertion + 1) >= buffer.length) {
-                        if(tail == (buffer.length - 1)) {
-                            tailUpdateStatus = -1;
-                        }else {
-                            tailUpdateStatus = -2;
-                        }
-                    }else {
-                        if(tail == (buffer.length - 1)) {
-                            tail = 0;
-                            tailUpdateStatus = 0;
-                        }else {
-                            tail++;
-                            tailUpdateStatus = 0;
-                        }
-                    }
+                    // there is still space, let next waiting producer (if any) proceed.
+                    waitForSpaceToBeAvailableCond.signal();
                 }
             }else {
                 /* buffer can be expanded further if required. */
 
                 if(totalElementBeforeInsertion >= buffer.length) {
-                    // queue is already full, expansion is required.
-                    int tmp = buffer.length;
-
+                    // queue is already full, expansion is required. Consumers may have removed some elements 
+                    // before dequeueLock is acquired here, so number of elements is re-read after expansion.
                     dequeueLock.lock();
                     try {
                         if(expandQueue() == true) {
-                            buffer[tmp] = e;
-                            tail = tmp;
+                            totalElementBeforeInsertion = totalElementsInQueue.get();
+                            tail = totalElementBeforeInsertion;
+                            buffer[tail] = e;
                             totalElementsInQueue.incrementAndGet();
                             elementAdded = true;
 
@@ -515,9 +470,27 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
             dequeueLock.unlock();
         }
 
+        // If queue was full at maximum capacity, a producer may be waiting for space. This is done after 
+        // releasing dequeueLock as insert() acquires enqueueLock before dequeueLock.
+        if(totalElementBeforeRemoval >= maxCapacity) {
+            signalSpaceAvailable();
+        }
+
         return element;
     }
 
+    /*
+     * Wake up a producer waiting in put() or offer(timeout) for space to become available.
+     */
+    private void signalSpaceAvailable() {
+        enqueueLock.lock();
+        try {
+            waitForSpaceToBeAvailableCond.signal();
+        } finally {
+            enqueueLock.unlock();
+        }
+    }
+
     /**
      * <p>Retrieves and removes the head of this queue, or returns null if this queue is empty.</p>
      * 
@@ -723,7 +696,7 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
             insert(e, -2, null);
         } catch (Exception exp) {
             if(exp instanceof InterruptedException) {
-                throw new IllegalStateException();
+                throw (InterruptedException) exp;
             }else if(exp instanceof NullPointerException) {
                 throw new NullPointerException();
             }else if(exp instanceof ClassCastException) {
@@ -839,6 +812,7 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
             tail = 0;
             headUpdateStatus = 0;
             tailUpdateStatus = 0;
+            waitForSpaceToBeAvailableCond.signalAll();
         } finally {
             enqueueLock.unlock();
             dequeueLock.unlock();
@@ -920,6 +894,7 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
             tail = 0;
             headUpdateStatus = 0;
             tailUpdateStatus = 0;
+            waitForSpaceToBeAvailableCond.signalAll();
         } finally {
             enqueueLock.unlock();
             dequeueLock.unlock();
@@ -970,6 +945,7 @@ public final class RingArrayBlockingQueue<E> extends AbstractList<E> implements
             tail = 0;
             headUpdateStatus = 0;
             tailUpdateStatus = 0;
+            waitForSpaceToBeAvailableCond.signalAll();
         } finally {
             enqueueLock.unlock();
             dequeueLock.unlock();
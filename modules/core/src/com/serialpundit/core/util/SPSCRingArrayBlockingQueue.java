@@ -0,0 +1,413 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.core.util;
+
+import java.util.AbstractQueue;
+import java.util.Collection;
+import java.util.Iterator;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.locks.LockSupport;
+
+/**
+ * <p>A bounded blocking/non-blocking FIFO queue backed by a ring buffer for exactly one producer
+ * thread and one consumer thread. Inserting and removing elements does not take any lock. Producer
+ * and consumer publish their position through sequence counters which are padded so that they never
+ * share a cache line. A thread is parked only when queue is full (producer) or empty (consumer) and
+ * is unparked by the other thread as soon as space or an element becomes available.</p>
+ *
+ * <p>Only one thread may call insertion methods and only one thread may call removal methods at any
+ * given time. Using more producers or consumers results in undefined behavior; use
+ * RingArrayBlockingQueue in such cases.</p>
+ *
+ * <p>Inserting null elements is not allowed. Capacity is rounded up to the next power of 2.</p>
+ *
+ * <p>Insertion methods  : offer(), offer(timeout), add(),  put() <br>
+ *    Removal methods    : poll(), poll(timeout), take(), remove(), peek(), element(), drainTo(), clear() <br>
+ *    Inspection methods : size(), isEmpty(), remainingCapacity(), capacity()<br></p>
+ *
+ * @author Rishi Gupta
+ */
+public final class SPSCRingArrayBlockingQueue<E> extends AbstractQueue<E> implements BlockingQueue<E> {
+
+    /* Padding before the sequence value. 7 longs + object header keeps value in its own 64 byte
+     * cache line. */
+    static class SequenceLhsPadding {
+        protected long p1, p2, p3, p4, p5, p6, p7;
+    }
+
+    /* The value is the sequence published to the other thread. The cache is the last value of
+     * the other thread's sequence seen by the owner, it is read and written only by the owner. */
+    static class SequenceValue extends SequenceLhsPadding {
+        protected volatile long value;
+        protected long cache;
+    }
+
+    /* Padding after the sequence value. */
+    static final class Sequence extends SequenceValue {
+        protected long p9, p10, p11, p12, p13, p14;
+    }
+
+    private final int capacity;
+    private final int mask;
+    private final E[] buffer;
+
+    // next slot to read, written only by consumer; its cache is consumer's view of tail.
+    private final Sequence head = new Sequence();
+
+    // next slot to write, written only by producer; its cache is producer's view of head.
+    private final Sequence tail = new Sequence();
+
+    // set only while a thread is parked (or about to park) waiting for the other thread.
+    private volatile Thread waitingProducer;
+    private volatile Thread waitingConsumer;
+
+    /**
+     * <p>Allocate and create queue which can hold at-least the given number of elements.</p>
+     *
+     * @param capacity minimum number of elements this queue should be able to hold.
+     * @throws IllegalArgumentException if capacity is zero, negative or greater than 2^30.
+     */
+    @SuppressWarnings("unchecked")
+    public SPSCRingArrayBlockingQueue(int capacity) {
+        if(capacity <= 0) {
+            throw new IllegalArgumentException("Argument capacity can not be negative or zero !");
+        }
+        if(capacity > (1 << 30)) {
+            throw new IllegalArgumentException("Argument capacity can not be greater than 2^30 !");
+        }
+        int size = 1;
+        while(size < capacity) {
+            size = size << 1;
+        }
+        this.capacity = size;
+        mask = size - 1;
+        buffer = (E[]) new Object[size];
+    }
+
+    /**
+     * <p>Inserts the specified element into this queue if it is possible to do so immediately without
+     * violating capacity restrictions. Must be called only from producer thread.</p>
+     *
+     * @param e the element to add.
+     * @return true if the element was added to this queue otherwise false.
+     * @throws NullPointerException if the specified element is null.
+     */
+    @Override
+    public boolean offer(E e) {
+        if(e == null) {
+            throw new NullPointerException("Null elements may not be inserted in this queue !");
+        }
+
+        final long t = tail.value;
+        if((t - tail.cache) >= capacity) {
+            // queue looked full last time, re-read consumer's position.
+            tail.cache = head.value;
+            if((t - tail.cache) >= capacity) {
+                return false;
+            }
+        }
+
+        buffer[(int) t & mask] = e;
+
+        // volatile write publishes the element. It is followed by volatile read of waiting
+        // consumer so that either consumer sees this element or producer sees the waiting consumer.
+        tail.value = t + 1;
+        Thread waiter = waitingConsumer;
+        if(waiter != null) {
+            LockSupport.unpark(waiter);
+        }
+        return true;
+    }
+
+    /**
+     * <p>Inserts the specified element into this queue, waiting up to the specified wait time if necessary
+     * for space to become available. Must be called only from producer thread.</p>
+     *
+     * @param e the element to add.
+     * @param timeout how long to wait before giving up, in units of unit.
+     * @param unit a TimeUnit determining how to interpret the timeout parameter.
+     * @return true if successful, or false if the specified waiting time elapses before space is available.
+     * @throws InterruptedException if interrupted while waiting.
+     * @throws NullPointerException if the specified element is null.
+     */
+    @Override
+    public boolean offer(E e, long timeout, TimeUnit unit) throws InterruptedException {
+        if(offer(e) == true) {
+            return true;
+        }
+        return awaitSpace(e, true, unit.toNanos(timeout));
+    }
+
+    /**
+     * <p>Inserts the specified element into this queue, waiting if necessary for space to become
+     * available. Must be called only from producer thread.</p>
+     *
+     * @param e the element to add.
+     * @throws InterruptedException if interrupted while waiting.
+     * @throws NullPointerException if the specified element is null.
+     */
+    @Override
+    public void put(E e) throws InterruptedException {
+        if(offer(e) == true) {
+            return;
+        }
+        awaitSpace(e, false, 0);
+    }
+
+    /*
+     * Park producer until consumer makes room for the given element or timeout occurs.
+     */
+    private boolean awaitSpace(E e, boolean timed, long nanos) throws InterruptedException {
+        final long deadline = timed ? (System.nanoTime() + nanos) : 0;
+        waitingProducer = Thread.currentThread();
+        try {
+            while(offer(e) == false) {
+                if(Thread.interrupted()) {
+                    throw new InterruptedException();
+                }
+                if(timed) {
+                    nanos = deadline - System.nanoTime();
+                    if(nanos <= 0) {
+                        return false;
+                    }
+                    LockSupport.parkNanos(this, nanos);
+                }else {
+                    LockSupport.park(this);
+                }
+            }
+        } finally {
+            waitingProducer = null;
+        }
+        return true;
+    }
+
+    /**
+     * <p>Retrieves and removes the head of this queue, or returns null if this queue is empty. Must be
+     * called only from consumer thread.</p>
+     *
+     * @return the head of this queue, or null if this queue is empty.
+     */
+    @Override
+    public E poll() {
+        final long h = head.value;
+        if(h >= head.cache) {
+            // queue looked empty last time, re-read producer's position.
+            head.cache = tail.value;
+            if(h >= head.cache) {
+                return null;
+            }
+        }
+
+        final int index = (int) h & mask;
+        E element = buffer[index];
+        buffer[index] = null;
+
+        head.value = h + 1;
+        Thread waiter = waitingProducer;
+        if(waiter != null) {
+            LockSupport.unpark(waiter);
+        }
+        return element;
+    }
+
+    /**
+     * <p>Retrieves and removes the head of this queue, waiting up to the specified wait time if necessary
+     * for an element to become available. Must be called only from consumer thread.</p>
+     *
+     * @param timeout how long to wait before giving up, in units of unit.
+     * @param unit a TimeUnit determining how to interpret the timeout parameter.
+     * @return the head of this queue, or null if the specified waiting time elapses before an element is available.
+     * @throws InterruptedException if interrupted while waiting.
+     */
+    @Override
+    public E poll(long timeout, TimeUnit unit) throws InterruptedException {
+        E element = poll();
+        if(element != null) {
+            return element;
+        }
+        return awaitElement(true, unit.toNanos(timeout));
+    }
+
+    /**
+     * <p>Retrieves and removes the head of this queue, waiting if necessary until an element becomes
+     * available. Must be called only from consumer thread.</p>
+     *
+     * @return the head of this queue.
+     * @throws InterruptedException if interrupted while waiting.
+     */
+    @Override
+    public E take() throws InterruptedException {
+        E element = poll();
+        if(element != null) {
+            return element;
+        }
+        return awaitElement(false, 0);
+    }
+
+    /*
+     * Park consumer until producer inserts an element or timeout occurs.
+     */
+    private E awaitElement(boolean timed, long nanos) throws InterruptedException {
+        E element = null;
+        final long deadline = timed ? (System.nanoTime() + nanos) : 0;
+        waitingConsumer = Thread.currentThread();
+        try {
+            while((element = poll()) == null) {
+                if(Thread.interrupted()) {
+                    throw new InterruptedException();
+                }
+                if(timed) {
+                    nanos = deadline - System.nanoTime();
+                    if(nanos <= 0) {
+                        return null;
+                    }
+                    LockSupport.parkNanos(this, nanos);
+                }else {
+                    LockSupport.park(this);
+                }
+            }
+        } finally {
+            waitingConsumer = null;
+        }
+        return element;
+    }
+
+    /**
+     * <p>Retrieves, but does not remove, the head of this queue, or returns null if this queue is empty.
+     * Must be called only from consumer thread.</p>
+     *
+     * @return the head of this queue, or null if this queue is empty.
+     */
+    @Override
+    public E peek() {
+        final long h = head.value;
+        if(h >= tail.value) {
+            return null;
+        }
+        return buffer[(int) h & mask];
+    }
+
+    /**
+     * <p>Removes at most the given number of available elements from this queue and adds them to the given
+     * collection. Must be called only from consumer thread.</p>
+     *
+     * @param c the collection to transfer elements into.
+     * @param maxElements the maximum number of elements to transfer.
+     * @return the number of elements transferred.
+     * @throws NullPointerException if the specified collection is null.
+     * @throws IllegalArgumentException if the specified collection is this queue.
+     */
+    @Override
+    public int drainTo(Collection<? super E> c, int maxElements) {
+        if(c == null) {
+            throw new NullPointerException();
+        }
+        if(c == this) {
+            throw new IllegalArgumentException();
+        }
+
+        final long h = head.value;
+        final long available = tail.value - h;
+        final int count = (int) Math.min(available, (long) maxElements);
+        if(count <= 0) {
+            return 0;
+        }
+
+        int index = 0;
+        for(int x = 0; x < count; x++) {
+            index = (int) (h + x) & mask;
+            c.add(buffer[index]);
+            buffer[index] = null;
+        }
+
+        head.value = h + count;
+        Thread waiter = waitingProducer;
+        if(waiter != null) {
+            LockSupport.unpark(waiter);
+        }
+        return count;
+    }
+
+    /**
+     * <p>Removes all available elements from this queue and adds them to the given collection. Must be
+     * called only from consumer thread.</p>
+     *
+     * @param c the collection to transfer elements into.
+     * @return the number of elements transferred.
+     * @throws NullPointerException if the specified collection is null.
+     * @throws IllegalArgumentException if the specified collection is this queue.
+     */
+    @Override
+    public int drainTo(Collection<? super E> c) {
+        return drainTo(c, Integer.MAX_VALUE);
+    }
+
+    /**
+     * <p>Returns the number of elements in this queue. The value may be stale by the time it is
+     * returned if producer or consumer is running.</p>
+     *
+     * @return the number of elements in this queue.
+     */
+    @Override
+    public int size() {
+        // read head first; tail can only move ahead meanwhile which never gives negative size.
+        final long h = head.value;
+        final long size = tail.value - h;
+        if(size > capacity) {
+            return capacity;
+        }
+        return (int) size;
+    }
+
+    /**
+     * <p>Returns true if queue is empty otherwise false.</p>
+     *
+     * @return true if queue is empty otherwise false.
+     */
+    @Override
+    public boolean isEmpty() {
+        return head.value >= tail.value;
+    }
+
+    /**
+     * <p>Returns the number of additional elements that this queue can accept without blocking.</p>
+     *
+     * @return the remaining capacity of this queue.
+     */
+    @Override
+    public int remainingCapacity() {
+        return capacity - size();
+    }
+
+    /**
+     * <p>Returns the maximum number of elements this queue can hold.</p>
+     *
+     * @return capacity of this queue.
+     */
+    public int capacity() {
+        return capacity;
+    }
+
+    /**
+     * <p>Iteration is not supported as consumer may remove elements concurrently. Use take(),
+     * poll() or drainTo() to get elements.</p>
+     *
+     * @throws UnsupportedOperationException use other methods to retrieve elements from queue.
+     */
+    @Override
+    public Iterator<E> iterator() {
+        throw new UnsupportedOperationException("Use take(), poll() or drainTo() to get elements !");
+    }
+}
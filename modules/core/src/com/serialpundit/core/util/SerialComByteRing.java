@@ -0,0 +1,499 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.core.util;
+
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.locks.Condition;
+import java.util.concurrent.locks.ReentrantLock;
+
+/**
+ * <p>A bounded FIFO of bytes backed by a primitive byte array ring. Data is copied in and out of the ring
+ * in bulk using System.arraycopy, so passing serial data through it does not allocate any object per
+ * chunk as is the case when byte[] chunks are queued.</p>
+ *
+ * <p>A position can be marked before reading a frame. Bytes after the mark are not overwritten until
+ * mark is cleared or moved, so a partially received frame can be re-read after reset(). This together
+ * with peek() and indexOf() helps in parsing frames without consuming them.</p>
+ *
+ * <p>Write methods  : write(), put(), offer(timeout) <br>
+ *    Read methods   : read(), take(), poll(timeout), skip(), clear() <br>
+ *    Framing methods: peek(), indexOf(), mark(), reset(), unmark() <br>
+ *    Inspection     : available(), remaining(), capacity()<br></p>
+ *
+ * <p>All methods are thread safe. Capacity is rounded up to the next power of 2.</p>
+ *
+ * @author Rishi Gupta
+ */
+public final class SerialComByteRing {
+
+    private final byte[] buffer;
+    private final int capacity;
+    private final int mask;
+
+    // total number of bytes ever read (head) and written (tail), index in ring is (position & mask).
+    private long head;
+    private long tail;
+
+    // position marked by consumer, -1 if no mark is set.
+    private long markPosition = -1;
+
+    private final ReentrantLock lock = new ReentrantLock();
+    private final Condition dataAvailableCond = lock.newCondition();
+    private final Condition spaceAvailableCond = lock.newCondition();
+
+    /**
+     * <p>Allocate and create ring which can hold at-least the given number of bytes.</p>
+     *
+     * @param capacity minimum number of bytes this ring should be able to hold.
+     * @throws IllegalArgumentException if capacity is zero, negative or greater than 2^30.
+     */
+    public SerialComByteRing(int capacity) {
+        if(capacity <= 0) {
+            throw new IllegalArgumentException("Argument capacity can not be negative or zero !");
+        }
+        if(capacity > (1 << 30)) {
+            throw new IllegalArgumentException("Argument capacity can not be greater than 2^30 !");
+        }
+        int size = 1;
+        while(size < capacity) {
+            size = size << 1;
+        }
+        this.capacity = size;
+        mask = size - 1;
+        buffer = new byte[size];
+    }
+
+    /*
+     * Validate offset and length against given array.
+     */
+    private static void checkBounds(byte[] data, int offset, int length) {
+        if(data == null) {
+            throw new NullPointerException("Argument data can not be null !");
+        }
+        if((offset < 0) || (length < 0) || (length > (data.length - offset))) {
+            throw new IndexOutOfBoundsException("Argument offset and/or length is out of bounds !");
+        }
+    }
+
+    /*
+     * Number of bytes which can be written without overwriting unread or marked bytes. Caller holds lock.
+     */
+    private int freeSpace() {
+        long start = (markPosition >= 0) ? markPosition : head;
+        return capacity - (int) (tail - start);
+    }
+
+    /*
+     * Copy bytes from the given array in ring at tail. Caller holds lock and ensures there is space.
+     */
+    private void copyIn(byte[] src, int offset, int length) {
+        int index = (int) tail & mask;
+        int firstPart = Math.min(length, capacity - index);
+        System.arraycopy(src, offset, buffer, index, firstPart);
+        if(firstPart < length) {
+            System.arraycopy(src, offset + firstPart, buffer, 0, length - firstPart);
+        }
+        tail += length;
+        dataAvailableCond.signalAll();
+    }
+
+    /*
+     * Copy bytes from ring starting at given position in the given array. Caller holds lock and ensures
+     * that these many bytes are available.
+     */
+    private void copyOut(long position, byte[] dst, int offset, int length) {
+        int index = (int) position & mask;
+        int firstPart = Math.min(length, capacity - index);
+        System.arraycopy(buffer, index, dst, offset, firstPart);
+        if(firstPart < length) {
+            System.arraycopy(buffer, 0, dst, offset + firstPart, length - firstPart);
+        }
+    }
+
+    /*
+     * Advance head by given number of bytes. Caller holds lock.
+     */
+    private void consume(int length) {
+        head += length;
+        if(markPosition < 0) {
+            spaceAvailableCond.signalAll();
+        }
+    }
+
+    /**
+     * <p>Writes as many bytes from the given array as can be written without blocking.</p>
+     *
+     * @param src array containing bytes to be written.
+     * @param offset index in src from where bytes should be taken.
+     * @param length number of bytes to write.
+     * @return number of bytes actually written, 0 if ring is full.
+     * @throws NullPointerException if src is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid for given array.
+     */
+    public int write(byte[] src, int offset, int length) {
+        checkBounds(src, offset, length);
+        lock.lock();
+        try {
+            int count = Math.min(length, freeSpace());
+            if(count > 0) {
+                copyIn(src, offset, count);
+            }
+            return count;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Writes all the given bytes in ring, waiting as required for space to become available. Bytes are
+     * written as and when space is available, so a reader may see them in more than one chunk.</p>
+     *
+     * @param src array containing bytes to be written.
+     * @param offset index in src from where bytes should be taken.
+     * @param length number of bytes to write.
+     * @throws InterruptedException if interrupted while waiting.
+     * @throws NullPointerException if src is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid for given array.
+     */
+    public void put(byte[] src, int offset, int length) throws InterruptedException {
+        checkBounds(src, offset, length);
+        lock.lockInterruptibly();
+        try {
+            int count = 0;
+            while(length > 0) {
+                while((count = freeSpace()) == 0) {
+                    spaceAvailableCond.await();
+                }
+                count = Math.min(count, length);
+                copyIn(src, offset, count);
+                offset = offset + count;
+                length = length - count;
+            }
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Writes the given bytes in ring, waiting up to the specified time if necessary for space to become
+     * available.</p>
+     *
+     * @param src array containing bytes to be written.
+     * @param offset index in src from where bytes should be taken.
+     * @param length number of bytes to write.
+     * @param timeout how long to wait before giving up, in units of unit.
+     * @param unit a TimeUnit determining how to interpret the timeout parameter.
+     * @return number of bytes actually written, less than length if timeout occurred.
+     * @throws InterruptedException if interrupted while waiting.
+     * @throws NullPointerException if src is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid for given array.
+     */
+    public int offer(byte[] src, int offset, int length, long timeout, TimeUnit unit) throws InterruptedException {
+        checkBounds(src, offset, length);
+        long nanosTimeout = unit.toNanos(timeout);
+        int written = 0;
+        lock.lockInterruptibly();
+        try {
+            int count = 0;
+            while(written < length) {
+                while((count = freeSpace()) == 0) {
+                    if(nanosTimeout <= 0) {
+                        return written;
+                    }
+                    nanosTimeout = spaceAvailableCond.awaitNanos(nanosTimeout);
+                }
+                count = Math.min(count, length - written);
+                copyIn(src, offset + written, count);
+                written = written + count;
+            }
+            return written;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Reads up to length bytes which are available in ring without blocking.</p>
+     *
+     * @param dst array in which bytes read will be saved.
+     * @param offset index in dst from where bytes should be saved.
+     * @param length maximum number of bytes to read.
+     * @return number of bytes actually read, 0 if ring is empty.
+     * @throws NullPointerException if dst is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid for given array.
+     */
+    public int read(byte[] dst, int offset, int length) {
+        checkBounds(dst, offset, length);
+        lock.lock();
+        try {
+            int count = Math.min(length, (int) (tail - head));
+            if(count > 0) {
+                copyOut(head, dst, offset, count);
+                consume(count);
+            }
+            return count;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Reads up to length bytes, waiting if necessary until at-least one byte becomes available.</p>
+     *
+     * @param dst array in which bytes read will be saved.
+     * @param offset index in dst from where bytes should be saved.
+     * @param length maximum number of bytes to read.
+     * @return number of bytes actually read, 0 only if length is 0.
+     * @throws InterruptedException if interrupted while waiting.
+     * @throws NullPointerException if dst is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid for given array.
+     */
+    public int take(byte[] dst, int offset, int length) throws InterruptedException {
+        checkBounds(dst, offset, length);
+        if(length == 0) {
+            return 0;
+        }
+        lock.lockInterruptibly();
+        try {
+            while(tail == head) {
+                dataAvailableCond.await();
+            }
+            int count = Math.min(length, (int) (tail - head));
+            copyOut(head, dst, offset, count);
+            consume(count);
+            return count;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Reads up to length bytes, waiting up to the specified time if necessary for at-least one byte to
+     * become available.</p>
+     *
+     * @param dst array in which bytes read will be saved.
+     * @param offset index in dst from where bytes should be saved.
+     * @param length maximum number of bytes to read.
+     * @param timeout how long to wait before giving up, in units of unit.
+     * @param unit a TimeUnit determining how to interpret the timeout parameter.
+     * @return number of bytes actually read, 0 if timeout occurred.
+     * @throws InterruptedException if interrupted while waiting.
+     * @throws NullPointerException if dst is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid for given array.
+     */
+    public int poll(byte[] dst, int offset, int length, long timeout, TimeUnit unit) throws InterruptedException {
+        checkBounds(dst, offset, length);
+        if(length == 0) {
+            return 0;
+        }
+        long nanosTimeout = unit.toNanos(timeout);
+        lock.lockInterruptibly();
+        try {
+            while(tail == head) {
+                if(nanosTimeout <= 0) {
+                    return 0;
+                }
+                nanosTimeout = dataAvailableCond.awaitNanos(nanosTimeout);
+            }
+            int count = Math.min(length, (int) (tail - head));
+            copyOut(head, dst, offset, count);
+            consume(count);
+            return count;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Copies up to length available bytes in given array without removing them from ring.</p>
+     *
+     * @param dst array in which bytes will be saved.
+     * @param offset index in dst from where bytes should be saved.
+     * @param length maximum number of bytes to copy.
+     * @return number of bytes actually copied, 0 if ring is empty.
+     * @throws NullPointerException if dst is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid for given array.
+     */
+    public int peek(byte[] dst, int offset, int length) {
+        checkBounds(dst, offset, length);
+        lock.lock();
+        try {
+            int count = Math.min(length, (int) (tail - head));
+            if(count > 0) {
+                copyOut(head, dst, offset, count);
+            }
+            return count;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Returns the byte at given index relative to the next byte to be read, without removing it.</p>
+     *
+     * @param index position relative to next byte to be read (0 is next byte).
+     * @return byte value in range 0 to 255 or -1 if there is no byte at given index.
+     */
+    public int peek(int index) {
+        lock.lock();
+        try {
+            if((index < 0) || (index >= (tail - head))) {
+                return -1;
+            }
+            return buffer[(int) (head + index) & mask] & 0xFF;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Searches available bytes for the first occurrence of given value. Typically used to find frame
+     * delimiter before reading a complete frame.</p>
+     *
+     * @param value byte to search for.
+     * @param fromIndex position relative to next byte to be read from where searching should begin.
+     * @return index relative to next byte to be read or -1 if value is not found.
+     */
+    public int indexOf(byte value, int fromIndex) {
+        lock.lock();
+        try {
+            int available = (int) (tail - head);
+            for(int x = Math.max(fromIndex, 0); x < available; x++) {
+                if(buffer[(int) (head + x) & mask] == value) {
+                    return x;
+                }
+            }
+            return -1;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Discards up to the given number of available bytes.</p>
+     *
+     * @param length number of bytes to discard.
+     * @return number of bytes actually discarded.
+     */
+    public int skip(int length) {
+        lock.lock();
+        try {
+            int count = Math.min(Math.max(length, 0), (int) (tail - head));
+            if(count > 0) {
+                consume(count);
+            }
+            return count;
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Marks the current read position. Bytes read after this are kept in ring (and occupy space) until
+     * reset() or unmark() is called or a new mark is set.</p>
+     */
+    public void mark() {
+        lock.lock();
+        try {
+            markPosition = head;
+            spaceAvailableCond.signalAll();
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Moves read position back to the marked position and clears the mark, so that bytes read since
+     * mark() can be read again.</p>
+     *
+     * @throws IllegalStateException if mark is not set.
+     */
+    public void reset() {
+        lock.lock();
+        try {
+            if(markPosition < 0) {
+                throw new IllegalStateException("Mark is not set !");
+            }
+            head = markPosition;
+            markPosition = -1;
+            dataAvailableCond.signalAll();
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Clears the mark (if any), space occupied by bytes read after mark becomes free.</p>
+     */
+    public void unmark() {
+        lock.lock();
+        try {
+            markPosition = -1;
+            spaceAvailableCond.signalAll();
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Discards all bytes in ring and clears the mark.</p>
+     */
+    public void clear() {
+        lock.lock();
+        try {
+            head = tail;
+            markPosition = -1;
+            spaceAvailableCond.signalAll();
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Returns the number of bytes which can be read without blocking.</p>
+     *
+     * @return number of bytes available for reading.
+     */
+    public int available() {
+        lock.lock();
+        try {
+            return (int) (tail - head);
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Returns the number of bytes which can be written without blocking.</p>
+     *
+     * @return number of bytes that can be written.
+     */
+    public int remaining() {
+        lock.lock();
+        try {
+            return freeSpace();
+        } finally {
+            lock.unlock();
+        }
+    }
+
+    /**
+     * <p>Returns the maximum number of bytes this ring can hold.</p>
+     *
+     * @return capacity of this ring.
+     */
+    public int capacity() {
+        return capacity;
+    }
+}
@@ -0,0 +1,296 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.core.util;
+
+import java.nio.ByteBuffer;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.zip.Checksum;
+
+/**
+ * <p>Calculates CRC as described by a SerialComCRCSpec, incrementally as data arrives. Lookup tables are 
+ * built only once for a given specification and shared by all instances using it. Data is processed 8 
+ * bytes at a time (slicing-by-8) for every width.</p>
+ * 
+ * <p>It implements java.util.zip.Checksum, so it can be used with CheckedInputStream/CheckedOutputStream 
+ * wrapping serial port byte streams to verify CRC while bytes are being read or written.</p>
+ * 
+ * <p>An instance is not thread safe; use one instance per stream.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComCRC implements Checksum {
+
+    // lookup tables already built, shared across all instances.
+    private static final ConcurrentHashMap<SerialComCRCSpec, long[][]> tableCache = 
+            new ConcurrentHashMap<SerialComCRCSpec, long[][]>();
+
+    private final SerialComCRCSpec spec;
+    private final long[][] table;
+    private final boolean refin;
+    private final int width;
+    private final long mask;
+
+    // If refin is true register holds reflected CRC in its lower bits, otherwise CRC is 
+    // kept left aligned in the 64 bit register so that same code works for every width.
+    private long register;
+
+    /**
+     * <p>Allocates a new SerialComCRC object for the given specification.</p>
+     * 
+     * @param spec CRC algorithm parameters.
+     * @throws NullPointerException if spec is null.
+     */
+    public SerialComCRC(SerialComCRCSpec spec) {
+        if(spec == null) {
+            throw new NullPointerException("Argument spec can not be null !");
+        }
+        this.spec = spec;
+        refin = spec.isRefin();
+        width = spec.getWidth();
+        mask = (width == 64) ? -1L : ((1L << width) - 1);
+        table = getTable(spec);
+        reset();
+    }
+
+    /*
+     * Return tables from cache or build them if this specification is used first time.
+     */
+    private static long[][] getTable(SerialComCRCSpec spec) {
+        long[][] t = tableCache.get(spec);
+        if(t == null) {
+            t = buildTable(spec);
+            long[][] existing = tableCache.putIfAbsent(spec, t);
+            if(existing != null) {
+                t = existing;
+            }
+        }
+        return t;
+    }
+
+    /*
+     * [k][i] is contribution of byte i followed by k zero bytes in CRC register.
+     */
+    private static long[][] buildTable(SerialComCRCSpec spec) {
+        final int width = spec.getWidth();
+        long[][] t = new long[8][256];
+        long c = 0;
+
+        if(spec.isRefin() == true) {
+            long rpoly = reflect(spec.getPoly(), width);
+            for(int i = 0; i < 256; i++) {
+                c = i;
+                for(int x = 0; x < 8; x++) {
+                    c = ((c & 1L) != 0) ? ((c >>> 1) ^ rpoly) : (c >>> 1);
+                }
+                t[0][i] = c;
+            }
+            for(int k = 1; k < 8; k++) {
+                for(int i = 0; i < 256; i++) {
+                    t[k][i] = (t[k - 1][i] >>> 8) ^ t[0][(int) t[k - 1][i] & 0xFF];
+                }
+            }
+        }else {
+            long tpoly = spec.getPoly() << (64 - width);
+            for(int i = 0; i < 256; i++) {
+                c = ((long) i) << 56;
+                for(int x = 0; x < 8; x++) {
+                    c = (c < 0) ? ((c << 1) ^ tpoly) : (c << 1);
+                }
+                t[0][i] = c;
+            }
+            for(int k = 1; k < 8; k++) {
+                for(int i = 0; i < 256; i++) {
+                    t[k][i] = (t[k - 1][i] << 8) ^ t[0][(int) (t[k - 1][i] >>> 56)];
+                }
+            }
+        }
+
+        return t;
+    }
+
+    /*
+     * Reverse order of lower width bits.
+     */
+    private static long reflect(long value, int width) {
+        long result = 0;
+        for(int x = 0; x < width; x++) {
+            result = (result << 1) | (value & 1L);
+            value = value >>> 1;
+        }
+        return result;
+    }
+
+    /**
+     * <p>Returns the specification used by this object.</p>
+     * 
+     * @return CRC specification.
+     */
+    public SerialComCRCSpec getSpec() {
+        return spec;
+    }
+
+    /**
+     * <p>Updates CRC with the given byte.</p>
+     * 
+     * @param b byte to update CRC with (lower 8 bits are used).
+     */
+    @Override
+    public void update(int b) {
+        if(refin == true) {
+            register = (register >>> 8) ^ table[0][(int) (register ^ b) & 0xFF];
+        }else {
+            register = (register << 8) ^ table[0][(int) ((register >>> 56) ^ b) & 0xFF];
+        }
+    }
+
+    /**
+     * <p>Updates CRC with the given bytes.</p>
+     * 
+     * @param data byte type buffer containing data bytes.
+     * @param offset position in data buffer from where CRC calculation should start.
+     * @param length number of bytes to include in calculation.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     * @throws IndexOutOfBoundsException if offset is negative, length is negative, or length is 
+     *          greater than data.length - offset.
+     */
+    @Override
+    public void update(byte[] data, int offset, int length) {
+        if(data == null) {
+            throw new NullPointerException("Argument data can not be null !");
+        }
+        if((offset < 0) || (length < 0) || (length > (data.length - offset))) {
+            throw new IndexOutOfBoundsException("Index violation detected !");
+        }
+
+        final long[][] t = table;
+        long crc = register;
+        int x = offset;
+        final int end = offset + length;
+
+        if(refin == true) {
+            while((end - x) >= 8) {
+                crc ^= (data[x] & 0xFFL) | ((data[x + 1] & 0xFFL) << 8) | ((data[x + 2] & 0xFFL) << 16) | 
+                        ((data[x + 3] & 0xFFL) << 24) | ((data[x + 4] & 0xFFL) << 32) | ((data[x + 5] & 0xFFL) << 40) | 
+                        ((data[x + 6] & 0xFFL) << 48) | ((data[x + 7] & 0xFFL) << 56);
+                crc = t[7][(int) crc & 0xFF] ^ t[6][(int) (crc >>> 8) & 0xFF] ^ t[5][(int) (crc >>> 16) & 0xFF] ^ 
+                        t[4][(int) (crc >>> 24) & 0xFF] ^ t[3][(int) (crc >>> 32) & 0xFF] ^ t[2][(int) (crc >>> 40) & 0xFF] ^ 
+                        t[1][(int) (crc >>> 48) & 0xFF] ^ t[0][(int) (crc >>> 56)];
+                x += 8;
+            }
+            while(x < end) {
+                crc = (crc >>> 8) ^ t[0][(int) (crc ^ data[x]) & 0xFF];
+                x++;
+            }
+        }else {
+            while((end - x) >= 8) {
+                crc ^= ((data[x] & 0xFFL) << 56) | ((data[x + 1] & 0xFFL) << 48) | ((data[x + 2] & 0xFFL) << 40) | 
+                        ((data[x + 3] & 0xFFL) << 32) | ((data[x + 4] & 0xFFL) << 24) | ((data[x + 5] & 0xFFL) << 16) | 
+                        ((data[x + 6] & 0xFFL) << 8) | (data[x + 7] & 0xFFL);
+                crc = t[7][(int) (crc >>> 56)] ^ t[6][(int) (crc >>> 48) & 0xFF] ^ t[5][(int) (crc >>> 40) & 0xFF] ^ 
+                        t[4][(int) (crc >>> 32) & 0xFF] ^ t[3][(int) (crc >>> 24) & 0xFF] ^ t[2][(int) (crc >>> 16) & 0xFF] ^ 
+                        t[1][(int) (crc >>> 8) & 0xFF] ^ t[0][(int) crc & 0xFF];
+                x += 8;
+            }
+            while(x < end) {
+                crc = (crc << 8) ^ t[0][(int) ((crc >>> 56) ^ data[x]) & 0xFF];
+                x++;
+            }
+        }
+
+        register = crc;
+    }
+
+    /**
+     * <p>Updates CRC with all the bytes in given array.</p>
+     * 
+     * @param data byte type buffer containing data bytes.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     */
+    public void update(byte[] data) {
+        if(data == null) {
+            throw new NullPointerException("Argument data can not be null !");
+        }
+        update(data, 0, data.length);
+    }
+
+    /**
+     * <p>Updates CRC with all remaining bytes in the given buffer. The position of buffer is advanced 
+     * to its limit. Direct buffers are read in place without copying.</p>
+     * 
+     * @param data heap or direct buffer containing data bytes.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     */
+    public void update(ByteBuffer data) {
+        if(data == null) {
+            throw new NullPointerException("Argument data can not be null !");
+        }
+        int x = data.position();
+        final int end = data.limit();
+
+        if(data.hasArray()) {
+            update(data.array(), data.arrayOffset() + x, end - x);
+        }else {
+            while(x < end) {
+                update(data.get(x));
+                x++;
+            }
+        }
+        data.position(end);
+    }
+
+    /**
+     * <p>Returns the CRC value of all the bytes given so far. The object can still be updated with more 
+     * bytes after calling this method.</p>
+     * 
+     * @return current CRC value.
+     */
+    @Override
+    public long getValue() {
+        long crc = (refin == true) ? register : (register >>> (64 - width));
+        if(refin != spec.isRefout()) {
+            crc = reflect(crc, width);
+        }
+        return (crc ^ spec.getXorout()) & mask;
+    }
+
+    /**
+     * <p>Resets CRC to the initial value of specification.</p>
+     */
+    @Override
+    public void reset() {
+        if(refin == true) {
+            register = reflect(spec.getInit(), width);
+        }else {
+            register = spec.getInit() << (64 - width);
+        }
+    }
+
+    /**
+     * <p>Calculates CRC of the given bytes in one call.</p>
+     * 
+     * @param spec CRC algorithm parameters.
+     * @param data byte type buffer containing data bytes.
+     * @param offset position in data buffer from where CRC calculation should start.
+     * @param length number of bytes to include in calculation.
+     * @return CRC value.
+     * @throws NullPointerException if <code>spec</code> or <code>data</code> is <code>null</code>.
+     * @throws IndexOutOfBoundsException if offset is negative, length is negative, or length is 
+     *          greater than data.length - offset.
+     */
+    public static long calculate(SerialComCRCSpec spec, byte[] data, int offset, int length) {
+        SerialComCRC crc = new SerialComCRC(spec);
+        crc.update(data, offset, length);
+        return crc.getValue();
+    }
+}
@@ -0,0 +1,177 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.core.util;
+
+/**
+ * <p>Describes a CRC algorithm using the parameters of the Rocksoft model (width, polynomial, initial 
+ * value, input/output reflection and final xor value). Specifications for commonly used algorithms 
+ * are pre-defined. Any other CRC can be described by creating a new instance and calculated using 
+ * SerialComCRC.</p>
+ * 
+ * <p>Instances are immutable. Two specifications having same parameters are equal, so lookup tables 
+ * built for one are shared with the other.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComCRCSpec {
+
+    /** <p>CRC-8/MAXIM (Dallas 1-wire).</p>*/
+    public static final SerialComCRCSpec CRC8_MAXIM = new SerialComCRCSpec(8, 0x31L, 0x00L, true, true, 0x00L);
+
+    /** <p>CRC-16/ARC (also known as CRC-16 or CRC-16/IBM).</p>*/
+    public static final SerialComCRCSpec CRC16_ARC = new SerialComCRCSpec(16, 0x8005L, 0x0000L, true, true, 0x0000L);
+
+    /** <p>CRC-16/XMODEM (used in Xmodem/Ymodem).</p>*/
+    public static final SerialComCRCSpec CRC16_XMODEM = new SerialComCRCSpec(16, 0x1021L, 0x0000L, false, false, 0x0000L);
+
+    /** <p>CRC-16/KERMIT (also known as CRC-16/CCITT-TRUE).</p>*/
+    public static final SerialComCRCSpec CRC16_KERMIT = new SerialComCRCSpec(16, 0x1021L, 0x0000L, true, true, 0x0000L);
+
+    /** <p>CRC-16/CCITT-FALSE.</p>*/
+    public static final SerialComCRCSpec CRC16_CCITT_FALSE = new SerialComCRCSpec(16, 0x1021L, 0xFFFFL, false, false, 0x0000L);
+
+    /** <p>CRC-16/MODBUS.</p>*/
+    public static final SerialComCRCSpec CRC16_MODBUS = new SerialComCRCSpec(16, 0x8005L, 0xFFFFL, true, true, 0x0000L);
+
+    /** <p>CRC-16/DNP. Note that DNP3 frames transmit this value least significant byte first.</p>*/
+    public static final SerialComCRCSpec CRC16_DNP = new SerialComCRCSpec(16, 0x3D65L, 0x0000L, true, true, 0xFFFFL);
+
+    /** <p>CRC-32 (as used in ethernet, zip, zmodem).</p>*/
+    public static final SerialComCRCSpec CRC32 = new SerialComCRCSpec(32, 0x04C11DB7L, 0xFFFFFFFFL, true, true, 0xFFFFFFFFL);
+
+    /** <p>CRC-32C (Castagnoli).</p>*/
+    public static final SerialComCRCSpec CRC32C = new SerialComCRCSpec(32, 0x1EDC6F41L, 0xFFFFFFFFL, true, true, 0xFFFFFFFFL);
+
+    /** <p>CRC-32/MPEG-2.</p>*/
+    public static final SerialComCRCSpec CRC32_MPEG2 = new SerialComCRCSpec(32, 0x04C11DB7L, 0xFFFFFFFFL, false, false, 0x00000000L);
+
+    private final int width;
+    private final long poly;
+    private final long init;
+    private final boolean refin;
+    private final boolean refout;
+    private final long xorout;
+
+    /**
+     * <p>Creates a new CRC specification. Values of poly, init and xorout are given in normal (not 
+     * reflected) form and only lower width bits of them are used.</p>
+     * 
+     * @param width number of bits in CRC, 1 to 64.
+     * @param poly generator polynomial without the highest degree term.
+     * @param init initial value of CRC register.
+     * @param refin true if bits of each input byte are reflected (least significant bit processed first).
+     * @param refout true if final CRC value is reflected before xorout is applied.
+     * @param xorout value which is xored with the final CRC value.
+     * @throws IllegalArgumentException if width is not in range 1 to 64 or poly is zero.
+     */
+    public SerialComCRCSpec(int width, long poly, long init, boolean refin, boolean refout, long xorout) {
+        if((width < 1) || (width > 64)) {
+            throw new IllegalArgumentException("Argument width must be in range 1 to 64 !");
+        }
+        long mask = (width == 64) ? -1L : ((1L << width) - 1);
+        if((poly & mask) == 0) {
+            throw new IllegalArgumentException("Argument poly can not be zero !");
+        }
+        this.width = width;
+        this.poly = poly & mask;
+        this.init = init & mask;
+        this.refin = refin;
+        this.refout = refout;
+        this.xorout = xorout & mask;
+    }
+
+    /**
+     * <p>Returns number of bits in CRC.</p>
+     * 
+     * @return width of CRC.
+     */
+    public int getWidth() {
+        return width;
+    }
+
+    /**
+     * <p>Returns generator polynomial in normal form.</p>
+     * 
+     * @return polynomial.
+     */
+    public long getPoly() {
+        return poly;
+    }
+
+    /**
+     * <p>Returns initial value of CRC register.</p>
+     * 
+     * @return initial value.
+     */
+    public long getInit() {
+        return init;
+    }
+
+    /**
+     * <p>Returns true if input bytes are reflected.</p>
+     * 
+     * @return true if input is reflected.
+     */
+    public boolean isRefin() {
+        return refin;
+    }
+
+    /**
+     * <p>Returns true if final CRC value is reflected.</p>
+     * 
+     * @return true if output is reflected.
+     */
+    public boolean isRefout() {
+        return refout;
+    }
+
+    /**
+     * <p>Returns value xored with the final CRC value.</p>
+     * 
+     * @return final xor value.
+     */
+    public long getXorout() {
+        return xorout;
+    }
+
+    @Override
+    public boolean equals(Object obj) {
+        if(this == obj) {
+            return true;
+        }
+        if(!(obj instanceof SerialComCRCSpec)) {
+            return false;
+        }
+        SerialComCRCSpec other = (SerialComCRCSpec) obj;
+        return (width == other.width) && (poly == other.poly) && (init == other.init) && 
+                (refin == other.refin) && (refout == other.refout) && (xorout == other.xorout);
+    }
+
+    @Override
+    public int hashCode() {
+        long h = width;
+        h = (31 * h) + poly;
+        h = (31 * h) + init;
+        h = (31 * h) + (refin ? 1 : 0);
+        h = (31 * h) + (refout ? 1 : 0);
+        h = (31 * h) + xorout;
+        return (int) (h ^ (h >>> 32));
+    }
+
+    @Override
+    public String toString() {
+        return "width=" + width + ", poly=0x" + Long.toHexString(poly) + ", init=0x" + Long.toHexString(init) + 
+                ", refin=" + refin + ", refout=" + refout + ", xorout=0x" + Long.toHexString(xorout);
+    }
+}
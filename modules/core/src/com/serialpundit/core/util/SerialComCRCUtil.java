@@ -13,16 +13,22 @@
 
 package com.serialpundit.core.util;
 
+import java.nio.ByteBuffer;
+
 /**
  * <p>Utility class to calculate and generate CRC values for a given message. This can be used 
  * in X/Y/Z modem etc protocol implementations and in developing custom protocols for transmitting 
  * data over serial port.</p>
  * 
+ * <p>CRC is calculated 8 bytes at a time (slicing-by-8) using tables derived from the byte-wise tables 
+ * when the class is loaded. The updateXXX methods can be used to calculate CRC incrementally as data 
+ * arrives; the state returned by one call is passed to the next call.</p>
+ * 
  * @author Rishi Gupta
  */
 public final class SerialComCRCUtil {
 
-    private int[] crc8wire1Table = { 
+    private static final int[] crc8wire1Table = { 
             0x00, 0x5e, 0xbc, 0xe2, 0x61, 0x3f, 0xdd, 0x83, 0xc2, 0x9c, 0x7e, 
             0x20, 0xa3, 0xfd, 0x1f, 0x41, 0x9d, 0xc3, 0x21, 0x7f, 0xfc, 0xa2, 
             0x40, 0x1e, 0x5f, 0x01, 0xe3, 0xbd, 0x3e, 0x60, 0x82, 0xdc, 0x23, 
@@ -49,7 +55,7 @@ public final class SerialComCRCUtil {
             0x89, 0x6b, 0x35
     };
 
-    private int[] crc16Table = {
+    private static final int[] crc16Table = {
             0x0000, 0xc0c1, 0xc181, 0x0140, 0xc301, 0x03c0, 0x0280, 0xc241,
             0xc601, 0x06c0, 0x0780, 0xc741, 0x0500, 0xc5c1, 0xc481, 0x0440,
             0xcc01, 0x0cc0, 0x0d80, 0xcd41, 0x0f00, 0xcfc1, 0xce81, 0x0e40,
@@ -84,7 +90,7 @@ public final class SerialComCRCUtil {
             0x8201, 0x42c0, 0x4380, 0x8341, 0x4100, 0x81c1, 0x8081, 0x4040
     };
 
-    private int[] crc16ccittTable = {
+    private static final int[] crc16ccittTable = {
             0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7, 
             0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
             0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
@@ -119,7 +125,7 @@ public final class SerialComCRCUtil {
             0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
     };
 
-    private int[] crc16dnpTable = {
+    private static final int[] crc16dnpTable = {
             0x0000, 0x365e, 0x6cbc, 0x5ae2, 0xd978, 0xef26, 0xb5c4, 0x839a,
             0xff89, 0xc9d7, 0x9335, 0xa56b, 0x26f1, 0x10af, 0x4a4d, 0x7c13,
             0xb26b, 0x8435, 0xded7, 0xe889, 0x6b13, 0x5d4d, 0x07af, 0x31f1,
@@ -154,7 +160,7 @@ public final class SerialComCRCUtil {
             0x91af, 0xa7f1, 0xfd13, 0xcb4d, 0x48d7, 0x7e89, 0x246b, 0x1235			
     };
 
-    private int[] crc16ibmTable = {
+    private static final int[] crc16ibmTable = {
             0x0000, 0xc0c1, 0xc181, 0x0140, 0xc301, 0x03c0, 0x0280, 0xc241,
             0xc601, 0x06c0, 0x0780, 0xc741, 0x0500, 0xc5c1, 0xc481, 0x0440,
             0xcc01, 0x0cc0, 0x0d80, 0xcd41, 0x0f00, 0xcfc1, 0xce81, 0x0e40,
@@ -189,6 +195,13 @@ public final class SerialComCRCUtil {
             0x8201, 0x42c0, 0x4380, 0x8341, 0x4100, 0x81c1, 0x8081, 0x4040	
     };
 
+    // slicing-by-8 tables, [k][i] is CRC contribution of byte i followed by k zero bytes.
+    private static final int[][] crc8wire1Slices = buildReflectedSlices(crc8wire1Table);
+    private static final int[][] crc16Slices = buildReflectedSlices(crc16Table);
+    private static final int[][] crc16ccittSlices = buildMSBFirstSlices(crc16ccittTable);
+    private static final int[][] crc16dnpSlices = buildReflectedSlices(crc16dnpTable);
+    private static final int[][] crc16ibmSlices = buildReflectedSlices(crc16ibmTable);
+
     /**
      * <p>Allocates a new SerialComCRCUtil object.</p>
      */
@@ -247,10 +260,133 @@ public final class SerialComCRCUtil {
         return checkSum;
     }
 
+    /*
+     * Build slicing tables for CRC in which data is shifted in least significant bit first (reflected). 
+     * Works for 8 and 16 bit CRCs as state is shifted right.
+     */
+    private static int[][] buildReflectedSlices(int[] table) {
+        int[][] slices = new int[8][256];
+        for(int i = 0; i < 256; i++) {
+            slices[0][i] = table[i];
+        }
+        for(int k = 1; k < 8; k++) {
+            for(int i = 0; i < 256; i++) {
+                slices[k][i] = (slices[k - 1][i] >>> 8) ^ table[slices[k - 1][i] & 0xFF];
+            }
+        }
+        return slices;
+    }
+
+    /*
+     * Build slicing tables for 16 bit CRC in which data is shifted in most significant bit first.
+     */
+    private static int[][] buildMSBFirstSlices(int[] table) {
+        int[][] slices = new int[8][256];
+        for(int i = 0; i < 256; i++) {
+            slices[0][i] = table[i];
+        }
+        for(int k = 1; k < 8; k++) {
+            for(int i = 0; i < 256; i++) {
+                slices[k][i] = ((slices[k - 1][i] << 8) & 0xFFFF) ^ table[(slices[k - 1][i] >>> 8) & 0xFF];
+            }
+        }
+        return slices;
+    }
+
+    private static void checkBounds(final byte[] data, int offset, int length) {
+        if(data == null) {
+            throw new NullPointerException("Argument data can not be null !");
+        }
+        if((offset < 0) || (length < 0) || (length > (data.length - offset))) {
+            throw new IndexOutOfBoundsException("Index violation detected !");
+        }
+    }
+
+    private static int updateReflected(final int[][] t, int crc, final byte[] data, int offset, int length) {
+        int x = offset;
+        final int end = offset + length;
+        while((end - x) >= 8) {
+            crc = t[7][(crc ^ data[x]) & 0xFF] ^ t[6][((crc >>> 8) ^ data[x + 1]) & 0xFF] ^ 
+                    t[5][data[x + 2] & 0xFF] ^ t[4][data[x + 3] & 0xFF] ^ t[3][data[x + 4] & 0xFF] ^ 
+                    t[2][data[x + 5] & 0xFF] ^ t[1][data[x + 6] & 0xFF] ^ t[0][data[x + 7] & 0xFF];
+            x += 8;
+        }
+        while(x < end) {
+            crc = (crc >>> 8) ^ t[0][(crc ^ data[x]) & 0xFF];
+            x++;
+        }
+        return crc;
+    }
+
+    private static int updateMSBFirst(final int[][] t, int crc, final byte[] data, int offset, int length) {
+        int x = offset;
+        final int end = offset + length;
+        while((end - x) >= 8) {
+            crc = t[7][((crc >>> 8) ^ data[x]) & 0xFF] ^ t[6][(crc ^ data[x + 1]) & 0xFF] ^ 
+                    t[5][data[x + 2] & 0xFF] ^ t[4][data[x + 3] & 0xFF] ^ t[3][data[x + 4] & 0xFF] ^ 
+                    t[2][data[x + 5] & 0xFF] ^ t[1][data[x + 6] & 0xFF] ^ t[0][data[x + 7] & 0xFF];
+            x += 8;
+        }
+        while(x < end) {
+            crc = (t[0][((crc >>> 8) ^ data[x]) & 0xFF] ^ (crc << 8)) & 0xFFFF;
+            x++;
+        }
+        return crc;
+    }
+
+    /*
+     * Consume all remaining bytes of the given buffer. Heap buffers are processed through their backing 
+     * array, direct buffers are read using absolute get so no copy is made.
+     */
+    private static int updateBuffer(final int[][] t, boolean reflected, int crc, final ByteBuffer data) {
+        if(data == null) {
+            throw new NullPointerException("Argument data can not be null !");
+        }
+
+        int x = data.position();
+        final int end = data.limit();
+
+        if(data.hasArray()) {
+            if(reflected == true) {
+                crc = updateReflected(t, crc, data.array(), data.arrayOffset() + x, end - x);
+            }else {
+                crc = updateMSBFirst(t, crc, data.array(), data.arrayOffset() + x, end - x);
+            }
+            data.position(end);
+            return crc;
+        }
+
+        if(reflected == true) {
+            while((end - x) >= 8) {
+                crc = t[7][(crc ^ data.get(x)) & 0xFF] ^ t[6][((crc >>> 8) ^ data.get(x + 1)) & 0xFF] ^ 
+                        t[5][data.get(x + 2) & 0xFF] ^ t[4][data.get(x + 3) & 0xFF] ^ t[3][data.get(x + 4) & 0xFF] ^ 
+                        t[2][data.get(x + 5) & 0xFF] ^ t[1][data.get(x + 6) & 0xFF] ^ t[0][data.get(x + 7) & 0xFF];
+                x += 8;
+            }
+            while(x < end) {
+                crc = (crc >>> 8) ^ t[0][(crc ^ data.get(x)) & 0xFF];
+                x++;
+            }
+        }else {
+            while((end - x) >= 8) {
+                crc = t[7][((crc >>> 8) ^ data.get(x)) & 0xFF] ^ t[6][(crc ^ data.get(x + 1)) & 0xFF] ^ 
+                        t[5][data.get(x + 2) & 0xFF] ^ t[4][data.get(x + 3) & 0xFF] ^ t[3][data.get(x + 4) & 0xFF] ^ 
+                        t[2][data.get(x + 5) & 0xFF] ^ t[1][data.get(x + 6) & 0xFF] ^ t[0][data.get(x + 7) & 0xFF];
+                x += 8;
+            }
+            while(x < end) {
+                crc = (t[0][((crc >>> 8) ^ data.get(x)) & 0xFF] ^ (crc << 8)) & 0xFFFF;
+                x++;
+            }
+        }
+
+        data.position(end);
+        return crc;
+    }
+
     /** 
      * <p>Calculates CRC-8 Dallas 1-wire value for the data bytes given. The data bytes at start and end index 
-     * are included in calculation. It uses pre-defined table for speedily calculating CRC8-1-wire 
-     * value of the given data.</p>
+     * are included in calculation.</p>
      * 
      * @param data byte type buffer for whom CRC is to be calculated.
      * @param start offset in supplied data buffer from where CRC calculation should start.
@@ -258,19 +394,43 @@ public final class SerialComCRCUtil {
      * @return CRC value of specified data bytes.
      */
     public int getCRC8Dallas1WireValue(byte[] data, int start, int end) {
-        int x = start;
-        int crcVal = 0x00;
-        while (x <= end) {
-            crcVal = (crc8wire1Table[crcVal ^ data[x]]) & 0xFF;
-            x++;
-        }
-        return crcVal;
+        return updateReflected(crc8wire1Slices, 0x00, data, start, end - start + 1);
+    }
+
+    /** 
+     * <p>Updates CRC-8 Dallas 1-wire state with the given data bytes. Initial state is 0x00 and the final 
+     * state is the CRC value.</p>
+     * 
+     * @param crc state returned by previous call or 0x00 for first call.
+     * @param data byte type buffer containing next data bytes.
+     * @param offset position in data buffer from where CRC calculation should start.
+     * @param length number of bytes to include in calculation.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     * @throws IndexOutOfBoundsException if offset is negative, length is negative, or length is 
+     *          greater than data.length - offset.
+     */
+    public int updateCRC8Dallas1Wire(int crc, final byte[] data, int offset, int length) {
+        checkBounds(data, offset, length);
+        return updateReflected(crc8wire1Slices, crc & 0xFF, data, offset, length);
+    }
+
+    /** 
+     * <p>Updates CRC-8 Dallas 1-wire state with all remaining bytes in the given buffer. The position of 
+     * buffer is advanced to its limit.</p>
+     * 
+     * @param crc state returned by previous call or 0x00 for first call.
+     * @param data heap or direct buffer containing next data bytes.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     */
+    public int updateCRC8Dallas1Wire(int crc, final ByteBuffer data) {
+        return updateBuffer(crc8wire1Slices, true, crc & 0xFF, data);
     }
 
     /** 
      * <p>Calculates CRC-16 value for the data bytes given. The data bytes at start and end index 
-     * are included in calculation. It uses pre-defined table for speedily calculating CRC-16 
-     * value of the given data.</p>
+     * are included in calculation.</p>
      * 
      * @param data byte type buffer for whom CRC is to be calculated.
      * @param start offset in supplied data buffer from where CRC calculation should start.
@@ -278,19 +438,43 @@ public final class SerialComCRCUtil {
      * @return CRC value of specified data bytes.
      */
     public int getCRC16Value(byte[] data, int start, int end) {
-        int x = start;
-        int crcVal = 0x0000;
-        while (x <= end) {
-            crcVal = (crc16Table[(crcVal ^ (data[x])) & 0xFF] ^ (crcVal >> 8)) & 0xFFFF;
-            x++;
-        }
-        return crcVal;
+        return updateReflected(crc16Slices, 0x0000, data, start, end - start + 1);
+    }
+
+    /** 
+     * <p>Updates CRC-16 state with the given data bytes. Initial state is 0x0000 and the final state is 
+     * the CRC value.</p>
+     * 
+     * @param crc state returned by previous call or 0x0000 for first call.
+     * @param data byte type buffer containing next data bytes.
+     * @param offset position in data buffer from where CRC calculation should start.
+     * @param length number of bytes to include in calculation.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     * @throws IndexOutOfBoundsException if offset is negative, length is negative, or length is 
+     *          greater than data.length - offset.
+     */
+    public int updateCRC16(int crc, final byte[] data, int offset, int length) {
+        checkBounds(data, offset, length);
+        return updateReflected(crc16Slices, crc & 0xFFFF, data, offset, length);
+    }
+
+    /** 
+     * <p>Updates CRC-16 state with all remaining bytes in the given buffer. The position of buffer is 
+     * advanced to its limit.</p>
+     * 
+     * @param crc state returned by previous call or 0x0000 for first call.
+     * @param data heap or direct buffer containing next data bytes.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     */
+    public int updateCRC16(int crc, final ByteBuffer data) {
+        return updateBuffer(crc16Slices, true, crc & 0xFFFF, data);
     }
 
     /** 
      * <p>Calculates CRC-16-CCITT value for the data bytes given. The data bytes at start and end index 
-     * are included in calculation. It uses pre-defined table for speedily calculating CRC-16-CCITT 
-     * value of the given data. This algorithm is used in implementing Xmodem protocol.</p>
+     * are included in calculation. This algorithm is used in implementing Xmodem protocol.</p>
      * 
      * @param data byte type buffer for whom CRC is to be calculated.
      * @param start offset in supplied data buffer from where CRC calculation should start.
@@ -298,19 +482,43 @@ public final class SerialComCRCUtil {
      * @return CRC value of specified data bytes.
      */
     public int getCRC16CCITTValue(byte[] data, int start, int end) {
-        int x = start;
-        int crcVal = 0x0000;
-        while (x <= end) {
-            crcVal = (crc16ccittTable[((crcVal >> 8) ^ (data[x])) & 0xFF] ^ (crcVal << 8)) & 0xFFFF;
-            x++;
-        }
-        return crcVal;
+        return updateMSBFirst(crc16ccittSlices, 0x0000, data, start, end - start + 1);
+    }
+
+    /** 
+     * <p>Updates CRC-16-CCITT (Xmodem) state with the given data bytes. Initial state is 0x0000 and the 
+     * final state is the CRC value.</p>
+     * 
+     * @param crc state returned by previous call or 0x0000 for first call.
+     * @param data byte type buffer containing next data bytes.
+     * @param offset position in data buffer from where CRC calculation should start.
+     * @param length number of bytes to include in calculation.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     * @throws IndexOutOfBoundsException if offset is negative, length is negative, or length is 
+     *          greater than data.length - offset.
+     */
+    public int updateCRC16CCITT(int crc, final byte[] data, int offset, int length) {
+        checkBounds(data, offset, length);
+        return updateMSBFirst(crc16ccittSlices, crc & 0xFFFF, data, offset, length);
+    }
+
+    /** 
+     * <p>Updates CRC-16-CCITT (Xmodem) state with all remaining bytes in the given buffer. The position 
+     * of buffer is advanced to its limit.</p>
+     * 
+     * @param crc state returned by previous call or 0x0000 for first call.
+     * @param data heap or direct buffer containing next data bytes.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     */
+    public int updateCRC16CCITT(int crc, final ByteBuffer data) {
+        return updateBuffer(crc16ccittSlices, false, crc & 0xFFFF, data);
     }
 
     /** 
      * <p>Calculates CRC-16-DNP value for the data bytes given. The data bytes at start and end index 
-     * are included in calculation. It uses pre-defined table for speedily calculating CRC-16-DNP 
-     * value of the given data.</p>
+     * are included in calculation.</p>
      * 
      * @param data byte type buffer for whom CRC is to be calculated.
      * @param start offset in supplied data buffer from where CRC calculation should start.
@@ -318,13 +526,49 @@ public final class SerialComCRCUtil {
      * @return CRC value of specified data bytes.
      */
     public int getCRC16DNPValue(byte[] data, int start, int end) {
-        int x = start;
-        int crcVal = 0x0000;
-        while (x <= end) {
-            crcVal = ((crcVal >> 8) ^ crc16dnpTable[(crcVal ^ data[x]) & 0x00FF]);
-            x++;
-        }
-        crcVal = ~crcVal & 0XFFFF;
+        return finishCRC16DNP(updateReflected(crc16dnpSlices, 0x0000, data, start, end - start + 1));
+    }
+
+    /** 
+     * <p>Updates CRC-16-DNP state with the given data bytes. Initial state is 0x0000. The final state 
+     * must be passed to finishCRC16DNP method to get the CRC value.</p>
+     * 
+     * @param crc state returned by previous call or 0x0000 for first call.
+     * @param data byte type buffer containing next data bytes.
+     * @param offset position in data buffer from where CRC calculation should start.
+     * @param length number of bytes to include in calculation.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     * @throws IndexOutOfBoundsException if offset is negative, length is negative, or length is 
+     *          greater than data.length - offset.
+     */
+    public int updateCRC16DNP(int crc, final byte[] data, int offset, int length) {
+        checkBounds(data, offset, length);
+        return updateReflected(crc16dnpSlices, crc & 0xFFFF, data, offset, length);
+    }
+
+    /** 
+     * <p>Updates CRC-16-DNP state with all remaining bytes in the given buffer. The position of buffer 
+     * is advanced to its limit.</p>
+     * 
+     * @param crc state returned by previous call or 0x0000 for first call.
+     * @param data heap or direct buffer containing next data bytes.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     */
+    public int updateCRC16DNP(int crc, final ByteBuffer data) {
+        return updateBuffer(crc16dnpSlices, true, crc & 0xFFFF, data);
+    }
+
+    /** 
+     * <p>Converts the final CRC-16-DNP state to CRC value (complemented and byte swapped as required 
+     * by DNP3 frames).</p>
+     * 
+     * @param crc state returned by last call to updateCRC16DNP method.
+     * @return CRC value.
+     */
+    public int finishCRC16DNP(int crc) {
+        int crcVal = ~crc & 0XFFFF;
         int b1 = crcVal & 0xFF;
         int b2 = (crcVal >>> 8) & 0xFF;
         return (b1 << 8 | b2 << 0) & 0xFFFF;
@@ -332,8 +576,7 @@ public final class SerialComCRCUtil {
 
     /** 
      * <p>Calculates CRC-16-IBM value for the data bytes given. The data bytes at start and end index 
-     * are included in calculation. It uses pre-defined table for speedily calculating CRC-16-IBM (modbus) 
-     * value of the given data.</p>
+     * are included in calculation. It calculates CRC-16-IBM (modbus) value of the given data.</p>
      * 
      * @param data byte type buffer for whom CRC is to be calculated.
      * @param start offset in supplied data buffer from where CRC calculation should start.
@@ -341,12 +584,37 @@ public final class SerialComCRCUtil {
      * @return CRC value of specified data bytes.
      */
     public int getCRC16IBMValue(byte[] data, int start, int end) {
-        int x = start;
-        int crcVal = 0xFFFF;
-        while (x <= end) {
-            crcVal = ((crcVal >> 8) ^ crc16ibmTable[(crcVal ^ data[x]) & 0xFF]) & 0xFFFF;
-            x++;
-        }
-        return crcVal;
-    }	 
+        return updateReflected(crc16ibmSlices, 0xFFFF, data, start, end - start + 1);
+    }
+
+    /** 
+     * <p>Updates CRC-16-IBM (modbus) state with the given data bytes. Initial state is 0xFFFF and the 
+     * final state is the CRC value.</p>
+     * 
+     * @param crc state returned by previous call or 0xFFFF for first call.
+     * @param data byte type buffer containing next data bytes.
+     * @param offset position in data buffer from where CRC calculation should start.
+     * @param length number of bytes to include in calculation.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     * @throws IndexOutOfBoundsException if offset is negative, length is negative, or length is 
+     *          greater than data.length - offset.
+     */
+    public int updateCRC16IBM(int crc, final byte[] data, int offset, int length) {
+        checkBounds(data, offset, length);
+        return updateReflected(crc16ibmSlices, crc & 0xFFFF, data, offset, length);
+    }
+
+    /** 
+     * <p>Updates CRC-16-IBM (modbus) state with all remaining bytes in the given buffer. The position of 
+     * buffer is advanced to its limit.</p>
+     * 
+     * @param crc state returned by previous call or 0xFFFF for first call.
+     * @param data heap or direct buffer containing next data bytes.
+     * @return updated CRC state.
+     * @throws NullPointerException if <code>data</code> is <code>null</code>.
+     */
+    public int updateCRC16IBM(int crc, final ByteBuffer data) {
+        return updateBuffer(crc16ibmSlices, true, crc & 0xFFFF, data);
+    }
 }
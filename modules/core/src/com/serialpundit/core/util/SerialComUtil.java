@@ -18,6 +18,9 @@ import java.io.IOException;
 import java.io.InputStream;
 import java.io.InputStreamReader;
 import java.io.OutputStream;
+import java.nio.BufferOverflowException;
+import java.nio.ByteBuffer;
+import java.nio.CharBuffer;
 import java.util.ArrayList;
 
 /**
@@ -29,6 +32,24 @@ public final class SerialComUtil {
 
     private static final String HEXNUM = "0123456789ABCDEF";
 
+    // nibble to hex digit lookup.
+    private static final char[] HEXCHARS = HEXNUM.toCharArray();
+
+    // hex digit (ASCII) to nibble lookup, -1 for characters which are not hex digits.
+    private static final byte[] HEXVALUES = new byte[128];
+    static {
+        for(int x = 0; x < HEXVALUES.length; x++) {
+            HEXVALUES[x] = -1;
+        }
+        for(int x = 0; x < 10; x++) {
+            HEXVALUES['0' + x] = (byte) x;
+        }
+        for(int x = 0; x < 6; x++) {
+            HEXVALUES['A' + x] = (byte) (10 + x);
+            HEXVALUES['a' + x] = (byte) (10 + x);
+        }
+    }
+
     /**
      * <p>Allocates a new SerialComUtil object.</p>
      */
@@ -84,7 +105,7 @@ public final class SerialComUtil {
             sBuilder = new StringBuilder(2 * data.length);
             if(separator != null) {
                 for (final byte b : data) {
-                    sBuilder.append(HEXNUM.charAt((b & 0xF0) >> 4)).append(HEXNUM.charAt((b & 0x0F)));
+                    sBuilder.append(HEXCHARS[(b & 0xF0) >> 4]).append(HEXCHARS[b & 0x0F]);
                     if(x < length) {
                         sBuilder.append(separator);
                     }
@@ -92,7 +113,7 @@ public final class SerialComUtil {
                 }
             }else {
                 for (final byte b : data) {
-                    sBuilder.append(HEXNUM.charAt((b & 0xF0) >> 4)).append(HEXNUM.charAt((b & 0x0F)));
+                    sBuilder.append(HEXCHARS[(b & 0xF0) >> 4]).append(HEXCHARS[b & 0x0F]);
                 }
             }
             return sBuilder.toString();
@@ -109,23 +130,238 @@ public final class SerialComUtil {
      * @throws IllegalArgumentException if hexStringData is null.
      */
     public static byte[] hexStringToByteArray(final String hexStringData) {
-        int i = 0;
-        int j = 0;
         if(hexStringData == null) {
             throw new IllegalArgumentException("Argument hexStringData can not be null !");
         }
 
-        String hexStr = hexStringData.trim().replaceAll("0x", "");
-        hexStr = hexStr.replaceAll("\\s+","");
-        byte[] data = new byte[hexStr.length()/2];
+        // count digits first so that exactly sized array is allocated and no intermediate string is created.
+        int digits = scanHex(hexStringData, 0, hexStringData.length(), null, 0, null);
+        byte[] data = new byte[digits / 2];
+        scanHex(hexStringData, 0, hexStringData.length(), data, 0, null);
+        return data;
+    }
 
-        while(i <= (hexStr.length() - 1)) {
-            byte character = (byte) Integer.parseInt(hexStr.substring(i, i+2), 16);
-            data[j] = character;
-            j++;
-            i += 2;
+    /*
+     * Walks hex digits in given characters, skipping white spaces and 0x prefixes. If dst or dstBuf is 
+     * not null, decoded bytes are saved in it. Returns number of hex digits found.
+     */
+    private static int scanHex(final CharSequence src, int start, int end, byte[] dst, int dstOffset, ByteBuffer dstBuf) {
+        int digits = 0;
+        int high = 0;
+        int value = 0;
+        char c = 0;
+
+        for(int x = start; x < end; x++) {
+            c = src.charAt(x);
+            if((c == '0') && ((digits & 1) == 0) && ((x + 1) < end) && ((src.charAt(x + 1) == 'x') || (src.charAt(x + 1) == 'X'))) {
+                x++;
+                continue;
+            }
+            if(Character.isWhitespace(c)) {
+                continue;
+            }
+            value = (c < 128) ? HEXVALUES[c] : -1;
+            if(value < 0) {
+                throw new IllegalArgumentException("Invalid hex character '" + c + "' at index " + x + " !");
+            }
+            if((digits & 1) == 0) {
+                high = value;
+            }else {
+                if(dst != null) {
+                    dst[dstOffset] = (byte) ((high << 4) | value);
+                    dstOffset++;
+                }else if(dstBuf != null) {
+                    dstBuf.put((byte) ((high << 4) | value));
+                }
+            }
+            digits++;
         }
-        return data;
+
+        if((digits & 1) != 0) {
+            throw new IllegalArgumentException("Odd number of hex digits in given data !");
+        }
+        return digits;
+    }
+
+    /**
+     * <p>Encodes given bytes as hex characters (2 per byte, upper case) in the given character array. 
+     * No object is allocated, so this can be used for logging at high data rates.</p>
+     * 
+     * @param src bytes to be encoded.
+     * @param offset index in src from where encoding should start.
+     * @param length number of bytes to encode.
+     * @param dst array in which hex characters will be saved.
+     * @param dstOffset index in dst from where characters should be saved.
+     * @return number of characters saved in dst i.e. 2 * length.
+     * @throws NullPointerException if src or dst is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid or dst does not have enough space.
+     */
+    public static int encodeHex(final byte[] src, int offset, int length, final char[] dst, int dstOffset) {
+        if((src == null) || (dst == null)) {
+            throw new NullPointerException("Argument src and dst can not be null !");
+        }
+        if((offset < 0) || (length < 0) || (length > (src.length - offset))) {
+            throw new IndexOutOfBoundsException("Index violation detected !");
+        }
+        if((dstOffset < 0) || ((2L * length) > (dst.length - dstOffset))) {
+            throw new IndexOutOfBoundsException("Argument dst does not have enough space !");
+        }
+
+        int b = 0;
+        final int end = offset + length;
+        for(int x = offset; x < end; x++) {
+            b = src[x];
+            dst[dstOffset] = HEXCHARS[(b >> 4) & 0x0F];
+            dst[dstOffset + 1] = HEXCHARS[b & 0x0F];
+            dstOffset += 2;
+        }
+        return 2 * length;
+    }
+
+    /**
+     * <p>Encodes given bytes as hex characters (2 per byte, upper case) at the current position of the 
+     * given character buffer.</p>
+     * 
+     * @param src bytes to be encoded.
+     * @param offset index in src from where encoding should start.
+     * @param length number of bytes to encode.
+     * @param dst buffer in which hex characters will be put.
+     * @throws NullPointerException if src or dst is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid.
+     * @throws BufferOverflowException if dst does not have enough space remaining.
+     */
+    public static void encodeHex(final byte[] src, int offset, int length, final CharBuffer dst) {
+        if((src == null) || (dst == null)) {
+            throw new NullPointerException("Argument src and dst can not be null !");
+        }
+        if(dst.hasArray() && (dst.remaining() >= (2L * length))) {
+            int count = encodeHex(src, offset, length, dst.array(), dst.arrayOffset() + dst.position());
+            dst.position(dst.position() + count);
+            return;
+        }
+        if((offset < 0) || (length < 0) || (length > (src.length - offset))) {
+            throw new IndexOutOfBoundsException("Index violation detected !");
+        }
+        int b = 0;
+        final int end = offset + length;
+        for(int x = offset; x < end; x++) {
+            b = src[x];
+            dst.put(HEXCHARS[(b >> 4) & 0x0F]).put(HEXCHARS[b & 0x0F]);
+        }
+    }
+
+    /**
+     * <p>Encodes given bytes as ASCII hex characters (2 per byte, upper case) at the current position of 
+     * the given byte buffer. This is useful for writing hex dumps directly to files or sockets.</p>
+     * 
+     * @param src bytes to be encoded.
+     * @param offset index in src from where encoding should start.
+     * @param length number of bytes to encode.
+     * @param dst buffer in which hex characters will be put.
+     * @throws NullPointerException if src or dst is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid.
+     * @throws BufferOverflowException if dst does not have enough space remaining.
+     */
+    public static void encodeHex(final byte[] src, int offset, int length, final ByteBuffer dst) {
+        if((src == null) || (dst == null)) {
+            throw new NullPointerException("Argument src and dst can not be null !");
+        }
+        if((offset < 0) || (length < 0) || (length > (src.length - offset))) {
+            throw new IndexOutOfBoundsException("Index violation detected !");
+        }
+        int b = 0;
+        final int end = offset + length;
+        for(int x = offset; x < end; x++) {
+            b = src[x];
+            dst.put((byte) HEXCHARS[(b >> 4) & 0x0F]).put((byte) HEXCHARS[b & 0x0F]);
+        }
+    }
+
+    /**
+     * <p>Appends hex representation of given bytes to the given Appendable (for example StringBuilder, 
+     * CharBuffer or Writer). Separator (if not null) is appended between two hex values. Unlike 
+     * byteArrayToHexString, caller can reuse the same StringBuilder for every chunk.</p>
+     * 
+     * @param out destination to which characters are appended.
+     * @param src bytes to be encoded.
+     * @param offset index in src from where encoding should start.
+     * @param length number of bytes to encode.
+     * @param separator character sequence to be inserted between hex values, may be null.
+     * @return the given Appendable.
+     * @throws IOException if out throws IOException.
+     * @throws NullPointerException if out or src is null.
+     * @throws IndexOutOfBoundsException if offset/length are invalid.
+     */
+    public static Appendable appendHex(final Appendable out, final byte[] src, int offset, int length, 
+            final CharSequence separator) throws IOException {
+        if((out == null) || (src == null)) {
+            throw new NullPointerException("Argument out and src can not be null !");
+        }
+        if((offset < 0) || (length < 0) || (length > (src.length - offset))) {
+            throw new IndexOutOfBoundsException("Index violation detected !");
+        }
+        int b = 0;
+        final int end = offset + length;
+        for(int x = offset; x < end; x++) {
+            b = src[x];
+            if((separator != null) && (x > offset)) {
+                out.append(separator);
+            }
+            out.append(HEXCHARS[(b >> 4) & 0x0F]).append(HEXCHARS[b & 0x0F]);
+        }
+        return out;
+    }
+
+    /**
+     * <p>Decodes hex characters between start (inclusive) and end (exclusive) index into the given byte 
+     * array. White spaces and 0x prefixes are ignored as in hexStringToByteArray. No object is allocated.</p>
+     * 
+     * @param src characters to be decoded (for example String, StringBuilder or CharBuffer).
+     * @param start index in src from where decoding should start.
+     * @param end index in src till which decoding should be done.
+     * @param dst array in which decoded bytes will be saved.
+     * @param dstOffset index in dst from where bytes should be saved.
+     * @return number of bytes saved in dst.
+     * @throws NullPointerException if src or dst is null.
+     * @throws IllegalArgumentException if src contains invalid characters or odd number of hex digits.
+     * @throws IndexOutOfBoundsException if start/end are invalid or dst does not have enough space.
+     */
+    public static int decodeHex(final CharSequence src, int start, int end, final byte[] dst, int dstOffset) {
+        if((src == null) || (dst == null)) {
+            throw new NullPointerException("Argument src and dst can not be null !");
+        }
+        if((start < 0) || (end > src.length()) || (start > end)) {
+            throw new IndexOutOfBoundsException("Index violation detected !");
+        }
+        int count = scanHex(src, start, end, null, 0, null) / 2;
+        if((dstOffset < 0) || (count > (dst.length - dstOffset))) {
+            throw new IndexOutOfBoundsException("Argument dst does not have enough space !");
+        }
+        scanHex(src, start, end, dst, dstOffset, null);
+        return count;
+    }
+
+    /**
+     * <p>Decodes all hex characters in src at the current position of the given byte buffer. White spaces 
+     * and 0x prefixes are ignored as in hexStringToByteArray.</p>
+     * 
+     * @param src characters to be decoded (for example String, StringBuilder or CharBuffer).
+     * @param dst buffer in which decoded bytes will be put.
+     * @return number of bytes put in dst.
+     * @throws NullPointerException if src or dst is null.
+     * @throws IllegalArgumentException if src contains invalid characters or odd number of hex digits.
+     * @throws BufferOverflowException if dst does not have enough space remaining.
+     */
+    public static int decodeHex(final CharSequence src, final ByteBuffer dst) {
+        if((src == null) || (dst == null)) {
+            throw new NullPointerException("Argument src and dst can not be null !");
+        }
+        int count = scanHex(src, 0, src.length(), null, 0, null) / 2;
+        if(count > dst.remaining()) {
+            throw new BufferOverflowException();
+        }
+        scanHex(src, 0, src.length(), null, 0, dst);
+        return count;
     }
 
     /**
@@ -137,7 +373,28 @@ public final class SerialComUtil {
      * @return decoded binary-coded decimal.
      */
     public static String decodeBCD(final short bcd) {
-        return String.format("%x.%02x", (bcd & 0xFF00) >> 8, bcd & 0x00FF);
+        StringBuilder sb = new StringBuilder(5);
+        appendBCD(sb, bcd);
+        return sb.toString();
+    }
+
+    /**
+     * <p>Appends decoded binary-coded decimal number to the given StringBuilder in the same format as 
+     * returned by decodeBCD method, without creating any intermediate object.</p>
+     *
+     * @param sb StringBuilder to which decoded number is appended.
+     * @param bcd binary-coded decimal to decode.
+     * @return the given StringBuilder.
+     */
+    public static StringBuilder appendBCD(final StringBuilder sb, final short bcd) {
+        int high = (bcd & 0xFF00) >> 8;
+        int low = bcd & 0x00FF;
+        if(high > 0x0F) {
+            sb.append(Character.toLowerCase(HEXCHARS[high >> 4]));
+        }
+        sb.append(Character.toLowerCase(HEXCHARS[high & 0x0F])).append('.');
+        sb.append(Character.toLowerCase(HEXCHARS[low >> 4])).append(Character.toLowerCase(HEXCHARS[low & 0x0F]));
+        return sb;
     }
 
     /**
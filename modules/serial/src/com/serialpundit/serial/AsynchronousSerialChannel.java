@@ -0,0 +1,599 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.AsynchronousByteChannel;
+import java.nio.channels.AsynchronousCloseException;
+import java.nio.channels.ClosedChannelException;
+import java.nio.channels.CompletionHandler;
+import java.nio.channels.InterruptedByTimeoutException;
+import java.nio.channels.ReadPendingException;
+import java.nio.channels.WritePendingException;
+import java.util.ArrayDeque;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.ScheduledFuture;
+import java.util.concurrent.ScheduledThreadPoolExecutor;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
+
+import com.serialpundit.core.SerialComException;
+import com.serialpundit.serial.internal.SerialComReactor;
+
+/**
+ * <p>Represents a serial port as an asynchronous channel. Read and write operations return immediately 
+ * and their result is given either through a CompletionHandler or a Future.</p>
+ * 
+ * <p>Reads are driven by the data listener mechanism of SerialComManager. The channel registers a data 
+ * listener for the handle, data read by native layer completes the outstanding read from the listener's 
+ * delivery thread. No thread waits for an outstanding read, so any number of channels can have reads 
+ * outstanding at the same time. Data arriving while no read is outstanding is kept in a receive buffer 
+ * of bounded size, bytes which do not fit are discarded and counted (see getBytesDropped()).</p>
+ * 
+ * <p>Native write call returns when data has been sent, so writes are run in a small pool of threads 
+ * shared by all asynchronous channels.</p>
+ * 
+ * <p>At most one read and one write can be outstanding at any time. A read can have a timeout after which 
+ * it fails with InterruptedByTimeoutException, and a read started with a Future can be cancelled using 
+ * that Future. Closing the channel fails outstanding read with AsynchronousCloseException.</p>
+ * 
+ * <p>As the channel uses data listener of the handle, no other data listener can be registered for the 
+ * handle while the channel is open. Channel must be closed before closing the serial port.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class AsynchronousSerialChannel implements AsynchronousByteChannel {
+
+    /** <p>Default size of receive buffer, in bytes.</p> */
+    public static final int DEFAULT_RECEIVE_BUFFER_SIZE = 65536;
+
+    // Shared by all channels; runs writes and completions of reads satisfied from receive buffer.
+    private static final SerialComReactor ioReactor = new SerialComReactor(
+            Runtime.getRuntime().availableProcessors(), "SerialPundit Async IO");
+
+    // Shared by all channels; fires read timeouts.
+    private static final ScheduledThreadPoolExecutor timer = createTimer();
+
+    private final SerialComManager scm;
+    private final long handle;
+    private final int receiveBufferSize;
+    private final DataReceiver receiver = new DataReceiver();
+
+    // Following are guarded by lock.
+    private final Object lock = new Object();
+    private final ArrayDeque<byte[]> received = new ArrayDeque<byte[]>();
+    private int receivedOffset;
+    private int receivedCount;
+    private long bytesDropped;
+    private PendingIO pendingRead;
+    private boolean writePending;
+    private boolean isOpened;
+
+    /*
+     * An outstanding read or write. Result is given to handler if there is one, otherwise this acts as 
+     * the Future returned to application.
+     */
+    private final class PendingIO implements Future<Integer> {
+
+        final ByteBuffer buffer;
+        final Object attachment;
+        final CompletionHandler<Integer, Object> handler;
+        final boolean isRead;
+        ScheduledFuture<?> timeoutTask;
+        private final CountDownLatch done = new CountDownLatch(1);
+        private volatile Integer result;
+        private volatile Throwable failure;
+        private volatile boolean cancelled;
+
+        PendingIO(ByteBuffer buffer, Object attachment, CompletionHandler<Integer, Object> handler, boolean isRead) {
+            this.buffer = buffer;
+            this.attachment = attachment;
+            this.handler = handler;
+            this.isRead = isRead;
+        }
+
+        void complete(int numBytes) {
+            if(handler != null) {
+                handler.completed(numBytes, attachment);
+                return;
+            }
+            result = numBytes;
+            done.countDown();
+        }
+
+        void fail(Throwable exc) {
+            if(handler != null) {
+                handler.failed(exc, attachment);
+                return;
+            }
+            failure = exc;
+            done.countDown();
+        }
+
+        @Override
+        public boolean cancel(boolean mayInterruptIfRunning) {
+            // only an outstanding read can be cancelled, a write is already being sent by native layer.
+            if(isRead == false) {
+                return false;
+            }
+            synchronized(lock) {
+                if(pendingRead != this) {
+                    return false;
+                }
+                pendingRead = null;
+                cancelTimeout(this);
+            }
+            cancelled = true;
+            done.countDown();
+            return true;
+        }
+
+        @Override
+        public boolean isCancelled() {
+            return cancelled;
+        }
+
+        @Override
+        public boolean isDone() {
+            return done.getCount() == 0;
+        }
+
+        @Override
+        public Integer get() throws InterruptedException, ExecutionException {
+            done.await();
+            return getResult();
+        }
+
+        @Override
+        public Integer get(long timeout, TimeUnit unit) throws InterruptedException, ExecutionException, TimeoutException {
+            if(done.await(timeout, unit) == false) {
+                throw new TimeoutException();
+            }
+            return getResult();
+        }
+
+        private Integer getResult() throws ExecutionException {
+            if(cancelled == true) {
+                throw new CancellationException();
+            }
+            if(failure != null) {
+                throw new ExecutionException(failure);
+            }
+            return result;
+        }
+    }
+
+    /*
+     * Receives data from native layer through data listener mechanism.
+     */
+    private final class DataReceiver implements ISerialComDataListener {
+
+        @Override
+        public void onNewSerialDataAvailable(byte[] data) {
+            PendingIO read;
+            int numBytes = 0;
+            synchronized(lock) {
+                read = pendingRead;
+                int off = 0;
+                if(read != null) {
+                    pendingRead = null;
+                    cancelTimeout(read);
+                    numBytes = Math.min(read.buffer.remaining(), data.length);
+                    read.buffer.put(data, 0, numBytes);
+                    off = numBytes;
+                }
+                saveReceived(data, off);
+            }
+            if(read != null) {
+                read.complete(numBytes);
+            }
+        }
+
+        @Override
+        public void onDataListenerError(int errorNum) {
+            PendingIO read;
+            synchronized(lock) {
+                read = pendingRead;
+                pendingRead = null;
+                if(read != null) {
+                    cancelTimeout(read);
+                }
+            }
+            if(read != null) {
+                read.fail(new IOException("Error " + errorNum + " occurred while reading data from serial port !"));
+            }
+        }
+    }
+
+    private static ScheduledThreadPoolExecutor createTimer() {
+        ScheduledThreadPoolExecutor executor = new ScheduledThreadPoolExecutor(1, new ThreadFactory() {
+            @Override
+            public Thread newThread(Runnable r) {
+                Thread t = new Thread(r, "SerialPundit Async IO timer");
+                t.setDaemon(true);
+                return t;
+            }
+        });
+        executor.setRemoveOnCancelPolicy(true);
+        return executor;
+    }
+
+    /**
+     * <p>Allocates a new AsynchronousSerialChannel object and registers its data listener for the 
+     * given handle.</p>
+     * 
+     * @param scm instance of SerialComManager class with which this channel will associate itself.
+     * @param handle handle of the serial port on which to read/write data bytes.
+     * @param receiveBufferSize maximum number of bytes kept when no read is outstanding.
+     * @throws SerialComException if data listener can not be registered for the handle.
+     * @throws IllegalArgumentException if receiveBufferSize is negative or zero.
+     */
+    public AsynchronousSerialChannel(SerialComManager scm, long handle, int receiveBufferSize) throws SerialComException {
+        if(receiveBufferSize <= 0) {
+            throw new IllegalArgumentException("Argument receiveBufferSize can not be negative or zero !");
+        }
+        this.scm = scm;
+        this.handle = handle;
+        this.receiveBufferSize = receiveBufferSize;
+        isOpened = true;
+        scm.registerDataListener(handle, receiver);
+    }
+
+    /*
+     * Keeps data[off] onwards for next read, as much as receive buffer allows. Caller must hold lock.
+     */
+    private void saveReceived(byte[] data, int off) {
+        int len = data.length - off;
+        if(len == 0) {
+            return;
+        }
+        int space = receiveBufferSize - receivedCount;
+        if(len > space) {
+            bytesDropped += (len - space);
+            len = space;
+        }
+        if(len <= 0) {
+            return;
+        }
+        if((off == 0) && (len == data.length)) {
+            received.addLast(data);
+        }else {
+            byte[] part = new byte[len];
+            System.arraycopy(data, off, part, 0, len);
+            received.addLast(part);
+        }
+        receivedCount += len;
+    }
+
+    /*
+     * Moves received data into dst, returns number of bytes moved. Caller must hold lock.
+     */
+    private int takeReceived(ByteBuffer dst) {
+        int total = 0;
+        while((dst.hasRemaining() == true) && (received.isEmpty() == false)) {
+            byte[] head = received.peekFirst();
+            int num = Math.min(dst.remaining(), head.length - receivedOffset);
+            dst.put(head, receivedOffset, num);
+            receivedOffset += num;
+            total += num;
+            if(receivedOffset == head.length) {
+                received.pollFirst();
+                receivedOffset = 0;
+            }
+        }
+        receivedCount -= total;
+        return total;
+    }
+
+    private void cancelTimeout(PendingIO io) {
+        if(io.timeoutTask != null) {
+            io.timeoutTask.cancel(false);
+            io.timeoutTask = null;
+        }
+    }
+
+    /*
+     * Runs completion in shared reactor so that handler is not called by the thread initiating operation.
+     */
+    private void completeLater(final PendingIO io, final int numBytes) {
+        ioReactor.execute(new Runnable() {
+            @Override
+            public void run() {
+                io.complete(numBytes);
+            }
+        });
+    }
+
+    private void failLater(final PendingIO io, final Throwable exc) {
+        ioReactor.execute(new Runnable() {
+            @Override
+            public void run() {
+                io.fail(exc);
+            }
+        });
+    }
+
+    private PendingIO startRead(ByteBuffer dst, long timeout, TimeUnit unit, Object attachment, 
+            CompletionHandler<Integer, Object> handler) {
+        if(dst == null) {
+            throw new NullPointerException("Argument dst can not be null !");
+        }
+        if(dst.isReadOnly()) {
+            throw new IllegalArgumentException("Argument dst can not be a read only buffer !");
+        }
+        if((timeout > 0) && (unit == null)) {
+            throw new NullPointerException("Argument unit can not be null !");
+        }
+
+        final PendingIO read = new PendingIO(dst, attachment, handler, true);
+        synchronized(lock) {
+            if(isOpened != true) {
+                failLater(read, new ClosedChannelException());
+                return read;
+            }
+            if(pendingRead != null) {
+                throw new ReadPendingException();
+            }
+            if((receivedCount > 0) || (dst.hasRemaining() == false)) {
+                completeLater(read, takeReceived(dst));
+                return read;
+            }
+            pendingRead = read;
+            if(timeout > 0) {
+                read.timeoutTask = timer.schedule(new Runnable() {
+                    @Override
+                    public void run() {
+                        synchronized(lock) {
+                            if(pendingRead != read) {
+                                return;
+                            }
+                            pendingRead = null;
+                            read.timeoutTask = null;
+                        }
+                        failLater(read, new InterruptedByTimeoutException());
+                    }
+                }, timeout, unit);
+            }
+        }
+        return read;
+    }
+
+    /**
+     * <p>Reads a sequence of bytes from serial port into the given buffer. Handler is called when at 
+     * least 1 byte has been read or when timeout elapses.</p>
+     * 
+     * @param dst buffer into which bytes are to be transferred.
+     * @param timeout maximum time to wait for data, 0 or negative to wait forever.
+     * @param unit unit of timeout.
+     * @param attachment object to attach to the operation, can be null.
+     * @param handler handler for consuming the result.
+     * @throws ReadPendingException if a read is already outstanding.
+     * @throws IllegalArgumentException if dst is read only.
+     */
+    @SuppressWarnings("unchecked")
+    public <A> void read(ByteBuffer dst, long timeout, TimeUnit unit, A attachment, 
+            CompletionHandler<Integer, ? super A> handler) {
+        if(handler == null) {
+            throw new NullPointerException("Argument handler can not be null !");
+        }
+        startRead(dst, timeout, unit, attachment, (CompletionHandler<Integer, Object>) (CompletionHandler<Integer, ?>) handler);
+    }
+
+    /**
+     * <p>Reads a sequence of bytes from serial port into the given buffer without timeout.</p>
+     * 
+     * @param dst buffer into which bytes are to be transferred.
+     * @param attachment object to attach to the operation, can be null.
+     * @param handler handler for consuming the result.
+     * @throws ReadPendingException if a read is already outstanding.
+     * @throws IllegalArgumentException if dst is read only.
+     */
+    @Override
+    public <A> void read(ByteBuffer dst, A attachment, CompletionHandler<Integer, ? super A> handler) {
+        read(dst, 0, null, attachment, handler);
+    }
+
+    /**
+     * <p>Reads a sequence of bytes from serial port into the given buffer. Returned Future can be used to 
+     * wait for result or to cancel the read.</p>
+     * 
+     * @param dst buffer into which bytes are to be transferred.
+     * @return Future representing result of the operation.
+     * @throws ReadPendingException if a read is already outstanding.
+     * @throws IllegalArgumentException if dst is read only.
+     */
+    @Override
+    public Future<Integer> read(ByteBuffer dst) {
+        return startRead(dst, 0, null, null, null);
+    }
+
+    /**
+     * <p>Same as read(dst) but the read fails with InterruptedByTimeoutException if no data arrives within 
+     * given time.</p>
+     * 
+     * @param dst buffer into which bytes are to be transferred.
+     * @param timeout maximum time to wait for data, 0 or negative to wait forever.
+     * @param unit unit of timeout.
+     * @return Future representing result of the operation.
+     * @throws ReadPendingException if a read is already outstanding.
+     * @throws IllegalArgumentException if dst is read only.
+     */
+    public Future<Integer> read(ByteBuffer dst, long timeout, TimeUnit unit) {
+        return startRead(dst, timeout, unit, null, null);
+    }
+
+    private PendingIO startWrite(final ByteBuffer src, Object attachment, CompletionHandler<Integer, Object> handler) {
+        if(src == null) {
+            throw new NullPointerException("Argument src can not be null !");
+        }
+
+        final PendingIO write = new PendingIO(src, attachment, handler, false);
+        synchronized(lock) {
+            if(isOpened != true) {
+                failLater(write, new ClosedChannelException());
+                return write;
+            }
+            if(writePending == true) {
+                throw new WritePendingException();
+            }
+            writePending = true;
+        }
+
+        ioReactor.execute(new Runnable() {
+            @Override
+            public void run() {
+                int total = 0;
+                Throwable exc = null;
+                try {
+                    total = writeToPort(src);
+                }catch (Throwable e) {
+                    exc = e;
+                }
+                synchronized(lock) {
+                    writePending = false;
+                }
+                if(exc != null) {
+                    write.fail(exc);
+                }else {
+                    write.complete(total);
+                }
+            }
+        });
+        return write;
+    }
+
+    /*
+     * Sends remaining bytes of src, returns number of bytes sent.
+     */
+    private int writeToPort(ByteBuffer src) throws IOException {
+        int total = 0;
+        byte[] data;
+        int off;
+        int len = src.remaining();
+        if(src.hasArray()) {
+            data = src.array();
+            off = src.arrayOffset() + src.position();
+        }else {
+            data = new byte[len];
+            src.duplicate().get(data);
+            off = 0;
+        }
+        while(total < len) {
+            int ret = scm.writeBytes(handle, data, off + total, len - total, -1);
+            if(ret <= 0) {
+                break;
+            }
+            total += ret;
+        }
+        src.position(src.position() + total);
+        return total;
+    }
+
+    /**
+     * <p>Writes a sequence of bytes to serial port from the given buffer. Handler is called after bytes 
+     * have been sent, number of bytes written may be less than remaining bytes if flow control stopped 
+     * transmission.</p>
+     * 
+     * @param src buffer from which bytes are to be retrieved.
+     * @param attachment object to attach to the operation, can be null.
+     * @param handler handler for consuming the result.
+     * @throws WritePendingException if a write is already outstanding.
+     */
+    @SuppressWarnings("unchecked")
+    @Override
+    public <A> void write(ByteBuffer src, A attachment, CompletionHandler<Integer, ? super A> handler) {
+        if(handler == null) {
+            throw new NullPointerException("Argument handler can not be null !");
+        }
+        startWrite(src, attachment, (CompletionHandler<Integer, Object>) (CompletionHandler<Integer, ?>) handler);
+    }
+
+    /**
+     * <p>Writes a sequence of bytes to serial port from the given buffer.</p>
+     * 
+     * @param src buffer from which bytes are to be retrieved.
+     * @return Future representing result of the operation.
+     * @throws WritePendingException if a write is already outstanding.
+     */
+    @Override
+    public Future<Integer> write(ByteBuffer src) {
+        return startWrite(src, null, null);
+    }
+
+    /**
+     * <p>Gives number of received bytes discarded because no read was outstanding and receive buffer 
+     * was full.</p>
+     * 
+     * @return number of bytes discarded.
+     */
+    public long getBytesDropped() {
+        synchronized(lock) {
+            return bytesDropped;
+        }
+    }
+
+    /**
+     * <p>Gives handle of the serial port wrapped by this channel.</p>
+     * 
+     * @return handle of serial port.
+     */
+    public long getHandle() {
+        return handle;
+    }
+
+    @Override
+    public boolean isOpen() {
+        synchronized(lock) {
+            return isOpened;
+        }
+    }
+
+    /**
+     * <p>Closes this channel, unregistering its data listener. Outstanding read fails with 
+     * AsynchronousCloseException, outstanding write completes after bytes have been sent. To actually 
+     * close the port closeComPort() method should be used.</p>
+     * 
+     * @throws IOException if data listener can not be unregistered.
+     */
+    @Override
+    public void close() throws IOException {
+        PendingIO read;
+        synchronized(lock) {
+            if(isOpened != true) {
+                return;
+            }
+            isOpened = false;
+            read = pendingRead;
+            pendingRead = null;
+            if(read != null) {
+                cancelTimeout(read);
+            }
+            received.clear();
+            receivedOffset = 0;
+            receivedCount = 0;
+        }
+        try {
+            scm.unregisterDataListener(handle, receiver);
+        }finally {
+            if(read != null) {
+                failLater(read, new AsynchronousCloseException());
+            }
+        }
+    }
+}
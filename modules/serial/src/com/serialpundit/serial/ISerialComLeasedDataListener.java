@@ -0,0 +1,42 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial;
+
+/**
+ * <p>The interface ISerialComLeasedDataListener should be implemented by class who wish to receive 
+ * data from serial port in buffers taken from a per-port pool instead of a newly allocated array for 
+ * every read. Data read by native layer is copied in a pooled buffer, so memory held by application is 
+ * re-used once buffers are released. Chunks bigger than DEFAULT_READBYTECOUNT bytes are given in buffers 
+ * which are not pooled.</p>
+ * 
+ * <p>It is registered using the same registerDataListener() method as ISerialComDataListener. For such 
+ * listeners onNewSerialDataLeased() is called and onNewSerialDataAvailable() is never called.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public interface ISerialComLeasedDataListener extends ISerialComDataListener {
+
+    /**
+     * <p> This method is called whenever data is received on serial port.</p>
+     * 
+     * <p>The data bytes are at index 0 to buffer.length() - 1 in the array given by buffer.array(). The 
+     * application must call buffer.release() exactly once when it no longer needs the data, after which 
+     * the buffer may be re-filled with new data (see SerialComLeasedBuffer.release(long) if release may 
+     * be reached more than once). A buffer not released is simply garbage collected, but it is then 
+     * lost for the pool.</p>
+     * 
+     * @param buffer leased buffer containing bytes read from serial port.
+     */
+    public abstract void onNewSerialDataLeased(SerialComLeasedBuffer buffer);
+}
@@ -0,0 +1,74 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial;
+
+/**
+ * <p>Delivery statistics of data and event listeners of a port. Implemented by SerialComListenerStats 
+ * (snapshot given by SerialComManager.getListenerStats()) and by the MXBean registered through 
+ * SerialComManager.setListenerStatsMBeanEnabled() so that the same values can be watched with JMX tools.</p>
+ * 
+ * <p>Histograms have SerialComListenerStats.NUM_HISTOGRAM_BUCKETS buckets. Bucket 0 counts durations less 
+ * than 1 microsecond, bucket n counts durations from 2^(n-1) to less than 2^n microseconds and last bucket 
+ * counts all longer durations.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public interface ISerialComListenerStatsMXBean {
+
+    /** @return name of port. */
+    public abstract String getPortName();
+
+    /** @return number of data chunks given to data listener (a batch counts as one). */
+    public abstract long getDataChunksDelivered();
+
+    /** @return number of data bytes given to data listener. */
+    public abstract long getDataBytesDelivered();
+
+    /** @return number of data chunks in queue at this moment. */
+    public abstract long getDataQueueDepth();
+
+    /** @return maximum number of data chunks that were in queue at any time. */
+    public abstract long getDataQueuePeak();
+
+    /** @return number of data chunks discarded due to overflow of queue. */
+    public abstract long getDataChunksDropped();
+
+    /** @return number of data bytes discarded due to overflow of queue. */
+    public abstract long getDataBytesDropped();
+
+    /** @return number of line events given to event listener. */
+    public abstract long getEventsDelivered();
+
+    /** @return number of line events in queue at this moment. */
+    public abstract long getEventQueueDepth();
+
+    /** @return maximum number of line events that were in queue at any time. */
+    public abstract long getEventQueuePeak();
+
+    /** @return number of line events discarded due to overflow of queue. */
+    public abstract long getEventsDropped();
+
+    /** @return histogram of time taken by data listener to return from callback. */
+    public abstract long[] getDataCallbackHistogram();
+
+    /** @return histogram of time taken by event listener to return from callback. */
+    public abstract long[] getEventCallbackHistogram();
+
+    /** @return histogram of time from reading data to calling data listener. Recorded only for listeners 
+     *          whose data carries arrival time (leased and timestamped data listeners). */
+    public abstract long[] getDataLatencyHistogram();
+
+    /** @return histogram of time from detecting line event to calling event listener. */
+    public abstract long[] getEventLatencyHistogram();
+}
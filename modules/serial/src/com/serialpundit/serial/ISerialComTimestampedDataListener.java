@@ -0,0 +1,42 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial;
+
+/**
+ * <p>The interface ISerialComTimestampedDataListener should be implemented by class who wish to receive 
+ * data from serial port together with the time at which it was received.</p>
+ * 
+ * <p>It is registered using the same registerDataListener() method as ISerialComDataListener. For such 
+ * listeners onNewSerialDataTimestamped() is called and onNewSerialDataAvailable() is never called.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public interface ISerialComTimestampedDataListener extends ISerialComDataListener {
+
+    /**
+     * <p> This method is called whenever data is received on serial port.</p>
+     * 
+     * <p>The timestamp is taken on the reader thread as soon as the data has been read, before it is queued 
+     * for delivery. It is therefore not affected by the time data spent in queue, but it is read completion 
+     * time and only an upper bound of arrival time of the last byte in data. Time of earlier bytes can be 
+     * estimated using SerialComManager.estimateByteArrivalTime() method.</p>
+     * 
+     * <p>If chunks have been merged (batching or COALESCE overflow policy), timestamp is that of the 
+     * latest chunk.</p>
+     * 
+     * @param data bytes read from serial port.
+     * @param timestamp read completion time in nanoseconds, on the same time scale as System.nanoTime().
+     */
+    public abstract void onNewSerialDataTimestamped(byte[] data, long timestamp);
+}
@@ -0,0 +1,407 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.ByteChannel;
+import java.nio.channels.ClosedChannelException;
+import java.nio.channels.GatheringByteChannel;
+import java.nio.channels.ScatteringByteChannel;
+import java.nio.channels.spi.AbstractInterruptibleChannel;
+
+import com.serialpundit.core.SerialComException;
+import com.serialpundit.serial.SerialComManager.SMODE;
+import com.serialpundit.serial.internal.SerialComPortHandleInfo;
+
+/**
+ * <p>Represents a serial port as a NIO channel so that it can be used with frameworks and code written 
+ * for ByteChannel, ScatteringByteChannel and GatheringByteChannel.</p>
+ * 
+ * <p>In blocking mode read waits until at least 1 byte is available and write waits until all bytes 
+ * are sent. In non-blocking mode read returns 0 if there is no data. A blocked read/write returns 
+ * with AsynchronousCloseException when channel is closed by other thread and with 
+ * ClosedByInterruptException when the blocked thread is interrupted. Read never returns -1 as serial 
+ * port has no end of stream.</p>
+ * 
+ * <p>Readers and writers are serialized separately, so one thread may read while other writes.</p>
+ * 
+ * <p>The channel can not be registered with java.nio.channels.Selector, as JDK selectors accept only 
+ * channels created by their own provider. To multiplex many ports in one thread, use non-blocking 
+ * channels with isReadable() method or readiness wait API of SerialComManager.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComChannel extends AbstractInterruptibleChannel implements ByteChannel, 
+ScatteringByteChannel, GatheringByteChannel {
+
+    /** <p>Maximum number of bytes transferred to/from serial port by native layer in one call.</p> */
+    public static final int MAX_TRANSFER_SIZE = 2048;
+
+    private final SerialComManager scm;
+    private final SerialComPortHandleInfo portHandleInfo;
+    private final long handle;
+    private final boolean isBlocking;
+    private final long readContext;
+    private final long writeContext;
+    private final Object readLock = new Object();
+    private final Object writeLock = new Object();
+
+    // Used when data has to be moved to/from a buffer which has no accessible array.
+    private final byte[] readArray = new byte[MAX_TRANSFER_SIZE];
+    private final byte[] writeArray = new byte[MAX_TRANSFER_SIZE];
+
+    /**
+     * <p>Allocates a new SerialComChannel object.</p>
+     * 
+     * @param scm instance of SerialComManager class with which this channel will associate itself.
+     * @param portHandleInfo information object of the port.
+     * @param handle handle of the serial port on which to read/write data bytes.
+     * @param channelMode indicates blocking or non-blocking behavior of channel.
+     * @throws SerialComException if the channel can not be prepared for the specified behavior.
+     */
+    public SerialComChannel(SerialComManager scm, SerialComPortHandleInfo portHandleInfo, long handle, 
+            SMODE channelMode) throws SerialComException {
+
+        this.scm = scm;
+        this.portHandleInfo = portHandleInfo;
+        this.handle = handle;
+
+        /* Separate contexts are used for read and write, so that close can bring out both a blocked 
+         * read and a blocked write. */
+        if(channelMode.getValue() == 1) {
+            readContext = scm.createBlockingIOContext();
+            try {
+                writeContext = scm.createBlockingIOContext();
+            }catch (SerialComException e) {
+                scm.destroyBlockingIOContext(readContext);
+                throw e;
+            }
+            isBlocking = true;
+        }else {
+            readContext = -1;
+            writeContext = -1;
+            isBlocking = false;
+        }
+    }
+
+    /**
+     * <p>Tells whether read/write operations on this channel block.</p>
+     * 
+     * @return true if channel is in blocking mode.
+     */
+    public boolean isBlocking() {
+        return isBlocking;
+    }
+
+    /**
+     * <p>Gives handle of the serial port wrapped by this channel.</p>
+     * 
+     * @return handle of serial port.
+     */
+    public long getHandle() {
+        return handle;
+    }
+
+    /**
+     * <p>Tells whether data is available in serial port's input buffer, i.e. whether next read on a 
+     * non-blocking channel will return at least 1 byte.</p>
+     * 
+     * @return true if at least 1 byte can be read.
+     * @throws IOException if an I/O error occurs or channel has been closed.
+     */
+    public boolean isReadable() throws IOException {
+        if(isOpen() == false) {
+            throw new ClosedChannelException();
+        }
+        int[] numBytesAvailable = scm.getByteCountInPortIOBuffer(handle);
+        return numBytesAvailable[0] > 0;
+    }
+
+    /*
+     * Reads from port into dst, returns number of bytes read. Zero is returned if there is no data 
+     * (non-blocking) or if blocked read was asked to return. Caller must hold readLock.
+     */
+    private int readOnce(ByteBuffer dst) throws IOException {
+        int len = dst.remaining();
+        if(len > MAX_TRANSFER_SIZE) {
+            len = MAX_TRANSFER_SIZE;
+        }
+        if(len == 0) {
+            return 0;
+        }
+
+        int ret;
+        try {
+            if(dst.hasArray()) {
+                // read directly into backing array, no copy.
+                ret = scm.readBytes(handle, dst.array(), dst.arrayOffset() + dst.position(), len, readContext, null);
+                if(ret > 0) {
+                    dst.position(dst.position() + ret);
+                }
+            }else {
+                ret = scm.readBytes(handle, readArray, 0, len, readContext, null);
+                if(ret > 0) {
+                    dst.put(readArray, 0, ret);
+                }
+            }
+        }catch (SerialComException e) {
+            if(SerialComManager.EXP_UNBLOCKIO.equals(e.getExceptionMsg())) {
+                // channel is being closed, end() will tell caller.
+                return 0;
+            }
+            throw e;
+        }
+        return (ret > 0) ? ret : 0;
+    }
+
+    /*
+     * Writes from src to port, returns number of bytes written which may be less than remaining bytes 
+     * if flow control stopped transmission. Caller must hold writeLock.
+     */
+    private int writeOnce(ByteBuffer src) throws IOException {
+        int len = src.remaining();
+        if(len == 0) {
+            return 0;
+        }
+
+        int ret;
+        try {
+            if(src.hasArray()) {
+                ret = scm.writeBytes(handle, src.array(), src.arrayOffset() + src.position(), len, writeContext);
+            }else if(src.isDirect() && (isBlocking == false)) {
+                // native layer sends from direct buffer memory itself, no copy.
+                ret = scm.writeBytesDirect(handle, src, src.position(), len);
+            }else {
+                if(len > MAX_TRANSFER_SIZE) {
+                    len = MAX_TRANSFER_SIZE;
+                }
+                src.duplicate().get(writeArray, 0, len);
+                ret = scm.writeBytes(handle, writeArray, 0, len, writeContext);
+            }
+        }catch (SerialComException e) {
+            if(SerialComManager.EXP_UNBLOCKIO.equals(e.getExceptionMsg())) {
+                return 0;
+            }
+            throw e;
+        }
+        if(ret > 0) {
+            src.position(src.position() + ret);
+            return ret;
+        }
+        return 0;
+    }
+
+    /**
+     * <p>Reads a sequence of bytes from serial port into the given buffer. At most 
+     * MAX_TRANSFER_SIZE bytes are read in one call.</p>
+     * 
+     * @param dst buffer into which bytes are to be transferred.
+     * @return number of bytes read, possibly zero in non-blocking mode.
+     * @throws IOException if an I/O error occurs or channel has been closed.
+     */
+    @Override
+    public int read(ByteBuffer dst) throws IOException {
+        if(dst == null) {
+            throw new NullPointerException("Argument dst can not be null !");
+        }
+        synchronized(readLock) {
+            if(isOpen() == false) {
+                throw new ClosedChannelException();
+            }
+            int ret = 0;
+            try {
+                begin();
+                ret = readOnce(dst);
+            }finally {
+                end(ret > 0);
+            }
+            return ret;
+        }
+    }
+
+    /**
+     * <p>Reads a sequence of bytes from serial port into a subsequence of the given buffers. Buffers 
+     * are filled in order, reading stops at the first read which does not fill its buffer completely.</p>
+     * 
+     * @param dsts buffers into which bytes are to be transferred.
+     * @param offset index of first buffer into which bytes are to be transferred.
+     * @param length maximum number of buffers to be accessed.
+     * @return number of bytes read, possibly zero in non-blocking mode.
+     * @throws IOException if an I/O error occurs or channel has been closed.
+     * @throws IndexOutOfBoundsException if offset or length is not valid for given array.
+     */
+    @Override
+    public long read(ByteBuffer[] dsts, int offset, int length) throws IOException {
+        if((offset < 0) || (length < 0) || (offset > (dsts.length - length))) {
+            throw new IndexOutOfBoundsException("Index violation detected in given buffer array !");
+        }
+        synchronized(readLock) {
+            if(isOpen() == false) {
+                throw new ClosedChannelException();
+            }
+            long total = 0;
+            try {
+                begin();
+                for(int x = offset; x < (offset + length); x++) {
+                    ByteBuffer dst = dsts[x];
+                    while(dst.hasRemaining()) {
+                        if((total > 0) && (isBlocking == true) && (scm.getByteCountInPortIOBuffer(handle)[0] == 0)) {
+                            // do not block for more once some data has been read.
+                            return total;
+                        }
+                        int ret = readOnce(dst);
+                        if(ret == 0) {
+                            return total;
+                        }
+                        total += ret;
+                        if(dst.hasRemaining()) {
+                            // read returned less than asked, no more data at this time.
+                            return total;
+                        }
+                    }
+                }
+            }finally {
+                end(total > 0);
+            }
+            return total;
+        }
+    }
+
+    /**
+     * <p>Same as read(dsts, 0, dsts.length).</p>
+     * 
+     * @param dsts buffers into which bytes are to be transferred.
+     * @return number of bytes read, possibly zero in non-blocking mode.
+     * @throws IOException if an I/O error occurs or channel has been closed.
+     */
+    @Override
+    public long read(ByteBuffer[] dsts) throws IOException {
+        return read(dsts, 0, dsts.length);
+    }
+
+    /**
+     * <p>Writes a sequence of bytes to serial port from the given buffer. In blocking mode all the 
+     * remaining bytes are written, in non-blocking mode fewer bytes may be written if flow control has 
+     * stopped transmission.</p>
+     * 
+     * @param src buffer from which bytes are to be retrieved.
+     * @return number of bytes written.
+     * @throws IOException if an I/O error occurs or channel has been closed.
+     */
+    @Override
+    public int write(ByteBuffer src) throws IOException {
+        if(src == null) {
+            throw new NullPointerException("Argument src can not be null !");
+        }
+        synchronized(writeLock) {
+            if(isOpen() == false) {
+                throw new ClosedChannelException();
+            }
+            int total = 0;
+            try {
+                begin();
+                total = writeFully(src);
+            }finally {
+                end(total > 0);
+            }
+            return total;
+        }
+    }
+
+    /*
+     * Writes remaining bytes of src, stops early only in non-blocking mode. Caller must hold writeLock.
+     */
+    private int writeFully(ByteBuffer src) throws IOException {
+        int total = 0;
+        while(src.hasRemaining() && isOpen()) {
+            int ret = writeOnce(src);
+            total += ret;
+            if((ret == 0) && (isBlocking == false)) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    /**
+     * <p>Writes a sequence of bytes to serial port from a subsequence of the given buffers. In 
+     * non-blocking mode writing stops at the first buffer which could not be written completely.</p>
+     * 
+     * @param srcs buffers from which bytes are to be retrieved.
+     * @param offset index of first buffer from which bytes are to be retrieved.
+     * @param length maximum number of buffers to be accessed.
+     * @return number of bytes written.
+     * @throws IOException if an I/O error occurs or channel has been closed.
+     * @throws IndexOutOfBoundsException if offset or length is not valid for given array.
+     */
+    @Override
+    public long write(ByteBuffer[] srcs, int offset, int length) throws IOException {
+        if((offset < 0) || (length < 0) || (offset > (srcs.length - length))) {
+            throw new IndexOutOfBoundsException("Index violation detected in given buffer array !");
+        }
+        synchronized(writeLock) {
+            if(isOpen() == false) {
+                throw new ClosedChannelException();
+            }
+            long total = 0;
+            try {
+                begin();
+                for(int x = offset; x < (offset + length); x++) {
+                    total += writeFully(srcs[x]);
+                    if(srcs[x].hasRemaining()) {
+                        break;
+                    }
+                }
+            }finally {
+                end(total > 0);
+            }
+            return total;
+        }
+    }
+
+    /**
+     * <p>Same as write(srcs, 0, srcs.length).</p>
+     * 
+     * @param srcs buffers from which bytes are to be retrieved.
+     * @return number of bytes written.
+     * @throws IOException if an I/O error occurs or channel has been closed.
+     */
+    @Override
+    public long write(ByteBuffer[] srcs) throws IOException {
+        return write(srcs, 0, srcs.length);
+    }
+
+    /**
+     * <p>Releases this channel, called by close() or when a thread blocked in read/write is interrupted. 
+     * To actually close the port closeComPort() method should be used.</p>
+     * 
+     * @throws IOException if an I/O error occurs.
+     */
+    @Override
+    protected void implCloseChannel() throws IOException {
+        if(isBlocking == true) {
+            // bring out blocked read/write, once they release lock it is safe to destroy context.
+            scm.unblockBlockingIOOperation(readContext);
+            scm.unblockBlockingIOOperation(writeContext);
+            synchronized(readLock) {
+                scm.destroyBlockingIOContext(readContext);
+            }
+            synchronized(writeLock) {
+                scm.destroyBlockingIOContext(writeContext);
+            }
+        }
+        portHandleInfo.setSerialComChannel(null);
+    }
+}
@@ -30,10 +30,18 @@ import com.serialpundit.serial.internal.SerialComPortHandleInfo;
  * <p>Advance applications may fine tune the timing behavior using fineTuneReadBehaviour() API defined 
  * in SerialComManager class.</p>
  * 
+ * <p>Bytes are read from serial port in chunks of up to READ_AHEAD_SIZE bytes into an internal read-ahead 
+ * buffer using one native call per chunk, single byte reads and small reads are then served from this 
+ * buffer. Reads of READ_AHEAD_SIZE or more bytes go directly into the caller's array. This makes wrapping 
+ * this stream in byte oriented parsers like DataInputStream or Scanner efficient.</p>
+ * 
  * @author Rishi Gupta
  */
 public final class SerialComInByteStream extends InputStream implements ISerialIOStream {
 
+    /** <p>Size of internal read-ahead buffer, same as maximum number of bytes native layer reads in one call.</p> */
+    public static final int READ_AHEAD_SIZE = 2048;
+
     private final SerialComManager scm;
     private final SerialComPortHandleInfo portHandleInfo;
     private final long handle;
@@ -42,6 +50,13 @@ public final class SerialComInByteStream extends InputStream implements ISerialI
     private final long context;
     private boolean isOpened;
 
+    // Bytes read from port but not yet given to application are readAhead[readAheadPos] to readAhead[readAheadCount - 1].
+    // Indices are modified only with lock held, they are volatile so that available() can read them without 
+    // taking lock which a blocked read holds while waiting for data.
+    private final byte[] readAhead = new byte[READ_AHEAD_SIZE];
+    private volatile int readAheadPos;
+    private volatile int readAheadCount;
+
     /**
      * <p>Construct and allocates a new SerialComInByteStream object with given details.</p>
      * 
@@ -66,15 +81,54 @@ public final class SerialComInByteStream extends InputStream implements ISerialI
             context = scm.createBlockingIOContext();
             isBlocking = true;
         }else {
-            context = 0;
+            context = -1;
             isBlocking = false;
         }
         isOpened = true;
     }
 
+    /*
+     * Reads up to len bytes from port directly into b. Returns number of bytes read, 0 if there is no data 
+     * (non-blocking) or -1 if blocked read was asked to return because stream is being closed. Blocked read 
+     * returning without data for any other reason is an error. Caller must hold lock.
+     */
+    private int readFromPort(byte[] b, int off, int len) throws IOException {
+        try {
+            int ret = scm.readBytes(handle, b, off, len, context, null);
+            if((ret == 0) && (isBlocking == true)) {
+                throw new IOException("Unknown error occured while reading data in blocking mode !");
+            }
+            return ret;
+        }catch (SerialComException e) {
+            if(SerialComManager.EXP_UNBLOCKIO.equals(e.getExceptionMsg())) {
+                // this exception message occurs when application has closed stream.
+                // release lock so that blocking context can be destroyed.
+                return -1;
+            }
+            // this is error other than expected, pass it to application.
+            throw new IOException(e.getExceptionMsg());
+        }
+    }
+
+    /*
+     * Refills read-ahead buffer with one native call. Returns false if no byte could be read. Caller must 
+     * hold lock and buffer must be empty.
+     */
+    private boolean fillReadAhead() throws IOException {
+        readAheadPos = 0;
+        readAheadCount = 0;
+        int ret = readFromPort(readAhead, 0, READ_AHEAD_SIZE);
+        if(ret <= 0) {
+            return false;
+        }
+        readAheadCount = ret;
+        return true;
+    }
+
     /**
      * <p>Returns an estimate of the minimum number of bytes that can be read from this input stream
-     * without blocking by the next invocation of a method for this input stream.</p>
+     * without blocking by the next invocation of a method for this input stream. This includes bytes 
+     * already read from serial port into read-ahead buffer.</p>
      * 
      * @return an estimate of the minimum number of bytes available for reading.
      * @throws IOException if an I/O error occurs or if stream has been closed already.
@@ -85,13 +139,20 @@ public final class SerialComInByteStream extends InputStream implements ISerialI
             throw new IOException("The byte stream has been closed !");
         }
 
+        // position is read first, if a read or refill runs concurrently difference may be stale or negative.
+        int buffered = readAheadPos;
+        buffered = readAheadCount - buffered;
+        if(buffered < 0) {
+            buffered = 0;
+        }
+
         int[] numBytesAvailable = new int[2];
         try {
             numBytesAvailable = scm.getByteCountInPortIOBuffer(handle);
         } catch (SerialComException e) {
             throw new IOException(e.getExceptionMsg());
         }
-        return numBytesAvailable[0];
+        return buffered + numBytesAvailable[0];
     }
 
     /**
@@ -114,6 +175,11 @@ public final class SerialComInByteStream extends InputStream implements ISerialI
                 scm.destroyBlockingIOContext(context);
             }
         }
+        synchronized(lock) {
+            // bytes not consumed by application are discarded.
+            readAheadPos = 0;
+            readAheadCount = 0;
+        }
         isOpened = false;
         portHandleInfo.setSerialComInByteStream(null);
     }
@@ -155,39 +221,13 @@ public final class SerialComInByteStream extends InputStream implements ISerialI
             throw new IOException("The byte stream has been closed !");
         }
 
-        byte[] data;
-        try {
-            if(isBlocking == true) {
-                // blocking I/O
-                synchronized(lock) {
-                    try {
-                        data = scm.readBytesBlocking(handle, 1, context);
-                    }catch (SerialComException e) {
-                        if(SerialComManager.EXP_UNBLOCKIO.equals(e.getExceptionMsg())) {
-                            // this exception message occurs when application has closed stream.
-                            // release lock so that blocking context can be destroyed.
-                            return -1;
-                        }
-                        // this is error other than expected, pass it to application.
-                        throw new IOException(e.getExceptionMsg());
-                    }
-                    if(data != null) {
-                        return (int)data[0];
-                    }else {
-                        throw new IOException("Unknown error occured while reading data in blocking mode !");
-                    }
-                }
-            }else {
-                // non-blocking I/O
-                data = scm.readBytes(handle, 1);
-                if(data != null) {
-                    return (int)data[0];
-                }else {
+        synchronized(lock) {
+            if(readAheadPos >= readAheadCount) {
+                if(fillReadAhead() == false) {
                     return -1;
                 }
             }
-        }catch (SerialComException e) {
-            throw new IOException(e.getExceptionMsg());
+            return readAhead[readAheadPos++] & 0xFF;
         }
     }
 
@@ -260,48 +300,32 @@ public final class SerialComInByteStream extends InputStream implements ISerialI
             return 0;
         }
 
-        int i = off;
-        byte[] data;
-        try {
-            if(isBlocking == true) {
-                // blocking I/O
-                synchronized(lock) {
-                    try {
-                        data = scm.readBytesBlocking(handle, len, context);
-                    }catch (SerialComException e) {
-                        if(SerialComManager.EXP_UNBLOCKIO.equals(e.getExceptionMsg())) {
-                            // this exception message occurs when application has closed stream.
-                            // release lock so that blocking context can be destroyed.
-                            return -1;
-                        }
-                        // this is error other than expected, pass it to application.
-                        throw new IOException(e.getExceptionMsg());
-                    }
-                    if(data != null) {
-                        for(int x=0; x < data.length; x++) {
-                            b[i] = data[x];
-                            i++;
-                        }
-                        return data.length;
-                    }else {
-                        throw new IOException("Unknown error occured in native layer !");
-                    }
-                }
-            }else {
-                // non-blocking I/O
-                data = scm.readBytes(handle, len);
-                if(data != null) {
-                    for(int x=0; x < data.length; x++) {
-                        b[i] = data[x];
-                        i++;
-                    }
-                    return data.length;
-                }else {
+        synchronized(lock) {
+            int buffered = readAheadCount - readAheadPos;
+            if(buffered > 0) {
+                // give what has been already read, do not block for more.
+                int num = (len < buffered) ? len : buffered;
+                System.arraycopy(readAhead, readAheadPos, b, off, num);
+                readAheadPos += num;
+                return num;
+            }
+
+            if(len >= READ_AHEAD_SIZE) {
+                // large read, copying through read-ahead buffer will only add cost.
+                int ret = readFromPort(b, off, READ_AHEAD_SIZE);
+                if(ret <= 0) {
                     return -1;
                 }
+                return ret;
             }
-        }catch (SerialComException e) {
-            throw new IOException(e.getExceptionMsg());
+
+            if(fillReadAhead() == false) {
+                return -1;
+            }
+            int num = (len < readAheadCount) ? len : readAheadCount;
+            System.arraycopy(readAhead, 0, b, off, num);
+            readAheadPos = num;
+            return num;
         }
     }
 
@@ -0,0 +1,178 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial;
+
+import java.util.concurrent.atomic.AtomicLong;
+
+import com.serialpundit.serial.internal.SerialComBufferPool;
+
+/**
+ * <p>Represents a buffer taken (leased) from a pool, holding bytes read from serial port. It is given 
+ * to ISerialComLeasedDataListener and must be returned to the pool by calling release().</p>
+ * 
+ * <p>Valid data starts at index 0 of the array returned by array() and is length() bytes long. The 
+ * array may be longer than the data it holds.</p>
+ * 
+ * <p>A buffer object is re-used for many leases. release() must be called exactly once per lease; once 
+ * released, the same object may already have been given to some other owner. Code which may reach release 
+ * more than once should note getLeaseId() when it receives the buffer and call release(long) instead, 
+ * which does nothing if that lease has already ended.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComLeasedBuffer {
+
+    private final byte[] mBuffer;
+    private final SerialComBufferPool mPool;
+    // Odd value while leased, even while in pool. Incremented on every lease and release, so the value 
+    // during a lease identifies that lease.
+    private final AtomicLong mLeaseState = new AtomicLong(1);
+    private int mLength;
+    private long mTimestamp;
+
+    /**
+     * <p>Allocates a new SerialComLeasedBuffer object. Used by the SDK internally.</p>
+     * 
+     * @param buffer byte array backing this buffer.
+     * @param pool pool to which this buffer is returned on release, null if it is not pooled.
+     */
+    public SerialComLeasedBuffer(byte[] buffer, SerialComBufferPool pool) {
+        mBuffer = buffer;
+        mPool = pool;
+        mLength = 0;
+        mTimestamp = 0;
+    }
+
+    /**
+     * <p>Gives the array backing this buffer.</p>
+     * 
+     * @return byte array containing data at index 0 to length() - 1.
+     */
+    public byte[] array() {
+        return mBuffer;
+    }
+
+    /**
+     * <p>Gives number of valid data bytes in this buffer.</p>
+     * 
+     * @return number of data bytes.
+     */
+    public int length() {
+        return mLength;
+    }
+
+    /**
+     * <p>Sets number of valid data bytes in this buffer. Used by the producer filling this buffer.</p>
+     * 
+     * @param length number of data bytes.
+     * @throws IllegalArgumentException if length is negative or more than size of backing array.
+     */
+    public void setLength(int length) {
+        if((length < 0) || (length > mBuffer.length)) {
+            throw new IllegalArgumentException("Argument length can not be negative or greater than capacity !");
+        }
+        mLength = length;
+    }
+
+    /**
+     * <p>Gives time at which data in this buffer was received from serial port. It represents arrival of the 
+     * last byte in this buffer, on the same time scale as System.nanoTime().</p>
+     * 
+     * @return arrival time in nanoseconds.
+     */
+    public long getTimestamp() {
+        return mTimestamp;
+    }
+
+    /**
+     * <p>Sets time at which data in this buffer was received. Used by the producer filling this buffer.</p>
+     * 
+     * @param timestamp arrival time in nanoseconds as given by System.nanoTime().
+     */
+    public void setTimestamp(long timestamp) {
+        mTimestamp = timestamp;
+    }
+
+    /**
+     * <p>Tells whether this buffer goes back to a pool when released. Array of a buffer which is not pooled 
+     * is never re-used by the SDK.</p>
+     * 
+     * @return true if this buffer belongs to a pool.
+     */
+    public boolean isPooled() {
+        return mPool != null;
+    }
+
+    /**
+     * <p>Gives a copy of the data bytes in this buffer. Useful when data is to be retained after 
+     * releasing this buffer.</p>
+     * 
+     * @return newly allocated array containing data bytes.
+     */
+    public byte[] toByteArray() {
+        byte[] data = new byte[mLength];
+        System.arraycopy(mBuffer, 0, data, 0, mLength);
+        return data;
+    }
+
+    /**
+     * <p>Gives identifier of the current lease of this buffer.</p>
+     * 
+     * @return lease identifier, to be passed to release(long).
+     */
+    public long getLeaseId() {
+        return mLeaseState.get();
+    }
+
+    /**
+     * <p>Returns this buffer to the pool it was leased from. This must be called only once per lease, 
+     * a second call after the buffer has been leased again would release the new owner's lease. Buffer 
+     * must not be accessed after it has been released.</p>
+     */
+    public void release() {
+        long state = mLeaseState.get();
+        if(((state & 1) == 1) && mLeaseState.compareAndSet(state, state + 1)) {
+            if(mPool != null) {
+                mPool.recycle(this);
+            }
+        }
+    }
+
+    /**
+     * <p>Returns this buffer to the pool if the given lease is still the current one, otherwise does 
+     * nothing. Safe to call more than once.</p>
+     * 
+     * @param leaseId identifier obtained from getLeaseId() during the lease being ended.
+     * @return true if buffer was released by this call.
+     */
+    public boolean release(long leaseId) {
+        if(((leaseId & 1) == 1) && mLeaseState.compareAndSet(leaseId, leaseId + 1)) {
+            if(mPool != null) {
+                mPool.recycle(this);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * <p>Marks this buffer as leased again, starting a new lease. Used by the SDK internally when buffer 
+     * is taken out of pool.</p>
+     */
+    public void acquire() {
+        mLength = 0;
+        mTimestamp = 0;
+        mLeaseState.incrementAndGet();
+    }
+}
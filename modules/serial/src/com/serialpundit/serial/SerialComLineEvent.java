@@ -19,6 +19,12 @@ package com.serialpundit.serial;
  * Whenever an event happens, an object of this class containing details about the event is passed to
  * registered listener.</p>
  * 
+ * <p>When event coalescing is enabled, one event represents all the transitions that happened since the 
+ * last event was delivered. Previous and new states are then the states before the first and after the 
+ * last transition, getCTS() etc. report net change, and getTransitionCount() tells how many times each 
+ * line actually toggled in between (a line that went high and low again has net change 0 but transition 
+ * count 2).</p>
+ * 
  * @author Rishi Gupta
  */
 
@@ -27,6 +33,12 @@ public final class SerialComLineEvent {
     private int mOldLineEvent;
     private int mNewLineEvent;
     private int mChanged;
+    private final int mCTSTransitions;
+    private final int mDSRTransitions;
+    private final int mDCDTransitions;
+    private final int mRITransitions;
+    private final long mFirstTimestamp;
+    private final long mLastTimestamp;
 
     /**
      * <p>The looper object remembers state of lines and pass both previous and new state.</p>
@@ -35,9 +47,94 @@ public final class SerialComLineEvent {
      * @param newLineState new line state
      */
     public SerialComLineEvent(int oldLineState, int newLineState) {
+        this(oldLineState, newLineState, 
+                ((oldLineState ^ newLineState) & SerialComManager.CTS) != 0 ? 1 : 0, 
+                ((oldLineState ^ newLineState) & SerialComManager.DSR) != 0 ? 1 : 0, 
+                ((oldLineState ^ newLineState) & SerialComManager.DCD) != 0 ? 1 : 0, 
+                ((oldLineState ^ newLineState) & SerialComManager.RI) != 0 ? 1 : 0, 0, 0);
+    }
+
+    /**
+     * <p>Creates event representing one or more transitions on control lines.</p>
+     * 
+     * @param oldLineState line state before first transition.
+     * @param newLineState line state after last transition.
+     * @param ctsTransitions number of times CTS changed.
+     * @param dsrTransitions number of times DSR changed.
+     * @param dcdTransitions number of times DCD changed.
+     * @param riTransitions number of times RI changed.
+     * @param firstTimestamp time of first transition as given by System.nanoTime(), 0 if not known.
+     * @param lastTimestamp time of last transition as given by System.nanoTime(), 0 if not known.
+     */
+    public SerialComLineEvent(int oldLineState, int newLineState, int ctsTransitions, int dsrTransitions, 
+            int dcdTransitions, int riTransitions, long firstTimestamp, long lastTimestamp) {
         mOldLineEvent = oldLineState;
         mNewLineEvent = newLineState;
         mChanged = mOldLineEvent ^ mNewLineEvent;  // XOR old with new state to find the one(s) that changed
+        mCTSTransitions = ctsTransitions;
+        mDSRTransitions = dsrTransitions;
+        mDCDTransitions = dcdTransitions;
+        mRITransitions = riTransitions;
+        mFirstTimestamp = firstTimestamp;
+        mLastTimestamp = lastTimestamp;
+    }
+
+    /**
+     * <p>Gives number of times the given line changed its state within this event.</p>
+     * 
+     * @param line one of the constants SerialComManager.CTS, DSR, DCD or RI.
+     * @return number of transitions.
+     * @throws IllegalArgumentException if line is not one of CTS, DSR, DCD or RI.
+     */
+    public int getTransitionCount(int line) {
+        switch(line) {
+        case SerialComManager.CTS:
+            return mCTSTransitions;
+        case SerialComManager.DSR:
+            return mDSRTransitions;
+        case SerialComManager.DCD:
+            return mDCDTransitions;
+        case SerialComManager.RI:
+            return mRITransitions;
+        default:
+            throw new IllegalArgumentException("Argument line must be one of CTS, DSR, DCD or RI !");
+        }
+    }
+
+    /**
+     * <p>Gives time at which first transition in this event was detected.</p>
+     * 
+     * @return time in nanoseconds as given by System.nanoTime(), 0 if not known.
+     */
+    public long getFirstTimestamp() {
+        return mFirstTimestamp;
+    }
+
+    /**
+     * <p>Gives time at which last transition in this event was detected.</p>
+     * 
+     * @return time in nanoseconds as given by System.nanoTime(), 0 if not known.
+     */
+    public long getLastTimestamp() {
+        return mLastTimestamp;
+    }
+
+    /**
+     * <p>Gives the state of control lines before this event as bit mask of CTS, DSR, DCD and RI.</p>
+     * 
+     * @return previous line state.
+     */
+    public int getOldLineState() {
+        return mOldLineEvent;
+    }
+
+    /**
+     * <p>Gives the state of control lines after this event as bit mask of CTS, DSR, DCD and RI.</p>
+     * 
+     * @return new line state.
+     */
+    public int getNewLineState() {
+        return mNewLineEvent;
     }
 
     /**
@@ -0,0 +1,146 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial;
+
+/**
+ * <p>Snapshot of delivery statistics of data and event listeners of a port. It helps in finding whether a 
+ * slow listener, garbage collection or the port itself is limiting throughput. For example growing queue 
+ * depth with long callback durations points to listener, while low latency with few bytes points to port.</p>
+ * 
+ * <p>Counters are reset when the listener is registered.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComListenerStats implements ISerialComListenerStatsMXBean {
+
+    /** <p>Number of buckets in histograms. </p>*/
+    public static final int NUM_HISTOGRAM_BUCKETS = 24;
+
+    private final String mPortName;
+    private final long[] mCounters;
+    private final long[] mDataCallbackHistogram;
+    private final long[] mEventCallbackHistogram;
+    private final long[] mDataLatencyHistogram;
+    private final long[] mEventLatencyHistogram;
+
+    /**
+     * <p>Allocates a new SerialComListenerStats object. Used by the SDK internally.</p>
+     * 
+     * @param portName name of port.
+     * @param counters array containing data chunks delivered, data bytes delivered, data queue depth, data 
+     *         queue peak, data chunks dropped, data bytes dropped, events delivered, event queue depth, event 
+     *         queue peak and events dropped in this sequence.
+     * @param dataCallbackHistogram histogram of data callback durations.
+     * @param eventCallbackHistogram histogram of event callback durations.
+     * @param dataLatencyHistogram histogram of data delivery latency.
+     * @param eventLatencyHistogram histogram of event delivery latency.
+     */
+    public SerialComListenerStats(String portName, long[] counters, long[] dataCallbackHistogram, long[] eventCallbackHistogram, 
+            long[] dataLatencyHistogram, long[] eventLatencyHistogram) {
+        mPortName = portName;
+        mCounters = counters;
+        mDataCallbackHistogram = dataCallbackHistogram;
+        mEventCallbackHistogram = eventCallbackHistogram;
+        mDataLatencyHistogram = dataLatencyHistogram;
+        mEventLatencyHistogram = eventLatencyHistogram;
+    }
+
+    /**
+     * <p>Gives lower limit of the given histogram bucket.</p>
+     * 
+     * @param bucket index of bucket.
+     * @return smallest duration in microseconds counted in this bucket.
+     */
+    public static long getHistogramBucketStart(int bucket) {
+        if(bucket <= 0) {
+            return 0;
+        }
+        return 1L << (bucket - 1);
+    }
+
+    @Override
+    public String getPortName() {
+        return mPortName;
+    }
+
+    @Override
+    public long getDataChunksDelivered() {
+        return mCounters[0];
+    }
+
+    @Override
+    public long getDataBytesDelivered() {
+        return mCounters[1];
+    }
+
+    @Override
+    public long getDataQueueDepth() {
+        return mCounters[2];
+    }
+
+    @Override
+    public long getDataQueuePeak() {
+        return mCounters[3];
+    }
+
+    @Override
+    public long getDataChunksDropped() {
+        return mCounters[4];
+    }
+
+    @Override
+    public long getDataBytesDropped() {
+        return mCounters[5];
+    }
+
+    @Override
+    public long getEventsDelivered() {
+        return mCounters[6];
+    }
+
+    @Override
+    public long getEventQueueDepth() {
+        return mCounters[7];
+    }
+
+    @Override
+    public long getEventQueuePeak() {
+        return mCounters[8];
+    }
+
+    @Override
+    public long getEventsDropped() {
+        return mCounters[9];
+    }
+
+    @Override
+    public long[] getDataCallbackHistogram() {
+        return mDataCallbackHistogram.clone();
+    }
+
+    @Override
+    public long[] getEventCallbackHistogram() {
+        return mEventCallbackHistogram.clone();
+    }
+
+    @Override
+    public long[] getDataLatencyHistogram() {
+        return mDataLatencyHistogram.clone();
+    }
+
+    @Override
+    public long[] getEventLatencyHistogram() {
+        return mEventLatencyHistogram.clone();
+    }
+}
@@ -17,10 +17,16 @@ import java.io.File;
 import java.io.FileNotFoundException;
 import java.io.IOException;
 import java.io.UnsupportedEncodingException;
+import java.lang.management.ManagementFactory;
 import java.nio.ByteBuffer;
 import java.nio.charset.Charset;
-import java.util.Map;
-import java.util.TreeMap;
+import java.util.Arrays;
+import java.util.concurrent.Executor;
+import java.util.concurrent.TimeUnit;
+
+import javax.management.JMException;
+import javax.management.MBeanServer;
+import javax.management.ObjectName;
 
 import com.serialpundit.core.SerialComPlatform;
 import com.serialpundit.core.SerialComSystemProperty;
@@ -41,8 +47,10 @@ import com.serialpundit.serial.vendor.SerialComVendorLib;
 import com.serialpundit.serial.internal.ISerialIOStream;
 import com.serialpundit.serial.internal.SerialComCompletionDispatcher;
 import com.serialpundit.serial.internal.SerialComDBReleaseJNIBridge;
+import com.serialpundit.serial.internal.SerialComListenerStatsMBean;
 import com.serialpundit.serial.internal.SerialComLooper;
 import com.serialpundit.serial.internal.SerialComPortHandleInfo;
+import com.serialpundit.serial.internal.SerialComPortHandleRegistry;
 import com.serialpundit.serial.internal.SerialComPortJNIBridge;
 import com.serialpundit.serial.internal.SerialComPortMapperJNIBridge;
 import com.serialpundit.serial.internal.SerialComPortsList;
@@ -266,9 +274,61 @@ public final class SerialComManager {
         }
     }
 
+    /** <p>Pre-defined enum constants for defining what happens when a listener's queue is full i.e. 
+     * data/events are coming faster than listener is consuming them. </p>*/
+    public enum OVERFLOWPOLICY {
+        /** <p>Oldest data/event in queue is discarded to make room for new one. </p>*/
+        DROP_OLDEST(1),
+        /** <p>New data/event is discarded. </p>*/
+        DROP_NEWEST(2),
+        /** <p>Native reader waits till there is room in queue. Data then accumulates in operating system 
+         * buffers and if flow control is enabled, sender is asked to stop sending. </p>*/
+        BLOCK(3),
+        /** <p>All the data chunks in queue are merged in one chunk together with new data (nothing is lost). 
+         * For line events, all the events in queue are merged in one event from the oldest previous state 
+         * to the latest new state. </p>*/
+        COALESCE(4);
+        private int value;
+        private OVERFLOWPOLICY(int value) {
+            this.value = value;	
+        }
+        public int getValue() {
+            return this.value;
+        }
+    }
+
+    /** <p>Pre-defined enum constants for defining which thread calls a listener. </p>*/
+    public enum DISPATCHPOLICY {
+        /** <p>Listener is called from a thread of the pool shared by all the ports (default). Application can 
+         * supply its own executor for this using setListenerExecutor() method. </p>*/
+        SHARED(1),
+        /** <p>Listener is called from a thread dedicated to it, which exits when listener is unregistered. </p>*/
+        DEDICATED(2),
+        /** <p>Listener is called directly from the native thread which received data/event, without any hand 
+         * off. Gives lowest latency, but while listener runs no new data/event is read, so listener must 
+         * return quickly. Batching delay is not applied for such listeners. </p>*/
+        INLINE(3);
+        private int value;
+        private DISPATCHPOLICY(int value) {
+            this.value = value;	
+        }
+        public int getValue() {
+            return this.value;
+        }
+    }
+
     /** <p>Default number of bytes (1024) to read from serial port. </p>*/
     public static final int DEFAULT_READBYTECOUNT = 1024;
 
+    /** <p>Default number of data chunks/line events (5000) that can be queued for a listener. </p>*/
+    public static final int DEFAULT_LISTENER_QUEUE_CAPACITY = 5000;
+
+    /** <p>Initial interval (1 millisecond) between scans of input buffers by waitForReadable. </p>*/
+    public static final int POLL_SET_MIN_INTERVAL = 1;
+
+    /** <p>Maximum interval (64 milliseconds) between scans of input buffers by waitForReadable. </p>*/
+    public static final int POLL_SET_MAX_INTERVAL = 64;
+
     /** <p>Clear to send mask bit constant for UART control line. Integer constant with value 0x01. </p>*/
     public static final int CTS =  0x01;  // 0000001
 
@@ -301,10 +361,10 @@ public final class SerialComManager {
      * and made to return to caller explicitly (irrespective there was data to read or not). </p>*/
     public static final String EXP_UNBLOCKIO  = "I/O operation unblocked !";
 
-    // This provides guaranteed log(n) time cost for the containsKey, get, put and remove operations.
-    // It maps opened handle of serial device to its information object. This map may be accessed in 
-    // locked state for maintaining integrity and consistency whenever required.
-    private final TreeMap<Long, SerialComPortHandleInfo> mPortHandleInfo = new TreeMap<Long, SerialComPortHandleInfo>();
+    // Maps opened handle of serial device, and listeners registered for it, to its information object. 
+    // Look ups are lock free and constant time. Modifications are done holding lockB for maintaining 
+    // integrity and consistency.
+    private final SerialComPortHandleRegistry mPortHandleInfo = new SerialComPortHandleRegistry();
 
     private int osType = SerialComPlatform.OS_UNKNOWN;
     private int cpuArch = SerialComPlatform.ARCH_UNKNOWN;
@@ -582,7 +642,6 @@ public final class SerialComManager {
     public long openComPort(final String portName, boolean enableRead, boolean enableWrite, boolean exclusiveOwnerShip) throws SerialComException {
 
         long handle = 0;
-        SerialComPortHandleInfo handleInfo = null;
 
         if(portName == null) {
             throw new IllegalArgumentException("Argument portName can not be null !");
@@ -605,13 +664,8 @@ public final class SerialComManager {
         synchronized(lockB) {
             /* Try to reduce transitions from java to JNI layer as it is possible here by performing check in java layer itself. */
             if(exclusiveOwnerShip == true) {
-                for (Map.Entry<Long, SerialComPortHandleInfo> entry : mPortHandleInfo.entrySet()) {
-                    handleInfo = entry.getValue();
-                    if(handleInfo != null) {
-                        if(handleInfo.containsPort(portNameVal)) {
-                            throw new IllegalStateException("The port " + portNameVal + " is already opened. Exclusive ownership can not be claimed !");
-                        }
-                    }
+                if(mPortHandleInfo.isPortOpened(portNameVal)) {
+                    throw new IllegalStateException("The port " + portNameVal + " is already opened. Exclusive ownership can not be claimed !");
                 }
             }
 
@@ -667,12 +721,25 @@ public final class SerialComManager {
             if(handleInfo.getSerialComOutByteStream() != null) {
                 throw new IllegalStateException("Output byte stream must be closed before closing the serial port !");
             }
+            if(handleInfo.getSerialComChannel() != null) {
+                throw new IllegalStateException("Channel must be closed before closing the serial port !");
+            }
 
             int ret = mComPortJNIBridge.closeComPort(handle);
             if(ret < 0) {
                 throw new SerialComException("Could not close the given serial port. Please retry !");
             }
 
+            /* statistics MXBean of this handle, if any, has nothing to report now. */
+            ObjectName statsMBeanName = handleInfo.getStatsMBeanName();
+            if(statsMBeanName != null) {
+                try {
+                    ManagementFactory.getPlatformMBeanServer().unregisterMBean(statsMBeanName);
+                } catch (JMException e) {
+                }
+                handleInfo.setStatsMBeanName(null);
+            }
+
             /* delete info about this port/handle from global information object. */
             mPortHandleInfo.remove(handle);
         }
@@ -1022,6 +1089,59 @@ public final class SerialComManager {
         return ret;
     }
 
+    /**
+     * <p>Writes length bytes from given buffer starting at offset to the given handle. If context is -1 this 
+     * behaves like writeBytes(handle, buffer, 0) otherwise like writeBytesBlocking(handle, buffer, context) 
+     * for the given part of buffer.</p>
+     * 
+     * <p>Native layer sends whole arrays, so when whole buffer is given (offset is 0 and length is 
+     * buffer.length) it is passed as it is without any copy. Otherwise given part is copied once into a 
+     * new array. Applications writing large amount of data should therefore prefer whole arrays or 
+     * writeBytesDirect method.</p>
+     * 
+     * <p>As with other write methods, less than length bytes may be written when using flow control; 
+     * caller should write remaining bytes again.</p>
+     * 
+     * @param handle handle of the opened port on which to write bytes.
+     * @param buffer byte type buffer containing bytes to be written to port.
+     * @param offset index in given buffer of first byte to be written.
+     * @param length number of bytes to write.
+     * @param context context value obtained form call to createBlockingIOContext method or -1 for 
+     *         non-blocking behavior.
+     * @return number of bytes sent to serial port, 0 if length is 0.
+     * @throws SerialComException if an I/O error occurs.
+     * @throws NullPointerException if <code>buffer</code> is <code>null</code>.
+     * @throws IndexOutOfBoundsException if offset is negative, length is negative, or length is 
+     *          greater than buffer.length - offset.
+     */
+    public int writeBytes(long handle, byte[] buffer, int offset, int length, long context) throws SerialComException {
+        if(buffer == null) {
+            throw new NullPointerException("Null data buffer passed to write operation !");
+        }
+        if((offset < 0) || (length < 0) || (length > (buffer.length - offset))) {
+            throw new IndexOutOfBoundsException("Index violation detected in given byte array !");
+        }
+        if(length == 0) {
+            return 0;
+        }
+
+        byte[] data = buffer;
+        if((offset != 0) || (length != buffer.length)) {
+            data = Arrays.copyOfRange(buffer, offset, offset + length);
+        }
+
+        int ret;
+        if(context == -1) {
+            ret = mComPortJNIBridge.writeBytes(handle, data, 0);
+        }else {
+            ret = mComPortJNIBridge.writeBytesBlocking(handle, data, context);
+        }
+        if(ret < 0) {
+            throw new SerialComException("Could not write data to serial port. Please retry !");
+        }
+        return ret;
+    }
+
     /**
      * <p>Reads the bytes from the serial port into the given direct byte buffer using facilities of 
      * the underlying JVM and operating system.</p>
@@ -1310,6 +1430,67 @@ public final class SerialComManager {
         return numberOfBytesRead;
     }
 
+    /**
+     * <p>Same as readBytes(long, byte[], int, int, long, SerialComLineErrors) but also gives the time at which 
+     * read completed. Time is taken after native read returns, so it is not the arrival time of the data; bytes 
+     * may have been waiting in driver buffers for any amount of time before the read was made, and scheduling 
+     * delay after it adds on top. It is only an upper bound of the arrival time of the last byte read.</p>
+     * 
+     * @param handle of the port from which to read data bytes.
+     * @param buffer data byte buffer in which bytes from serial port will be saved.
+     * @param offset index in given byte array at which first data byte will be placed.
+     * @param length number of bytes to read into given buffer (0 <= length <= 2048).
+     * @param context context obtained by call to createBlockingIOContext method for blocking behavior 
+     *         or -1 for non-blocking behavior.
+     * @param timestamp array whose first element will be set to the read completion time in nanoseconds on 
+     *         the same time scale as System.nanoTime(), if at least 1 byte has been read.
+     * 
+     * @return number of bytes read from serial port.
+     * @throws SerialComException if an I/O error occurs.
+     * @throws NullPointerException if <code>buffer</code> is <code>null</code>.
+     * @throws IndexOutOfBoundsException if offset is negative, length is negative, or length is 
+     *          greater than buffer.length - offset.
+     * @throws IllegalArgumentException if timestamp is null or of zero length.
+     */
+    public int readBytesTimestamped(long handle, byte[] buffer, int offset, int length, long context, long[] timestamp) throws SerialComException {
+        if((timestamp == null) || (timestamp.length == 0)) {
+            throw new IllegalArgumentException("Argument timestamp can not be null or empty !");
+        }
+        int numberOfBytesRead = readBytes(handle, buffer, offset, length, context, null);
+        if(numberOfBytesRead > 0) {
+            timestamp[0] = System.nanoTime();
+        }
+        return numberOfBytesRead;
+    }
+
+    /**
+     * <p>Estimates arrival time of a byte in a chunk of data, from the time of its last byte and the time taken 
+     * to transmit one character at the given baud rate. This assumes the bytes were sent back to back without 
+     * gaps. If chunkTimestamp is a read completion time (as given by readBytesTimestamped), result is also 
+     * only an upper bound.</p>
+     * 
+     * @param chunkTimestamp time of last byte of chunk in nanoseconds.
+     * @param chunkLength number of bytes in chunk.
+     * @param index index of byte in chunk whose arrival time is to be estimated.
+     * @param baudRate baud rate in bits per second.
+     * @param bitsPerCharacter number of bits in one character including start, parity and stop bits 
+     *         (10 for 8N1).
+     * @return estimated arrival time of byte in nanoseconds.
+     * @throws IllegalArgumentException if baudRate or bitsPerCharacter is zero or negative, or index is not 
+     *         within chunk.
+     */
+    public static long estimateByteArrivalTime(long chunkTimestamp, int chunkLength, int index, int baudRate, 
+            int bitsPerCharacter) {
+        if((baudRate <= 0) || (bitsPerCharacter <= 0)) {
+            throw new IllegalArgumentException("Argument baudRate and bitsPerCharacter can not be negative or zero !");
+        }
+        if((index < 0) || (index >= chunkLength)) {
+            throw new IllegalArgumentException("Argument index must be within chunk !");
+        }
+        long characterTime = (bitsPerCharacter * 1000000000L) / baudRate;
+        return chunkTimestamp - ((chunkLength - 1 - index) * characterTime);
+    }
+
     /**
      * <p>This method configures the rate at which communication will occur and the format of UART frame.
      * This method must be called before configureComPortControl method.</p>
@@ -1547,6 +1728,13 @@ public final class SerialComManager {
      * 
      * <p>Application (listener) should implement ISerialComDataListener and override onNewSerialDataAvailable method.</p>
      * 
+     * <p>If the listener implements ISerialComLeasedDataListener, data is copied in buffers taken from a pool 
+     * maintained for this port and delivered through onNewSerialDataLeased method, listener returns them using 
+     * release().</p>
+     * 
+     * <p>If the listener implements ISerialComTimestampedDataListener, data is delivered through 
+     * onNewSerialDataTimestamped method along with the time at which it was received.</p>
+     * 
      * <p>The SerialPundit can manage upto 1024 listeners corresponding to 1024 port handles. Application should not register 
      * data listener more than once for the same port otherwise it will lead to inconsistent state.</p>
      * <p>This method is thread safe.</p>
@@ -1558,12 +1746,65 @@ public final class SerialComManager {
      * @throws IllegalArgumentException if dataListener is null.
      */
     public boolean registerDataListener(long handle, final ISerialComDataListener dataListener) throws SerialComException {
+        return registerDataListener(handle, dataListener, OVERFLOWPOLICY.DROP_OLDEST, DEFAULT_LISTENER_QUEUE_CAPACITY);
+    }
+
+    /**
+     * <p>This method associate a data looper with the given listener, queuing at the most given number of data 
+     * chunks and handling overflow of queue as specified by the given policy. Otherwise it is same as 
+     * registerDataListener(long, ISerialComDataListener) method.</p>
+     * 
+     * <p>Number of chunks/bytes discarded due to overflow can be found using getListenerQueueStatistics method.</p>
+     * 
+     * <p>This method is thread safe.</p>
+     * 
+     * @param handle of the serial port for which given listener will listen for availability of data bytes.
+     * @param dataListener instance of class which implements ISerialComDataListener interface.
+     * @param overflowPolicy what to do when queue is full.
+     * @param queueCapacity maximum number of data chunks that can be queued for this listener.
+     * @return true on success false otherwise.
+     * @throws SerialComException if invalid handle passed, handle is null or data listener already exist for this handle.
+     * @throws IllegalArgumentException if dataListener or overflowPolicy is null or queueCapacity is zero or negative.
+     */
+    public boolean registerDataListener(long handle, final ISerialComDataListener dataListener, 
+            OVERFLOWPOLICY overflowPolicy, int queueCapacity) throws SerialComException {
+        return registerDataListener(handle, dataListener, overflowPolicy, queueCapacity, DISPATCHPOLICY.SHARED);
+    }
+
+    /**
+     * <p>This method associate a data looper with the given listener, delivering data from the thread 
+     * chosen by the given dispatch policy. Otherwise it is same as 
+     * registerDataListener(long, ISerialComDataListener, OVERFLOWPOLICY, int) method.</p>
+     * 
+     * <p>This method is thread safe.</p>
+     * 
+     * @param handle of the serial port for which given listener will listen for availability of data bytes.
+     * @param dataListener instance of class which implements ISerialComDataListener interface.
+     * @param overflowPolicy what to do when queue is full.
+     * @param queueCapacity maximum number of data chunks that can be queued for this listener.
+     * @param dispatchPolicy which thread calls the listener.
+     * @return true on success false otherwise.
+     * @throws SerialComException if invalid handle passed, handle is null or data listener already exist for this handle.
+     * @throws IllegalArgumentException if dataListener, overflowPolicy or dispatchPolicy is null or queueCapacity 
+     *         is zero or negative.
+     */
+    public boolean registerDataListener(long handle, final ISerialComDataListener dataListener, 
+            OVERFLOWPOLICY overflowPolicy, int queueCapacity, DISPATCHPOLICY dispatchPolicy) throws SerialComException {
 
         SerialComPortHandleInfo handleInfo = null;
 
         if(dataListener == null) {
             throw new IllegalArgumentException("Argument dataListener can not be null !");
         }
+        if(overflowPolicy == null) {
+            throw new IllegalArgumentException("Argument overflowPolicy can not be null !");
+        }
+        if(queueCapacity <= 0) {
+            throw new IllegalArgumentException("Argument queueCapacity can not be negative or zero !");
+        }
+        if(dispatchPolicy == null) {
+            throw new IllegalArgumentException("Argument dispatchPolicy can not be null !");
+        }
 
         synchronized(lockB) {
             handleInfo = mPortHandleInfo.get(handle);
@@ -1574,7 +1815,7 @@ public final class SerialComManager {
                 throw new SerialComException("Data listener already exist for this handle. A handle can have only one data listener !");
             }
 
-            return mEventCompletionDispatcher.setUpDataLooper(handle, handleInfo, dataListener);
+            return mEventCompletionDispatcher.setUpDataLooper(handle, handleInfo, dataListener, overflowPolicy, queueCapacity, dispatchPolicy);
         }
     }
 
@@ -1635,12 +1876,63 @@ public final class SerialComManager {
      * @throws IllegalArgumentException if eventListener is null. 
      */
     public boolean registerLineEventListener(long handle, final ISerialComEventListener eventListener) throws SerialComException {
+        return registerLineEventListener(handle, eventListener, OVERFLOWPOLICY.DROP_OLDEST, DEFAULT_LISTENER_QUEUE_CAPACITY);
+    }
+
+    /**
+     * <p>This method associate a event looper with the given listener, queuing at the most given number of line 
+     * events and handling overflow of queue as specified by the given policy. Otherwise it is same as 
+     * registerLineEventListener(long, ISerialComEventListener) method.</p>
+     * 
+     * <p>This method is thread safe.</p>
+     * 
+     * @param handle of the port opened.
+     * @param eventListener instance of class which implements ISerialComEventListener interface.
+     * @param overflowPolicy what to do when queue is full.
+     * @param queueCapacity maximum number of line events that can be queued for this listener.
+     * @return true on success false otherwise.
+     * @throws SerialComException if invalid handle passed, handle is null or event listener already exist for this handle.
+     * @throws IllegalArgumentException if eventListener or overflowPolicy is null or queueCapacity is zero or negative.
+     */
+    public boolean registerLineEventListener(long handle, final ISerialComEventListener eventListener, 
+            OVERFLOWPOLICY overflowPolicy, int queueCapacity) throws SerialComException {
+        return registerLineEventListener(handle, eventListener, overflowPolicy, queueCapacity, DISPATCHPOLICY.SHARED);
+    }
+
+    /**
+     * <p>This method associate a event looper with the given listener, delivering events from the thread 
+     * chosen by the given dispatch policy. Otherwise it is same as 
+     * registerLineEventListener(long, ISerialComEventListener, OVERFLOWPOLICY, int) method.</p>
+     * 
+     * <p>This method is thread safe.</p>
+     * 
+     * @param handle of the port opened.
+     * @param eventListener instance of class which implements ISerialComEventListener interface.
+     * @param overflowPolicy what to do when queue is full.
+     * @param queueCapacity maximum number of line events that can be queued for this listener.
+     * @param dispatchPolicy which thread calls the listener.
+     * @return true on success false otherwise.
+     * @throws SerialComException if invalid handle passed, handle is null or event listener already exist for this handle.
+     * @throws IllegalArgumentException if eventListener, overflowPolicy or dispatchPolicy is null or queueCapacity 
+     *         is zero or negative.
+     */
+    public boolean registerLineEventListener(long handle, final ISerialComEventListener eventListener, 
+            OVERFLOWPOLICY overflowPolicy, int queueCapacity, DISPATCHPOLICY dispatchPolicy) throws SerialComException {
 
         SerialComPortHandleInfo handleInfo = null;
 
         if(eventListener == null) {
             throw new IllegalArgumentException("Argument eventListener can not be null !");
         }
+        if(overflowPolicy == null) {
+            throw new IllegalArgumentException("Argument overflowPolicy can not be null !");
+        }
+        if(queueCapacity <= 0) {
+            throw new IllegalArgumentException("Argument queueCapacity can not be negative or zero !");
+        }
+        if(dispatchPolicy == null) {
+            throw new IllegalArgumentException("Argument dispatchPolicy can not be null !");
+        }
 
         synchronized(lockB) {
             handleInfo = mPortHandleInfo.get(handle);
@@ -1652,7 +1944,7 @@ public final class SerialComManager {
                 throw new SerialComException("Event listener already exist for this handle. A handle can have only one event listener !");
             }
 
-            return mEventCompletionDispatcher.setUpEventLooper(handle, handleInfo, eventListener);
+            return mEventCompletionDispatcher.setUpEventLooper(handle, handleInfo, eventListener, overflowPolicy, queueCapacity, dispatchPolicy);
         }
     }
 
@@ -1729,6 +2021,167 @@ public final class SerialComManager {
         return false;
     }
 
+    /**
+     * <p>Sets the executor whose threads call data/event listeners registered with DISPATCHPOLICY.SHARED. By 
+     * default a pool with one thread per processor, shared by all the ports, is used. Server applications 
+     * may supply their own executor to size and monitor listener threads, for example a virtual thread per 
+     * task executor on Java 21 and later.</p>
+     * 
+     * <p>The executor must run every submitted task, a task rejected by executor is retried only when next 
+     * data/event arrives. Applies to listeners registered after this call.</p>
+     * 
+     * @param executor executor to be used or null to restore the default pool.
+     */
+    public void setListenerExecutor(Executor executor) {
+        mEventCompletionDispatcher.setSharedExecutor(executor);
+    }
+
+    /**
+     * <p>Gives statistics about queues of data and event listeners registered for the given handle. This helps in 
+     * finding whether a slow listener is losing data or events due to overflow of its queue.</p>
+     * 
+     * <p>The sequence of values returned is : <br>
+     * [0] number of data chunks discarded <br>
+     * [1] number of data bytes discarded <br>
+     * [2] number of data listener errors discarded <br>
+     * [3] maximum number of data chunks that were in queue at any time (high watermark) <br>
+     * [4] number of line events discarded <br>
+     * [5] maximum number of line events that were in queue at any time (high watermark) <br></p>
+     * 
+     * <p>Counters are reset when a data/event listener is registered.</p>
+     * 
+     * @param handle of the port opened.
+     * @return array containing queue statistics.
+     * @throws SerialComException if invalid handle is passed or no listener is registered for this handle.
+     */
+    public long[] getListenerQueueStatistics(long handle) throws SerialComException {
+        SerialComPortHandleInfo handleInfo = mPortHandleInfo.get(handle);
+        if(handleInfo == null) {
+            throw new SerialComException("Given handle is alien to me !");
+        }
+        SerialComLooper looper = handleInfo.getLooper();
+        if(looper == null) {
+            throw new SerialComException("No listener is registered for this handle !");
+        }
+        return looper.getQueueStatistics();
+    }
+
+    /**
+     * <p>Gives snapshot of delivery statistics of data and event listeners registered for the given handle. 
+     * Apart from what getListenerQueueStatistics gives, this includes number of chunks/bytes/events delivered, 
+     * current depth of queues and histograms of time spent in listener callbacks and of latency from arrival 
+     * of data/event till delivery to listener.</p>
+     * 
+     * <p>Arrival latency of data is known only for listeners implementing ISerialComLeasedDataListener or 
+     * ISerialComTimestampedDataListener interface, as plain byte array chunks do not carry arrival time.</p>
+     * 
+     * <p>Counters and histograms are reset when a data/event listener is registered.</p>
+     * 
+     * @param handle of the port opened.
+     * @return snapshot of listener statistics.
+     * @throws SerialComException if invalid handle is passed or no listener is registered for this handle.
+     */
+    public SerialComListenerStats getListenerStats(long handle) throws SerialComException {
+        SerialComPortHandleInfo handleInfo = mPortHandleInfo.get(handle);
+        if(handleInfo == null) {
+            throw new SerialComException("Given handle is alien to me !");
+        }
+        SerialComLooper looper = handleInfo.getLooper();
+        if(looper == null) {
+            throw new SerialComException("No listener is registered for this handle !");
+        }
+        return looper.getListenerStats(handleInfo.getOpenedPortName());
+    }
+
+    /**
+     * <p>Registers or unregisters a MXBean with platform MBean server which exposes listener statistics of 
+     * the given handle to JMX tools like jconsole or VisualVM. The MXBean is registered with name 
+     * com.serialpundit.serial:type=ListenerStats,port=&lt;port name&gt;,handle=&lt;handle&gt; and remains valid 
+     * across registering/unregistering listeners. It is unregistered automatically when port is closed.</p>
+     * 
+     * @param handle of the port opened.
+     * @param enable true to register MXBean, false to unregister it.
+     * @return true on success.
+     * @throws SerialComException if invalid handle is passed or MXBean can not be registered/unregistered.
+     */
+    public boolean setListenerStatsMBeanEnabled(long handle, boolean enable) throws SerialComException {
+        synchronized(lockB) {
+            SerialComPortHandleInfo handleInfo = mPortHandleInfo.get(handle);
+            if(handleInfo == null) {
+                throw new SerialComException("Given handle is alien to me !");
+            }
+
+            MBeanServer server = ManagementFactory.getPlatformMBeanServer();
+            ObjectName name = handleInfo.getStatsMBeanName();
+            try {
+                if(enable == true) {
+                    if(name == null) {
+                        name = new ObjectName("com.serialpundit.serial:type=ListenerStats,port=" + 
+                                ObjectName.quote(handleInfo.getOpenedPortName()) + ",handle=" + handle);
+                        server.registerMBean(new SerialComListenerStatsMBean(handleInfo), name);
+                        handleInfo.setStatsMBeanName(name);
+                    }
+                }else {
+                    if(name != null) {
+                        server.unregisterMBean(name);
+                        handleInfo.setStatsMBeanName(null);
+                    }
+                }
+            } catch (JMException e) {
+                throw new SerialComException(e.getMessage());
+            }
+        }
+        return true;
+    }
+
+    /**
+     * <p>Enables or disables batching of data delivered to the data listener registered for the given handle. 
+     * By default every chunk of data read by native layer is delivered in a separate call to the listener. For 
+     * high frequency streams with many small reads this causes too many calls.</p>
+     * 
+     * <p>When batching is enabled, chunks waiting in queue are merged and delivered in one call. If less than 
+     * maxBytes bytes are available, the partial batch is held back at the most maxDelay milliseconds from the start 
+     * of batch for more data, so worst case latency remains bounded. No thread waits meanwhile, a timer schedules 
+     * the looper again at the deadline. Chunks are never split, so a batch can be bigger than maxBytes only if a 
+     * single chunk is bigger than maxBytes.</p>
+     * 
+     * <p>Batching is disabled whenever a data listener is registered, this method should be called after 
+     * registering data listener.</p>
+     * 
+     * @param handle of the port opened.
+     * @param maxBytes maximum number of bytes in one batch, 0 to disable batching.
+     * @param maxChunks maximum number of data chunks merged in one batch.
+     * @param maxDelay maximum time in milliseconds to wait for more data before delivering batch, 0 to 
+     *         merge only chunks already in queue.
+     * @return true on success.
+     * @throws SerialComException if invalid handle is passed or no data listener is registered for this handle.
+     * @throws IllegalArgumentException if maxBytes, maxDelay is negative or maxChunks is less than 1 when 
+     *         batching is enabled.
+     */
+    public boolean setDataListenerBatching(long handle, int maxBytes, int maxChunks, int maxDelay) throws SerialComException {
+        if(maxBytes < 0) {
+            throw new IllegalArgumentException("Argument maxBytes can not be negative !");
+        }
+        if((maxBytes > 0) && (maxChunks < 1)) {
+            throw new IllegalArgumentException("Argument maxChunks can not be less than 1 !");
+        }
+        if(maxDelay < 0) {
+            throw new IllegalArgumentException("Argument maxDelay can not be negative !");
+        }
+
+        SerialComPortHandleInfo handleInfo = mPortHandleInfo.get(handle);
+        if(handleInfo == null) {
+            throw new SerialComException("Given handle is alien to me !");
+        }
+        SerialComLooper looper = handleInfo.getLooper();
+        if((looper == null) || (handleInfo.getDataListener() == null)) {
+            throw new SerialComException("No data listener is registered for this handle !");
+        }
+
+        looper.setDataBatching(maxBytes, maxChunks, maxDelay * 1000000L);
+        return true;
+    }
+
     /**
      * <p>This method gives more fine tune control to application for tuning performance and behavior of read
      * operations to leverage OS specific facility for read operation. The read operations can be optimized for
@@ -1804,15 +2257,10 @@ public final class SerialComManager {
             throw new IllegalArgumentException("Argument eventListener can not be null !");
         }
 
-        for (Map.Entry<Long, SerialComPortHandleInfo> entry : mPortHandleInfo.entrySet()) {
-            handleInfo = entry.getValue();
-            if(handleInfo != null) {
-                if(handleInfo.containsEventListener(eventListener)) {
-                    looper = handleInfo.getLooper();
-                    mEventListener = handleInfo.getEventListener();
-                    break;
-                }
-            }
+        handleInfo = mPortHandleInfo.getByEventListener(eventListener);
+        if(handleInfo != null) {
+            looper = handleInfo.getLooper();
+            mEventListener = handleInfo.getEventListener();
         }
 
         if(looper != null && mEventListener != null) {
@@ -1823,6 +2271,72 @@ public final class SerialComManager {
         }
     }
 
+    /**
+     * <p>Enables or disables coalescing of line events for the given listener and recording of transition 
+     * history. Noisy handshake lines may toggle much faster than the listener can handle events.</p>
+     * 
+     * <p>With coalescing, all the transitions happening before listener takes the pending event are merged 
+     * in that event. SerialComLineEvent then gives net change along with number of transitions of each line 
+     * and time of first and last transition, so no information about activity is lost.</p>
+     * 
+     * <p>If historyCapacity is more than 0, time and line state of the latest historyCapacity transitions 
+     * are also recorded in a ring buffer which can be read using getLineEventHistory() method.</p>
+     * 
+     * <p>Settings are reset when event listener is registered again.</p>
+     * 
+     * @param eventListener instance of class which implemented ISerialComEventListener interface.
+     * @param coalesce true to merge transitions in pending event, false to deliver every transition as event.
+     * @param historyCapacity number of transitions to be remembered, 0 to disable history.
+     * @return true on success.
+     * @throws SerialComException if this listener is not registered.
+     * @throws IllegalArgumentException if eventListener is null or historyCapacity is negative.
+     */
+    public boolean setLineEventCoalescing(final ISerialComEventListener eventListener, boolean coalesce, int historyCapacity) throws SerialComException {
+        if(eventListener == null) {
+            throw new IllegalArgumentException("Argument eventListener can not be null !");
+        }
+        if(historyCapacity < 0) {
+            throw new IllegalArgumentException("Argument historyCapacity can not be negative !");
+        }
+
+        SerialComPortHandleInfo handleInfo = mPortHandleInfo.getByEventListener(eventListener);
+        if((handleInfo == null) || (handleInfo.getLooper() == null)) {
+            throw new SerialComException("This listener is not registered !");
+        }
+
+        handleInfo.getLooper().setLineEventCoalescing(coalesce, historyCapacity);
+        return true;
+    }
+
+    /**
+     * <p>Gives transitions recorded on control lines, oldest first, and removes them from history. Each 
+     * transition is represented by its time (same time scale as System.nanoTime()) and bit mask of CTS, DSR, 
+     * DCD and RI after the transition. If more transitions happened than history capacity, oldest ones 
+     * are lost.</p>
+     * 
+     * @param eventListener instance of class which implemented ISerialComEventListener interface.
+     * @param timestamps array in which time of transitions will be saved.
+     * @param lineStates array in which line states will be saved.
+     * @return number of transitions saved in given arrays, 0 if history is not enabled or empty.
+     * @throws SerialComException if this listener is not registered.
+     * @throws IllegalArgumentException if any argument is null.
+     */
+    public int getLineEventHistory(final ISerialComEventListener eventListener, long[] timestamps, int[] lineStates) throws SerialComException {
+        if(eventListener == null) {
+            throw new IllegalArgumentException("Argument eventListener can not be null !");
+        }
+        if((timestamps == null) || (lineStates == null)) {
+            throw new IllegalArgumentException("Arguments timestamps and lineStates can not be null !");
+        }
+
+        SerialComPortHandleInfo handleInfo = mPortHandleInfo.getByEventListener(eventListener);
+        if((handleInfo == null) || (handleInfo.getLooper() == null)) {
+            throw new SerialComException("This listener is not registered !");
+        }
+
+        return handleInfo.getLooper().getLineEventHistory(timestamps, lineStates);
+    }
+
     /**
      * <p>This method return currently applicable mask for events on serial port.</p>
      * 
@@ -1841,15 +2355,10 @@ public final class SerialComManager {
             throw new IllegalArgumentException("Argument eventListener can not be null !");
         }
 
-        for (Map.Entry<Long, SerialComPortHandleInfo> entry : mPortHandleInfo.entrySet()) {
-            handleInfo = entry.getValue();
-            if(handleInfo != null) {
-                if(handleInfo.containsEventListener(eventListener)) {
-                    looper = handleInfo.getLooper();
-                    mEventListener = handleInfo.getEventListener();
-                    break;
-                }
-            }
+        handleInfo = mPortHandleInfo.getByEventListener(eventListener);
+        if(handleInfo != null) {
+            looper = handleInfo.getLooper();
+            mEventListener = handleInfo.getEventListener();
         }
 
         if(looper != null && mEventListener != null) {
@@ -2094,6 +2603,116 @@ public final class SerialComManager {
         return numBytesInfo;
     }
 
+    /**
+     * <p>Waits until at least one of the given handles has data in its input buffer or timeout elapses. 
+     * Handles having data and number of bytes available for each of them are saved in given arrays, 
+     * so that a polling application reads only from ports which have data.</p>
+     * 
+     * <p>Readiness is found by querying input buffer byte count of every handle without reading or copying 
+     * any data, so each scan costs O(number of handles) with one native call and a small array per handle. 
+     * If none of the handles has data, scan is repeated at intervals growing from POLL_SET_MIN_INTERVAL to 
+     * POLL_SET_MAX_INTERVAL milliseconds until timeout, so readiness may be noticed up to 
+     * POLL_SET_MAX_INTERVAL milliseconds late. This method is shaped so that a native readiness wait (epoll 
+     * on Linux) can replace the scan later without any change for callers.</p>
+     * 
+     * <p>Applications polling same set of handles repeatedly may use SerialComPollSet which reuses result 
+     * arrays.</p>
+     * 
+     * @param handles handles of opened ports to be checked.
+     * @param timeout maximum time to wait in milliseconds, 0 to check once and return immediately or 
+     *         negative to wait until a handle has data.
+     * @param readyHandles array in which handles having data will be saved, must be at least as long 
+     *         as handles.
+     * @param byteCounts array in which number of bytes available for each ready handle will be saved or 
+     *         null if counts are not needed.
+     * @return number of handles saved in readyHandles, 0 if timeout elapsed or waiting thread was interrupted.
+     * @throws SerialComException if an alien handle is given or byte count can not be determined.
+     * @throws IllegalArgumentException if handles or readyHandles is null, or arrays are shorter than handles.
+     */
+    public int waitForReadable(long[] handles, int timeout, long[] readyHandles, int[] byteCounts) throws SerialComException {
+        if((handles == null) || (readyHandles == null)) {
+            throw new IllegalArgumentException("Argument handles and readyHandles can not be null !");
+        }
+        if((readyHandles.length < handles.length) || ((byteCounts != null) && (byteCounts.length < handles.length))) {
+            throw new IllegalArgumentException("Argument readyHandles and byteCounts must be at least as long as handles !");
+        }
+        for(int x=0; x < handles.length; x++) {
+            if(mPortHandleInfo.get(handles[x]) == null) {
+                throw new SerialComException("Given handle is alien to me !");
+            }
+        }
+
+        long deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(timeout);
+        long interval = POLL_SET_MIN_INTERVAL;
+        while(true) {
+            int numReady = 0;
+            for(int x=0; x < handles.length; x++) {
+                int[] numBytesInfo = mComPortJNIBridge.getByteCount(handles[x]);
+                if(numBytesInfo == null) {
+                    throw new SerialComException("Could not determine number of bytes in buffer. Please retry !");
+                }
+                if(numBytesInfo[0] > 0) {
+                    readyHandles[numReady] = handles[x];
+                    if(byteCounts != null) {
+                        byteCounts[numReady] = numBytesInfo[0];
+                    }
+                    numReady++;
+                }
+            }
+            if((numReady > 0) || (timeout == 0)) {
+                return numReady;
+            }
+
+            long sleepTime = interval;
+            if(timeout > 0) {
+                long remaining = TimeUnit.NANOSECONDS.toMillis(deadline - System.nanoTime());
+                if(remaining <= 0) {
+                    return 0;
+                }
+                if(remaining < sleepTime) {
+                    sleepTime = remaining;
+                }
+            }
+            try {
+                Thread.sleep(sleepTime);
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+                return 0;
+            }
+            interval = Math.min(interval * 2, POLL_SET_MAX_INTERVAL);
+        }
+    }
+
+    /**
+     * <p>Same as waitForReadable(handles, timeout, readyHandles, null) but returns ready handles in a new 
+     * array.</p>
+     * 
+     * @param handles handles of opened ports to be checked.
+     * @param timeout maximum time to wait in milliseconds, 0 to check once and return immediately or 
+     *         negative to wait until a handle has data.
+     * @return handles having data, empty array if none.
+     * @throws SerialComException if an alien handle is given or byte count can not be determined.
+     * @throws IllegalArgumentException if handles is null.
+     */
+    public long[] waitForReadable(long[] handles, int timeout) throws SerialComException {
+        if(handles == null) {
+            throw new IllegalArgumentException("Argument handles can not be null !");
+        }
+        long[] readyHandles = new long[handles.length];
+        int numReady = waitForReadable(handles, timeout, readyHandles, null);
+        return Arrays.copyOf(readyHandles, numReady);
+    }
+
+    /**
+     * <p>Creates an empty poll set, handles can then be added to it and polled repeatedly for 
+     * readiness.</p>
+     * 
+     * @return new poll set associated with this SerialComManager instance.
+     */
+    public SerialComPollSet createPollSet() {
+        return new SerialComPollSet(this);
+    }
+
     /**
      * <p>This method gives the port name with which given handle is associated. If the given handle is
      * unknown to this library, null is returned. A serial port is known to this if it was opened using 
@@ -2380,6 +2999,53 @@ public final class SerialComManager {
         }
     }
 
+    /**
+     * <p>Gives a NIO channel for the given handle which can be used for both reading and writing. Only one 
+     * channel can exist for a handle at a time, it must be closed before closing the serial port.</p>
+     * 
+     * @param handle handle of the opened serial port which this channel will wrap internally.
+     * @param channelMode enum value SMODE.BLOCKING or SMODE.NONBLOCKING.
+     * @return channel for given handle.
+     * @throws SerialComException if channel already exist for this handle or invalid handle is passed.
+     * @throws IllegalArgumentException if channelMode is null.
+     */
+    public SerialComChannel getChannel(long handle, SMODE channelMode) throws SerialComException {
+
+        if(channelMode == null) {
+            throw new IllegalArgumentException("Argument channelMode can not be null !");
+        }
+
+        synchronized(lockB) {
+            SerialComPortHandleInfo handleInfo = mPortHandleInfo.get(handle);
+            if(handleInfo == null) {
+                throw new SerialComException("Given handle is alien to me !");
+            }
+            if(handleInfo.getSerialComChannel() != null) {
+                throw new SerialComException("Channel already exist for this handle !");
+            }
+
+            SerialComChannel channel = new SerialComChannel(this, handleInfo, handle, channelMode);
+            handleInfo.setSerialComChannel(channel);
+            return channel;
+        }
+    }
+
+    /**
+     * <p>Gives an asynchronous channel for the given handle. The channel registers a data listener for the 
+     * handle, so no other data listener can be registered until channel is closed. Channel must be closed 
+     * before closing the serial port.</p>
+     * 
+     * @param handle handle of the opened serial port which this channel will wrap internally.
+     * @param receiveBufferSize maximum number of bytes kept when no read is outstanding, typically 
+     *         AsynchronousSerialChannel.DEFAULT_RECEIVE_BUFFER_SIZE.
+     * @return asynchronous channel for given handle.
+     * @throws SerialComException if invalid handle is passed or a data listener already exist for this handle.
+     * @throws IllegalArgumentException if receiveBufferSize is negative or zero.
+     */
+    public AsynchronousSerialChannel getAsynchronousChannel(long handle, int receiveBufferSize) throws SerialComException {
+        return new AsynchronousSerialChannel(this, handle, receiveBufferSize);
+    }
+
     /**
      * <p>Gives an instance of the class which implements API defined by vendor in their propriety library.</p>
      * 
@@ -24,6 +24,11 @@ import com.serialpundit.serial.internal.SerialComPortHandleInfo;
 /**
  * <p>Represents an output stream of bytes that gets sent over to serial port for transmission.</p>
  * 
+ * <p>By default every write call sends data to serial port before returning. Applications writing many 
+ * small pieces of data can enable an internal write buffer using setWriteBufferSize() method. Bytes are 
+ * then collected in this buffer and sent in one native call when buffer gets full, or when flush() or 
+ * close() is called.</p>
+ * 
  * @author Rishi Gupta
  */
 public final class SerialComOutByteStream extends OutputStream implements ISerialIOStream {
@@ -36,6 +41,11 @@ public final class SerialComOutByteStream extends OutputStream implements ISeria
     private final long context;
     private boolean isOpened;
 
+    // Bytes written by application but not yet sent are writeBuffer[0] to writeBuffer[writeCount - 1].
+    private volatile byte[] writeBuffer;
+    private int writeCount;
+    private final byte[] singleByte = new byte[1];
+
     /**
      * <p>Allocates a new SerialComOutByteStream object.</p>
      * 
@@ -57,12 +67,133 @@ public final class SerialComOutByteStream extends OutputStream implements ISeria
             context = scm.createBlockingIOContext();
             isBlocking = true;
         }else {
-            context = 0;
+            context = -1;
             isBlocking = false;
         }
         isOpened = true;
     }
 
+    /**
+     * <p>Enables or disables internal write buffer. When enabled, bytes written are sent to serial port 
+     * only when buffer gets full or flush()/close() is called. Writes larger than buffer are sent directly. 
+     * Bytes pending in existing buffer are sent before buffer is changed.</p>
+     * 
+     * @param size size of write buffer in bytes or 0 to disable buffering (default).
+     * @throws IOException if pending bytes can not be sent or output stream has been closed.
+     * @throws IllegalArgumentException if size is negative.
+     */
+    public void setWriteBufferSize(int size) throws IOException {
+        if(isOpened != true) {
+            throw new IOException("The byte stream has been closed !");
+        }
+        if(size < 0) {
+            throw new IllegalArgumentException("Argument size can not be negative !");
+        }
+        synchronized(lock) {
+            flushWriteBuffer();
+            if(size == 0) {
+                writeBuffer = null;
+            }else {
+                writeBuffer = new byte[size];
+            }
+        }
+    }
+
+    /**
+     * <p>Gives size of internal write buffer.</p>
+     * 
+     * @return size of write buffer in bytes or 0 if buffering is disabled.
+     */
+    public int getWriteBufferSize() {
+        synchronized(lock) {
+            return (writeBuffer == null) ? 0 : writeBuffer.length;
+        }
+    }
+
+    /*
+     * Makes one native write call. Returns number of bytes sent or -1 if stream is being closed and blocked 
+     * write was asked to return. Caller must hold lock.
+     */
+    private int writeOnce(byte[] data, int off, int len) throws IOException {
+        int ret;
+        try {
+            ret = scm.writeBytes(handle, data, off, len, context);
+        }catch (SerialComException e) {
+            if(SerialComManager.EXP_UNBLOCKIO.equals(e.getExceptionMsg())) {
+                // this exception message occurs when application has closed stream.
+                // release lock so that blocking context can be destroyed.
+                return -1;
+            }
+            // this is error other than expected, pass it to the application.
+            throw new IOException(e.getExceptionMsg());
+        }
+        if(ret <= 0) {
+            throw new IOException("Given data not sent to serial port. Please retry !");
+        }
+        return ret;
+    }
+
+    /*
+     * Sends len bytes from data starting at off, writing again whatever could not be sent in one call. 
+     * Returns false if stream is being closed and blocked write was asked to return. Caller must hold lock.
+     */
+    private boolean writeToPort(byte[] data, int off, int len) throws IOException {
+        while(len > 0) {
+            int ret = writeOnce(data, off, len);
+            if(ret < 0) {
+                return false;
+            }
+            off += ret;
+            len -= ret;
+        }
+        return true;
+    }
+
+    /*
+     * Sends bytes pending in write buffer. Only bytes actually sent are removed from buffer, so if write 
+     * fails remaining bytes stay pending and are sent by next flush, in order. Caller must hold lock.
+     */
+    private void flushWriteBuffer() throws IOException {
+        int sent = 0;
+        try {
+            while(sent < writeCount) {
+                int ret = writeOnce(writeBuffer, sent, writeCount - sent);
+                if(ret < 0) {
+                    break;
+                }
+                sent += ret;
+            }
+        }finally {
+            if(sent > 0) {
+                writeCount -= sent;
+                if(writeCount > 0) {
+                    System.arraycopy(writeBuffer, sent, writeBuffer, 0, writeCount);
+                }
+            }
+        }
+    }
+
+    /*
+     * Buffers or sends given bytes as per current buffering mode. Caller must hold lock.
+     */
+    private void writeBytes(byte[] data, int off, int len) throws IOException {
+        if(writeBuffer == null) {
+            writeToPort(data, off, len);
+            return;
+        }
+        if(len >= writeBuffer.length) {
+            // keep order of bytes, then send large data directly without copying into buffer.
+            flushWriteBuffer();
+            writeToPort(data, off, len);
+            return;
+        }
+        if(len > (writeBuffer.length - writeCount)) {
+            flushWriteBuffer();
+        }
+        System.arraycopy(data, off, writeBuffer, writeCount, len);
+        writeCount += len;
+    }
+
     /**
      * <p>Writes the specified byte to this output stream (eight low-order bits of the argument data).
      * The 24 high-order bits of data are ignored.</p>
@@ -75,31 +206,14 @@ public final class SerialComOutByteStream extends OutputStream implements ISeria
         if(isOpened != true) {
             throw new IOException("The byte stream has been closed !");
         }
-        try {
-            if(isBlocking == true) {
-                synchronized(lock) {
-                    try {
-                        byte[] buffer = new byte[1];
-                        buffer[0] = (byte)data;
-                        data = scm.writeBytesBlocking(handle, buffer, context);
-                    }catch (SerialComException e) {
-                        if(SerialComManager.EXP_UNBLOCKIO.equals(e.getExceptionMsg())) {
-                            // this exception message occurs when application has closed stream.
-                            // release lock so that blocking context can be destroyed.
-                            return;
-                        }
-                        // this is error other than expected, pass it to the application.
-                        throw new IOException(e.getExceptionMsg());
-                    }
-                }
-            }else {
-                int ret = scm.writeSingleByte(handle, (byte)data);
-                if(ret == 0) {
-                    throw new IOException("Given data not sent to serial port. Please retry !");
-                }
+        synchronized(lock) {
+            if((writeBuffer != null) && (writeCount < writeBuffer.length)) {
+                writeBuffer[writeCount] = (byte)data;
+                writeCount++;
+                return;
             }
-        } catch (SerialComException e) {
-            throw new IOException(e.getExceptionMsg());
+            singleByte[0] = (byte)data;
+            writeBytes(singleByte, 0, 1);
         }
     }
 
@@ -118,29 +232,8 @@ public final class SerialComOutByteStream extends OutputStream implements ISeria
         if((data == null) || (data.length == 0)) {
             throw new IllegalArgumentException("Argument data can not be null or an empty array !");
         }
-        try {
-            if(isBlocking == true) {
-                synchronized(lock) {
-                    try {
-                        int result = scm.writeBytesBlocking(handle, data, context);
-                        if(result == 0) {
-                            throw new IOException("Given data not sent to serial port. Please retry !");
-                        }
-                    }catch (SerialComException e) {
-                        if(SerialComManager.EXP_UNBLOCKIO.equals(e.getExceptionMsg())) {
-                            return;
-                        }
-                        throw new IOException(e.getExceptionMsg());
-                    }
-                }
-            }else {
-                int ret = scm.writeBytes(handle, data, 0);
-                if(ret == 0) {
-                    throw new IOException("Given data not sent to serial port. Please retry !");
-                }
-            }
-        } catch (SerialComException e) {
-            throw new IOException(e.getExceptionMsg());
+        synchronized(lock) {
+            writeBytes(data, 0, data.length);
         }
     }
 
@@ -170,41 +263,17 @@ public final class SerialComOutByteStream extends OutputStream implements ISeria
         if((off < 0) || (len < 0) || ((off+len) > data.length)) {
             throw new IndexOutOfBoundsException("Index violation detected in given data array !");
         }
-
-        int i = off;
-        byte[] buf = new byte[len];
-        for(int x=0; x<len; x++) {
-            buf[x] = data[i];
-            i++;
+        if(len == 0) {
+            return;
         }
-        try {
-            if(isBlocking == true) {
-                synchronized(lock) {
-                    try {
-                        int result = scm.writeBytesBlocking(handle, buf, context);
-                        if(result == 0) {
-                            throw new IOException("Given data not sent to serial port. Please retry !");
-                        }
-                    }catch (SerialComException e) {
-                        if(SerialComManager.EXP_UNBLOCKIO.equals(e.getExceptionMsg())) {
-                            return;
-                        }
-                        throw new IOException(e.getExceptionMsg());
-                    }
-                }
-            }else {
-                int ret = scm.writeBytes(handle, buf, 0);
-                if(ret == 0) {
-                    throw new IOException("Given data not sent to serial port. Please retry !");
-                }
-            }
-        } catch (SerialComException e) {
-            throw new IOException(e.getExceptionMsg());
+        synchronized(lock) {
+            writeBytes(data, off, len);
         }
     }
 
     /**
-     * <p>SCM always flushes data every time writeBytes() method is called. So do nothing just return.</p>
+     * <p>Sends bytes pending in internal write buffer, if any, to serial port. When write buffer is not 
+     * enabled, data is always sent every time a write method is called, so this does nothing.</p>
      * 
      * @throws IOException if write fails or output stream has been closed.
      */
@@ -213,10 +282,14 @@ public final class SerialComOutByteStream extends OutputStream implements ISeria
         if(isOpened != true) {
             throw new IOException("The byte stream has been closed !");
         }
+        synchronized(lock) {
+            flushWriteBuffer();
+        }
     }
 
     /**
-     * <p>This method releases the OutputStream object internally associated with the operating handle.</p>
+     * <p>This method releases the OutputStream object internally associated with the operating handle. 
+     * Bytes pending in internal write buffer are sent before releasing.</p>
      * <p>To actually close the port closeComPort() method should be used.</p>
      * 
      * @throws IOException if write fails or output stream has been closed.
@@ -226,16 +299,25 @@ public final class SerialComOutByteStream extends OutputStream implements ISeria
         if(isOpened != true) {
             throw new IOException("The byte stream has been already closed !");
         }
-        if(isBlocking == true) {
-            scm.unblockBlockingIOOperation(context);
-            // if there was a blocked write operation, it will hold this lock. when it gets unblocked
-            // it will release this lock and therefore this close method will acquire this lock.
-            // once the lock is acquired it is safe to destroy context.
-            synchronized(lock) {
-                scm.destroyBlockingIOContext(context);
+        try {
+            // without write buffer there is nothing to send, do not wait for a blocked write here.
+            if(writeBuffer != null) {
+                synchronized(lock) {
+                    flushWriteBuffer();
+                }
+            }
+        }finally {
+            if(isBlocking == true) {
+                scm.unblockBlockingIOOperation(context);
+                // if there was a blocked write operation, it will hold this lock. when it gets unblocked
+                // it will release this lock and therefore this close method will acquire this lock.
+                // once the lock is acquired it is safe to destroy context.
+                synchronized(lock) {
+                    scm.destroyBlockingIOContext(context);
+                }
             }
+            isOpened = false;
+            portHandleInfo.setSerialComOutByteStream(null);
         }
-        isOpened = false;
-        portHandleInfo.setSerialComOutByteStream(null);
     }
 }
@@ -0,0 +1,144 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial;
+
+import java.util.Arrays;
+
+import com.serialpundit.core.SerialComException;
+
+/**
+ * <p>Represents a set of handles which is polled repeatedly for presence of data. Unlike 
+ * SerialComManager.waitForReadable(long[], int), result arrays are allocated only when handles are 
+ * added or removed, so a polling loop does not allocate result arrays per cycle. Each poll still scans 
+ * every handle, see SerialComManager.waitForReadable(long[], int, long[], int[]) for the cost of a poll.</p>
+ * 
+ * <p>Typical use is :<br>
+ * int n = pollSet.poll(100);<br>
+ * for(int x=0; x &lt; n; x++) { data = scm.readBytes(pollSet.getReadyHandle(x)); }</p>
+ * 
+ * <p>A poll set is not thread safe, it is expected to be used by a single polling thread.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComPollSet {
+
+    private final SerialComManager scm;
+    private long[] handles = new long[0];
+    private long[] readyHandles = new long[0];
+    private int[] readyByteCounts = new int[0];
+    private int numReady;
+
+    /**
+     * <p>Allocates a new SerialComPollSet object. Applications should use 
+     * SerialComManager.createPollSet() method.</p>
+     * 
+     * @param scm instance of SerialComManager class with which this poll set will associate itself.
+     */
+    public SerialComPollSet(SerialComManager scm) {
+        this.scm = scm;
+    }
+
+    private void resize(int size) {
+        handles = Arrays.copyOf(handles, size);
+        readyHandles = new long[size];
+        readyByteCounts = new int[size];
+        numReady = 0;
+    }
+
+    /**
+     * <p>Adds given handle to this poll set.</p>
+     * 
+     * @param handle handle of the opened port.
+     * @return true if handle was added, false if it was already in this poll set.
+     */
+    public boolean add(long handle) {
+        for(int x=0; x < handles.length; x++) {
+            if(handles[x] == handle) {
+                return false;
+            }
+        }
+        resize(handles.length + 1);
+        handles[handles.length - 1] = handle;
+        return true;
+    }
+
+    /**
+     * <p>Removes given handle from this poll set. This must be done before closing the port.</p>
+     * 
+     * @param handle handle of the port.
+     * @return true if handle was removed, false if it was not in this poll set.
+     */
+    public boolean remove(long handle) {
+        for(int x=0; x < handles.length; x++) {
+            if(handles[x] == handle) {
+                handles[x] = handles[handles.length - 1];
+                resize(handles.length - 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * <p>Gives number of handles in this poll set.</p>
+     * 
+     * @return number of handles.
+     */
+    public int size() {
+        return handles.length;
+    }
+
+    /**
+     * <p>Waits until at least one handle in this poll set has data or timeout elapses. Ready handles can 
+     * then be found using getReadyHandle() and getReadyByteCount() methods.</p>
+     * 
+     * @param timeout maximum time to wait in milliseconds, 0 to check once and return immediately or 
+     *         negative to wait until a handle has data.
+     * @return number of handles having data, 0 if timeout elapsed or waiting thread was interrupted.
+     * @throws SerialComException if a handle is no longer valid or byte count can not be determined.
+     */
+    public int poll(int timeout) throws SerialComException {
+        numReady = 0;
+        numReady = scm.waitForReadable(handles, timeout, readyHandles, readyByteCounts);
+        return numReady;
+    }
+
+    /**
+     * <p>Gives handle having data found by last call to poll().</p>
+     * 
+     * @param index index of ready handle, 0 to one less than value returned by poll().
+     * @return handle having data.
+     * @throws IndexOutOfBoundsException if index is not valid.
+     */
+    public long getReadyHandle(int index) {
+        if((index < 0) || (index >= numReady)) {
+            throw new IndexOutOfBoundsException("Argument index is not valid !");
+        }
+        return readyHandles[index];
+    }
+
+    /**
+     * <p>Gives number of bytes available for a handle found by last call to poll().</p>
+     * 
+     * @param index index of ready handle, 0 to one less than value returned by poll().
+     * @return number of bytes in input buffer of handle at the time of poll.
+     * @throws IndexOutOfBoundsException if index is not valid.
+     */
+    public int getReadyByteCount(int index) {
+        if((index < 0) || (index >= numReady)) {
+            throw new IndexOutOfBoundsException("Argument index is not valid !");
+        }
+        return readyByteCounts[index];
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.frame;
+
+/**
+ * <p>The interface ISerialComFrameListener should be implemented by class who wish to receive 
+ * complete frames decoded from the data received from serial port.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public interface ISerialComFrameListener {
+
+    /**
+     * <p>This method is called whenever a complete frame has been decoded.</p>
+     * 
+     * <p>The frame is given as a part of an array owned by decoder or SDK, which is re-used after this 
+     * method returns. Application should copy the bytes if it needs them after returning from this method.</p>
+     * 
+     * @param buffer array containing frame.
+     * @param offset index in buffer at which frame starts.
+     * @param length number of bytes in frame.
+     */
+    public abstract void onNewSerialFrame(byte[] buffer, int offset, int length);
+
+    /**
+     * <p>This method is called whenever an error occurred in the data listener mechanism.</p>
+     * 
+     * @param errorNum operating system specific error number.
+     */
+    public abstract void onDataListenerError(int errorNum);
+}
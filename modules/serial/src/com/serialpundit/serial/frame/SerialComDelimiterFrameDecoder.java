@@ -0,0 +1,125 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.frame;
+
+/**
+ * <p>Splits received bytes in frames terminated by a delimiter, for example a line ending "\r\n" or 
+ * a single byte like 0x7E. Delimiter can be kept in or removed from the frame given to listener.</p>
+ * 
+ * <p>If no delimiter is found within maxFrameLength bytes, bytes are discarded till the next delimiter, 
+ * so that the next frame delivered is a complete frame.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComDelimiterFrameDecoder extends SerialComFrameDecoder {
+
+    private final byte[] mDelimiter;
+    private final boolean mStripDelimiter;
+    private boolean mSkipToDelimiter;
+    private int mSearchOffset;
+
+    /**
+     * <p>Allocates a new SerialComDelimiterFrameDecoder object.</p>
+     * 
+     * @param delimiter one or more bytes marking end of frame.
+     * @param stripDelimiter true if delimiter should not be included in the frame given to listener.
+     * @param maxFrameLength maximum length of a frame including delimiter.
+     * @throws IllegalArgumentException if delimiter is null or empty, or maxFrameLength is less than 
+     *         length of delimiter.
+     */
+    public SerialComDelimiterFrameDecoder(byte[] delimiter, boolean stripDelimiter, int maxFrameLength) {
+        super(maxFrameLength);
+        if((delimiter == null) || (delimiter.length == 0)) {
+            throw new IllegalArgumentException("Argument delimiter can not be null or empty !");
+        }
+        if(maxFrameLength < delimiter.length) {
+            throw new IllegalArgumentException("Argument maxFrameLength can not be less than length of delimiter !");
+        }
+        mDelimiter = delimiter.clone();
+        mStripDelimiter = stripDelimiter;
+        mSkipToDelimiter = false;
+        mSearchOffset = 0;
+    }
+
+    @Override
+    protected int decodeFrames(byte[] buffer, int offset, int length, ISerialComFrameListener listener) {
+        int end = offset + length;
+        int last = end - mDelimiter.length;
+        int frameStart = offset;
+        int x = offset;
+
+        // Bytes in accumulator which have already been searched need not be searched again.
+        if(buffer == mAccumulator) {
+            x = offset + mSearchOffset;
+        }
+
+        while(x <= last) {
+            if(isDelimiterAt(buffer, x) == false) {
+                x++;
+                continue;
+            }
+            if(mSkipToDelimiter == true) {
+                super.discard(buffer, frameStart, x + mDelimiter.length - frameStart);
+                mSkipToDelimiter = false;
+            }else if((x + mDelimiter.length - frameStart) > mAccumulator.length) {
+                // Frame found directly in caller's buffer but longer than allowed.
+                super.discard(buffer, frameStart, x + mDelimiter.length - frameStart);
+            }else if(mStripDelimiter == true) {
+                listener.onNewSerialFrame(buffer, frameStart, x - frameStart);
+            }else {
+                listener.onNewSerialFrame(buffer, frameStart, x + mDelimiter.length - frameStart);
+            }
+            x = x + mDelimiter.length;
+            frameStart = x;
+        }
+
+        if(mSkipToDelimiter == true) {
+            // Keep only the bytes which may be beginning of delimiter.
+            int drop = (end - frameStart) - Math.min(end - frameStart, mDelimiter.length - 1);
+            if(drop > 0) {
+                super.discard(buffer, frameStart, drop);
+                frameStart = frameStart + drop;
+            }
+        }
+
+        mSearchOffset = Math.max(0, (end - frameStart) - (mDelimiter.length - 1));
+        return frameStart - offset;
+    }
+
+    private boolean isDelimiterAt(byte[] buffer, int index) {
+        if(buffer[index] != mDelimiter[0]) {
+            return false;
+        }
+        for(int x = 1; x < mDelimiter.length; x++) {
+            if(buffer[index + x] != mDelimiter[x]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    @Override
+    protected void discard(byte[] buffer, int offset, int length) {
+        super.discard(buffer, offset, length);
+        mSkipToDelimiter = true;
+        mSearchOffset = 0;
+    }
+
+    @Override
+    public void reset() {
+        super.reset();
+        mSkipToDelimiter = false;
+        mSearchOffset = 0;
+    }
+}
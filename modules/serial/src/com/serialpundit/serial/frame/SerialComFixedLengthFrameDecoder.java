@@ -0,0 +1,46 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.frame;
+
+/**
+ * <p>Splits received bytes in frames of same fixed length.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComFixedLengthFrameDecoder extends SerialComFrameDecoder {
+
+    private final int mFrameLength;
+
+    /**
+     * <p>Allocates a new SerialComFixedLengthFrameDecoder object.</p>
+     * 
+     * @param frameLength number of bytes in every frame.
+     * @throws IllegalArgumentException if frameLength is zero or negative.
+     */
+    public SerialComFixedLengthFrameDecoder(int frameLength) {
+        super(frameLength);
+        mFrameLength = frameLength;
+    }
+
+    @Override
+    protected int decodeFrames(byte[] buffer, int offset, int length, ISerialComFrameListener listener) {
+        int end = offset + length;
+        int x = offset;
+        while((end - x) >= mFrameLength) {
+            listener.onNewSerialFrame(buffer, x, mFrameLength);
+            x = x + mFrameLength;
+        }
+        return x - offset;
+    }
+}
@@ -0,0 +1,149 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.frame;
+
+/**
+ * <p>Base class for frame decoders. Bytes are given to decode() as they arrive, chunk by chunk, and 
+ * decoder calls listener for every complete frame found.</p>
+ * 
+ * <p>Frames lying completely in a received chunk are given to listener directly from that chunk without 
+ * copying. Only a partial frame at the end of a chunk is copied in an internal accumulator of size 
+ * maxFrameLength, and rest of the frame is assembled there as subsequent chunks arrive. If no valid frame 
+ * can be found in maxFrameLength bytes, accumulated bytes are discarded to resynchronize with the stream.</p>
+ * 
+ * <p>A decoder keeps state of partially received frame, so one instance must be used with only one port. 
+ * It is not thread safe, data listener of a port is never called concurrently so this is not an issue when 
+ * used through SerialComFrameDecodingListener.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public abstract class SerialComFrameDecoder {
+
+    protected final byte[] mAccumulator;
+    protected int mAccumulatedLength;
+    private long mDiscardedBytes;
+
+    /**
+     * <p>Allocates a new SerialComFrameDecoder object.</p>
+     * 
+     * @param maxFrameLength maximum length of a frame in bytes.
+     * @throws IllegalArgumentException if maxFrameLength is zero or negative.
+     */
+    protected SerialComFrameDecoder(int maxFrameLength) {
+        if(maxFrameLength <= 0) {
+            throw new IllegalArgumentException("Argument maxFrameLength can not be negative or zero !");
+        }
+        mAccumulator = new byte[maxFrameLength];
+        mAccumulatedLength = 0;
+        mDiscardedBytes = 0;
+    }
+
+    /**
+     * <p>Finds complete frames in buffer starting at offset and calls listener for each of them. Returns 
+     * number of bytes consumed i.e. bytes of frames delivered plus bytes skipped as invalid. Bytes not 
+     * consumed must be the beginning of a frame that is not yet completely received.</p>
+     * 
+     * @param buffer array containing received bytes.
+     * @param offset index in buffer from where decoding should start.
+     * @param length number of bytes to decode.
+     * @param listener listener to which frames will be delivered.
+     * @return number of bytes consumed.
+     */
+    protected abstract int decodeFrames(byte[] buffer, int offset, int length, ISerialComFrameListener listener);
+
+    /**
+     * <p>Decodes the given bytes received from serial port, delivering every complete frame to the listener.</p>
+     * 
+     * @param data array containing received bytes.
+     * @param offset index in data from where bytes start.
+     * @param length number of bytes received.
+     * @param listener listener to which frames will be delivered.
+     */
+    public void decode(byte[] data, int offset, int length, ISerialComFrameListener listener) {
+        int end = offset + length;
+        int consumed = 0;
+
+        while(offset < end) {
+            if(mAccumulatedLength == 0) {
+                // Nothing pending, frames are given directly from caller's buffer.
+                consumed = decodeFrames(data, offset, end - offset, listener);
+                offset = offset + consumed;
+                int remaining = end - offset;
+                if(remaining > mAccumulator.length) {
+                    discard(data, offset, remaining - mAccumulator.length);
+                    offset = end - mAccumulator.length;
+                    remaining = mAccumulator.length;
+                }
+                System.arraycopy(data, offset, mAccumulator, 0, remaining);
+                mAccumulatedLength = remaining;
+                return;
+            }
+
+            int count = Math.min(end - offset, mAccumulator.length - mAccumulatedLength);
+            if(count == 0) {
+                // Accumulator is full but does not begin with a valid frame, drop it and resynchronize.
+                discard(mAccumulator, 0, mAccumulatedLength);
+                mAccumulatedLength = 0;
+                continue;
+            }
+            System.arraycopy(data, offset, mAccumulator, mAccumulatedLength, count);
+            mAccumulatedLength = mAccumulatedLength + count;
+            offset = offset + count;
+
+            consumed = decodeFrames(mAccumulator, 0, mAccumulatedLength, listener);
+            if(consumed > 0) {
+                mAccumulatedLength = mAccumulatedLength - consumed;
+                System.arraycopy(mAccumulator, consumed, mAccumulator, 0, mAccumulatedLength);
+            }
+        }
+    }
+
+    /**
+     * <p>Called when bytes are dropped because they do not form a valid frame within maxFrameLength. 
+     * Sub classes may override to reset their state, they must call this implementation.</p>
+     * 
+     * @param buffer array containing bytes being discarded.
+     * @param offset index of first discarded byte.
+     * @param length number of bytes discarded.
+     */
+    protected void discard(byte[] buffer, int offset, int length) {
+        mDiscardedBytes = mDiscardedBytes + length;
+    }
+
+    /**
+     * <p>Discards partially received frame if any. Should be called when stream is restarted, for example 
+     * after re-opening port.</p>
+     */
+    public void reset() {
+        mAccumulatedLength = 0;
+    }
+
+    /**
+     * <p>Gives number of bytes discarded so far because they did not form a valid frame.</p>
+     * 
+     * @return number of discarded bytes.
+     */
+    public long getDiscardedBytes() {
+        return mDiscardedBytes;
+    }
+
+    /**
+     * <p>Gives number of bytes of a partially received frame waiting for rest of its bytes.</p>
+     * 
+     * @return number of pending bytes.
+     */
+    public int getPendingBytes() {
+        return mAccumulatedLength;
+    }
+}
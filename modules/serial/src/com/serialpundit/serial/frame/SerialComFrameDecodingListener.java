@@ -0,0 +1,158 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.frame;
+
+import java.util.concurrent.ScheduledFuture;
+import java.util.concurrent.ScheduledThreadPoolExecutor;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.TimeUnit;
+
+import com.serialpundit.serial.ISerialComLeasedDataListener;
+import com.serialpundit.serial.SerialComLeasedBuffer;
+
+/**
+ * <p>Data listener which passes received data through a frame decoder and delivers complete frames to 
+ * the given frame listener. It is registered with SerialComManager.registerDataListener() like any other 
+ * data listener.</p>
+ * 
+ * <p>Being a leased data listener, decoding is done directly on the pooled receive buffer which is 
+ * released as soon as decoding is over. Frames completely inside a buffer reach application without 
+ * being copied.</p>
+ * 
+ * <p>With SerialComGapFrameDecoder, the frame received last is delivered by a timer thread once line has 
+ * been idle for the gap, all other frames are delivered by the data listener's delivery thread. Decoding 
+ * and idle flushing are done under the same lock, so frame listener is never called concurrently.</p>
+ * 
+ * <pre>
+ * SerialComFrameDecodingListener listener = new SerialComFrameDecodingListener(
+ *         new SerialComDelimiterFrameDecoder(new byte[] {'\r', '\n'}, true, 512), frameListener);
+ * scm.registerDataListener(handle, listener);
+ * </pre>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComFrameDecodingListener implements ISerialComLeasedDataListener {
+
+    // Shared by all the listeners using gap decoder; delivers last frame when line becomes idle.
+    private static final ScheduledThreadPoolExecutor idleTimer = createIdleTimer();
+
+    private final SerialComFrameDecoder mDecoder;
+    private final ISerialComFrameListener mFrameListener;
+    private final SerialComGapFrameDecoder mGapDecoder;
+    private final Object lock = new Object();
+    private ScheduledFuture<?> mIdleFlush;
+
+    private final Runnable mIdleFlushTask = new Runnable() {
+        @Override
+        public void run() {
+            synchronized(lock) {
+                mIdleFlush = null;
+                if(mGapDecoder.flushIfIdle(System.nanoTime(), mFrameListener) == false) {
+                    // more data arrived meanwhile, wait for line to become idle again.
+                    armIdleFlush();
+                }
+            }
+        }
+    };
+
+    private static ScheduledThreadPoolExecutor createIdleTimer() {
+        ScheduledThreadPoolExecutor timer = new ScheduledThreadPoolExecutor(1, new ThreadFactory() {
+            @Override
+            public Thread newThread(Runnable r) {
+                Thread t = new Thread(r, "SerialPundit frame idle timer");
+                t.setDaemon(true);
+                return t;
+            }
+        });
+        timer.setRemoveOnCancelPolicy(true);
+        return timer;
+    }
+
+    /**
+     * <p>Allocates a new SerialComFrameDecodingListener object.</p>
+     * 
+     * @param decoder frame decoder to be used, must not be shared with other ports.
+     * @param frameListener listener to which decoded frames will be delivered.
+     * @throws IllegalArgumentException if decoder or frameListener is null.
+     */
+    public SerialComFrameDecodingListener(SerialComFrameDecoder decoder, ISerialComFrameListener frameListener) {
+        if(decoder == null) {
+            throw new IllegalArgumentException("Argument decoder can not be null !");
+        }
+        if(frameListener == null) {
+            throw new IllegalArgumentException("Argument frameListener can not be null !");
+        }
+        mDecoder = decoder;
+        mFrameListener = frameListener;
+        if(decoder instanceof SerialComGapFrameDecoder) {
+            mGapDecoder = (SerialComGapFrameDecoder) decoder;
+        }else {
+            mGapDecoder = null;
+        }
+    }
+
+    /*
+     * Schedules delivery of pending bytes at the time line becomes idle, if not scheduled already. 
+     * Caller must hold lock.
+     */
+    private void armIdleFlush() {
+        if((mIdleFlush != null) || (mGapDecoder.getPendingBytes() == 0)) {
+            return;
+        }
+        long delay = mGapDecoder.getIdleDeadline() - System.nanoTime();
+        mIdleFlush = idleTimer.schedule(mIdleFlushTask, (delay > 0) ? delay : 0, TimeUnit.NANOSECONDS);
+    }
+
+    /**
+     * <p>Gives the frame decoder used by this listener.</p>
+     * 
+     * @return frame decoder.
+     */
+    public SerialComFrameDecoder getDecoder() {
+        return mDecoder;
+    }
+
+    @Override
+    public void onNewSerialDataLeased(SerialComLeasedBuffer buffer) {
+        try {
+            synchronized(lock) {
+                if(mGapDecoder != null) {
+                    // Gap detection needs arrival time, not delivery time.
+                    long arrival = (buffer.getTimestamp() != 0) ? buffer.getTimestamp() : System.nanoTime();
+                    mGapDecoder.decode(buffer.array(), 0, buffer.length(), arrival, mFrameListener);
+                    armIdleFlush();
+                }else {
+                    mDecoder.decode(buffer.array(), 0, buffer.length(), mFrameListener);
+                }
+            }
+        } finally {
+            buffer.release();
+        }
+    }
+
+    @Override
+    public void onNewSerialDataAvailable(byte[] data) {
+        synchronized(lock) {
+            mDecoder.decode(data, 0, data.length, mFrameListener);
+            if(mGapDecoder != null) {
+                armIdleFlush();
+            }
+        }
+    }
+
+    @Override
+    public void onDataListenerError(int errorNum) {
+        mFrameListener.onDataListenerError(errorNum);
+    }
+}
@@ -0,0 +1,215 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.frame;
+
+/**
+ * <p>Splits received bytes in frames separated by silence on line, as used by Modbus RTU where a frame 
+ * ends when no character is received for 3.5 character times.</p>
+ * 
+ * <p>A frame is known to be complete only when the next chunk of data arrives after the gap or when 
+ * application finds line idle. Therefore the frame received last is delivered when next chunk arrives or 
+ * when flush()/flushIfIdle() is called. SerialComFrameDecodingListener calls flushIfIdle() from a timer 
+ * once line has been idle for the gap, so the last frame (for example a Modbus reply) is not held back.</p>
+ * 
+ * <p>Arrival time of a chunk is the arrival time of its last byte. Gap is therefore measured from the last 
+ * byte of previous chunk to the estimated arrival time of first byte of new chunk, which is arrival time 
+ * minus (length - 1) character times. This keeps a frame whose bytes were read in several back to back 
+ * chunks in one piece.</p>
+ * 
+ * <p>If a frame grows longer than maxFrameLength, all its bytes are discarded till the next gap, so that 
+ * its tail is not delivered as a frame.</p>
+ * 
+ * <p>By default time of decode() call is taken as arrival time. If actual arrival time of chunk is known, 
+ * decode(byte[], int, int, long, ISerialComFrameListener) should be used for better accuracy. When used 
+ * through SerialComFrameDecodingListener, arrival time recorded by the SDK is used automatically.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComGapFrameDecoder extends SerialComFrameDecoder {
+
+    private final long mMinGapNanos;
+    private final long mCharTimeNanos;
+    private long mLastArrivalNanos;
+    private boolean mOverflow;
+
+    /**
+     * <p>Allocates a new SerialComGapFrameDecoder object. Character time is taken as minGapNanos / 3.5, as 
+     * for Modbus RTU.</p>
+     * 
+     * @param maxFrameLength maximum length of a frame (256 for Modbus RTU).
+     * @param minGapNanos minimum silence in nanoseconds which marks end of frame.
+     * @throws IllegalArgumentException if maxFrameLength or minGapNanos is zero or negative.
+     */
+    public SerialComGapFrameDecoder(int maxFrameLength, long minGapNanos) {
+        this(maxFrameLength, minGapNanos, (minGapNanos * 2) / 7);
+    }
+
+    /**
+     * <p>Allocates a new SerialComGapFrameDecoder object with explicit character time. This should be used 
+     * when gap is not 3.5 character times, for example Modbus RTU above 19200 baud where gap is fixed.</p>
+     * 
+     * @param maxFrameLength maximum length of a frame (256 for Modbus RTU).
+     * @param minGapNanos minimum silence in nanoseconds which marks end of frame.
+     * @param charTimeNanos time taken to transmit one character in nanoseconds.
+     * @throws IllegalArgumentException if maxFrameLength or minGapNanos is zero or negative, or 
+     *         charTimeNanos is negative.
+     */
+    public SerialComGapFrameDecoder(int maxFrameLength, long minGapNanos, long charTimeNanos) {
+        super(maxFrameLength);
+        if(minGapNanos <= 0) {
+            throw new IllegalArgumentException("Argument minGapNanos can not be negative or zero !");
+        }
+        if(charTimeNanos < 0) {
+            throw new IllegalArgumentException("Argument charTimeNanos can not be negative !");
+        }
+        mMinGapNanos = minGapNanos;
+        mCharTimeNanos = charTimeNanos;
+        mLastArrivalNanos = 0;
+        mOverflow = false;
+    }
+
+    /**
+     * <p>Gives time taken to transmit one Modbus RTU character (11 bits) at the given baud rate.</p>
+     * 
+     * @param baudRate baud rate in bits per second.
+     * @return character time in nanoseconds.
+     * @throws IllegalArgumentException if baudRate is zero or negative.
+     */
+    public static long getModbusRTUCharacterTime(int baudRate) {
+        if(baudRate <= 0) {
+            throw new IllegalArgumentException("Argument baudRate can not be negative or zero !");
+        }
+        return (11L * 1000000000L) / baudRate;
+    }
+
+    /**
+     * <p>Gives inter frame gap (3.5 character times) for Modbus RTU at the given baud rate. Each character 
+     * is 11 bits long. For baud rates above 19200, fixed value of 1750 microseconds is used as recommended 
+     * by Modbus specification.</p>
+     * 
+     * @param baudRate baud rate in bits per second.
+     * @return gap in nanoseconds.
+     * @throws IllegalArgumentException if baudRate is zero or negative.
+     */
+    public static long getModbusRTUFrameGap(int baudRate) {
+        if(baudRate <= 0) {
+            throw new IllegalArgumentException("Argument baudRate can not be negative or zero !");
+        }
+        if(baudRate > 19200) {
+            return 1750000L;
+        }
+        return (35L * 11L * 1000000000L) / (10L * baudRate);
+    }
+
+    @Override
+    protected int decodeFrames(byte[] buffer, int offset, int length, ISerialComFrameListener listener) {
+        // Frame boundaries are decided by time, not by content.
+        return 0;
+    }
+
+    @Override
+    public void decode(byte[] data, int offset, int length, ISerialComFrameListener listener) {
+        decode(data, offset, length, System.nanoTime(), listener);
+    }
+
+    /**
+     * <p>Decodes the given bytes which arrived at the given time.</p>
+     * 
+     * @param data array containing received bytes.
+     * @param offset index in data from where bytes start.
+     * @param length number of bytes received.
+     * @param arrivalNanos time of arrival of these bytes as given by System.nanoTime().
+     * @param listener listener to which frames will be delivered.
+     */
+    public void decode(byte[] data, int offset, int length, long arrivalNanos, ISerialComFrameListener listener) {
+        if((mAccumulatedLength > 0) || (mOverflow == true)) {
+            long firstByteNanos = arrivalNanos - ((length > 1) ? ((length - 1) * mCharTimeNanos) : 0);
+            if((firstByteNanos - mLastArrivalNanos) >= mMinGapNanos) {
+                flush(listener);
+                mOverflow = false;
+            }
+        }
+
+        int end = offset + length;
+        while(offset < end) {
+            if(mOverflow == true) {
+                // Rest of a frame longer than allowed, drop it till the next gap.
+                discard(data, offset, end - offset);
+                break;
+            }
+            int count = Math.min(end - offset, mAccumulator.length - mAccumulatedLength);
+            if(count == 0) {
+                // Frame longer than allowed, drop it.
+                discard(mAccumulator, 0, mAccumulatedLength);
+                mAccumulatedLength = 0;
+                mOverflow = true;
+                continue;
+            }
+            System.arraycopy(data, offset, mAccumulator, mAccumulatedLength, count);
+            mAccumulatedLength = mAccumulatedLength + count;
+            offset = offset + count;
+        }
+
+        mLastArrivalNanos = arrivalNanos;
+    }
+
+    /**
+     * <p>Gives the time at which the bytes received so far become a complete frame if nothing more arrives, 
+     * i.e. arrival time of last byte plus minimum gap.</p>
+     * 
+     * @return time as given by System.nanoTime().
+     */
+    public long getIdleDeadline() {
+        return mLastArrivalNanos + mMinGapNanos;
+    }
+
+    /**
+     * <p>Delivers the bytes received so far as a frame, if line has been idle for at least the minimum gap.</p>
+     * 
+     * @param nowNanos current time as given by System.nanoTime().
+     * @param listener listener to which frame will be delivered.
+     * @return true if a frame was delivered.
+     */
+    public boolean flushIfIdle(long nowNanos, ISerialComFrameListener listener) {
+        if((nowNanos - mLastArrivalNanos) >= mMinGapNanos) {
+            mOverflow = false;
+            if(mAccumulatedLength > 0) {
+                return flush(listener);
+            }
+        }
+        return false;
+    }
+
+    /**
+     * <p>Delivers the bytes received so far as a frame.</p>
+     * 
+     * @param listener listener to which frame will be delivered.
+     * @return true if a frame was delivered, false if there was nothing to deliver.
+     */
+    public boolean flush(ISerialComFrameListener listener) {
+        if(mAccumulatedLength == 0) {
+            return false;
+        }
+        int length = mAccumulatedLength;
+        mAccumulatedLength = 0;
+        listener.onNewSerialFrame(mAccumulator, 0, length);
+        return true;
+    }
+
+    @Override
+    public void reset() {
+        super.reset();
+        mOverflow = false;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.frame;
+
+/**
+ * <p>Splits received bytes in frames whose length is given by a length field in the frame header.</p>
+ * 
+ * <p>Total length of a frame is calculated as : lengthFieldOffset + lengthFieldSize + value of length 
+ * field + lengthAdjustment. For example, for a frame [SOF][LEN][payload of LEN bytes][CRC16] use 
+ * lengthFieldOffset 1, lengthFieldSize 1 and lengthAdjustment 2.</p>
+ * 
+ * <p>If calculated length is more than maxFrameLength or less than header length, the first byte is 
+ * discarded and decoder tries to find a valid header starting from the next byte.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComLengthFieldFrameDecoder extends SerialComFrameDecoder {
+
+    private final int mLengthFieldOffset;
+    private final int mLengthFieldSize;
+    private final boolean mBigEndian;
+    private final int mLengthAdjustment;
+    private final int mHeaderLength;
+
+    /**
+     * <p>Allocates a new SerialComLengthFieldFrameDecoder object.</p>
+     * 
+     * @param maxFrameLength maximum length of a frame including header.
+     * @param lengthFieldOffset index of length field from the start of frame.
+     * @param lengthFieldSize number of bytes in length field (1, 2, 3 or 4).
+     * @param bigEndian true if most significant byte of length field comes first.
+     * @param lengthAdjustment number of bytes to be added to the value of length field to get number of 
+     *         bytes following length field (may be negative if length field includes header).
+     * @throws IllegalArgumentException if lengthFieldSize is not 1 to 4, lengthFieldOffset is negative or 
+     *         header does not fit in maxFrameLength.
+     */
+    public SerialComLengthFieldFrameDecoder(int maxFrameLength, int lengthFieldOffset, int lengthFieldSize, 
+            boolean bigEndian, int lengthAdjustment) {
+        super(maxFrameLength);
+        if((lengthFieldSize < 1) || (lengthFieldSize > 4)) {
+            throw new IllegalArgumentException("Argument lengthFieldSize must be 1, 2, 3 or 4 !");
+        }
+        if(lengthFieldOffset < 0) {
+            throw new IllegalArgumentException("Argument lengthFieldOffset can not be negative !");
+        }
+        if((lengthFieldOffset + lengthFieldSize) > maxFrameLength) {
+            throw new IllegalArgumentException("Argument maxFrameLength is less than length of header !");
+        }
+        mLengthFieldOffset = lengthFieldOffset;
+        mLengthFieldSize = lengthFieldSize;
+        mBigEndian = bigEndian;
+        mLengthAdjustment = lengthAdjustment;
+        mHeaderLength = lengthFieldOffset + lengthFieldSize;
+    }
+
+    @Override
+    protected int decodeFrames(byte[] buffer, int offset, int length, ISerialComFrameListener listener) {
+        int end = offset + length;
+        int x = offset;
+
+        while((end - x) >= mHeaderLength) {
+            long frameLength = mHeaderLength + getLengthFieldValue(buffer, x + mLengthFieldOffset) + mLengthAdjustment;
+            if((frameLength < mHeaderLength) || (frameLength > mAccumulator.length)) {
+                // Not a valid header, resynchronize from next byte.
+                super.discard(buffer, x, 1);
+                x++;
+                continue;
+            }
+            if((end - x) < frameLength) {
+                break;
+            }
+            listener.onNewSerialFrame(buffer, x, (int) frameLength);
+            x = x + (int) frameLength;
+        }
+
+        return x - offset;
+    }
+
+    private long getLengthFieldValue(byte[] buffer, int index) {
+        long value = 0;
+        if(mBigEndian == true) {
+            for(int x = 0; x < mLengthFieldSize; x++) {
+                value = (value << 8) | (buffer[index + x] & 0xFF);
+            }
+        }else {
+            for(int x = mLengthFieldSize - 1; x >= 0; x--) {
+                value = (value << 8) | (buffer[index + x] & 0xFF);
+            }
+        }
+        return value;
+    }
+}
@@ -26,7 +26,7 @@ import java.util.concurrent.Executors;
 import java.util.concurrent.Future;
 import java.util.concurrent.TimeUnit;
 
-import com.serialpundit.core.util.RingArrayBlockingQueue;
+import com.serialpundit.core.util.SPSCRingArrayBlockingQueue;
 import com.serialpundit.core.util.SerialComCRCUtil;
 import com.serialpundit.core.SerialComPlatform;
 import com.serialpundit.core.SerialComTimeOutException;
@@ -109,10 +109,10 @@ public final class SerialComYModemG {
     private class DataCollector implements Callable<Object> {
 
         private DataProcessor dataProcessor;
-        private final RingArrayBlockingQueue<byte[]> dataQueue;
+        private final SPSCRingArrayBlockingQueue<byte[]> dataQueue;
         private volatile boolean exitThread = false;
 
-        public DataCollector(RingArrayBlockingQueue<byte[]> dataQueue) {
+        public DataCollector(SPSCRingArrayBlockingQueue<byte[]> dataQueue) {
             this.dataQueue = dataQueue;
         }
 
@@ -167,11 +167,11 @@ public final class SerialComYModemG {
     private class DataProcessor implements Callable<Object> {
 
         private DataCollector dataCollector;
-        private final RingArrayBlockingQueue<byte[]> dataQueue;
+        private final SPSCRingArrayBlockingQueue<byte[]> dataQueue;
         private final String receiverDirAbsolutePath = filesToReceive.getAbsolutePath();
         private volatile boolean exitThread = false;
 
-        public DataProcessor(RingArrayBlockingQueue<byte[]> dataQueue) {
+        public DataProcessor(SPSCRingArrayBlockingQueue<byte[]> dataQueue) {
             this.dataQueue = dataQueue;
         }
 
@@ -760,7 +760,7 @@ public final class SerialComYModemG {
      */
     public boolean receiveFileY() throws IOException {
 
-        final RingArrayBlockingQueue<byte[]> dataQueue = new RingArrayBlockingQueue<byte[]>(1024);
+        final SPSCRingArrayBlockingQueue<byte[]> dataQueue = new SPSCRingArrayBlockingQueue<byte[]>(1024);
         final ExecutorService threadpool = Executors.newFixedThreadPool(2);
 
         final DataCollector taskDataCollection = new DataCollector(dataQueue);
@@ -0,0 +1,100 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.internal;
+
+import java.util.concurrent.ArrayBlockingQueue;
+
+import com.serialpundit.serial.SerialComLeasedBuffer;
+
+/**
+ * <p>Pool of fixed size receive buffers for a port. Data given by native layer is copied in a leased 
+ * buffer (and batches are merged in one) by the looper, handed to the listener and the buffer comes back 
+ * here when listener releases it. Free buffers are kept in a preallocated array backed queue, so leasing 
+ * and recycling do not allocate anything. As long as buffers are released at the rate they are leased, 
+ * memory held by listener is re-used rather than allocated for every chunk.</p>
+ * 
+ * <p>If a larger buffer than the pool's buffer size is requested, a buffer which is not pooled is given. 
+ * At the most maxPooled free buffers are retained, extra released buffers are left for garbage collector.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComBufferPool {
+
+    private final int mBufferSize;
+    private final ArrayBlockingQueue<SerialComLeasedBuffer> mFreeBuffers;
+
+    /**
+     * <p>Allocates a new SerialComBufferPool object.</p>
+     * 
+     * @param bufferSize size of each pooled buffer in bytes.
+     * @param maxPooled maximum number of free buffers retained in pool.
+     */
+    public SerialComBufferPool(int bufferSize, int maxPooled) {
+        mBufferSize = bufferSize;
+        mFreeBuffers = new ArrayBlockingQueue<SerialComLeasedBuffer>(maxPooled);
+    }
+
+    /**
+     * <p>Gives a buffer which can hold at least minLength bytes.</p>
+     * 
+     * @param minLength number of bytes caller intends to put in buffer.
+     * @return leased buffer.
+     */
+    public SerialComLeasedBuffer lease(int minLength) {
+        if(minLength > mBufferSize) {
+            return new SerialComLeasedBuffer(new byte[minLength], null);
+        }
+
+        SerialComLeasedBuffer buffer = mFreeBuffers.poll();
+        if(buffer == null) {
+            return new SerialComLeasedBuffer(new byte[mBufferSize], this);
+        }
+        buffer.acquire();
+        return buffer;
+    }
+
+    /**
+     * <p>Gives a buffer containing copy of the given bytes.</p>
+     * 
+     * @param data bytes to be copied.
+     * @param offset index in data from where copying starts.
+     * @param length number of bytes to copy.
+     * @return leased buffer.
+     */
+    public SerialComLeasedBuffer lease(byte[] data, int offset, int length) {
+        SerialComLeasedBuffer buffer = lease(length);
+        System.arraycopy(data, offset, buffer.array(), 0, length);
+        buffer.setLength(length);
+        return buffer;
+    }
+
+    /**
+     * <p>Puts a released buffer back in pool. Called from SerialComLeasedBuffer.release().</p>
+     * 
+     * @param buffer buffer being returned.
+     */
+    public void recycle(SerialComLeasedBuffer buffer) {
+        // If pool already has maxPooled free buffers, this one is left for garbage collector.
+        mFreeBuffers.offer(buffer);
+    }
+
+    /**
+     * <p>Gives size of buffers kept in this pool.</p>
+     * 
+     * @return size of pooled buffer in bytes.
+     */
+    public int getBufferSize() {
+        return mBufferSize;
+    }
+}
@@ -12,21 +12,22 @@
  */
 package com.serialpundit.serial.internal;
 
-import java.util.Map;
-import java.util.TreeMap;
+import java.util.concurrent.Executor;
 
 import com.serialpundit.core.SerialComException;
 import com.serialpundit.serial.ISerialComDataListener;
 import com.serialpundit.serial.ISerialComEventListener;
+import com.serialpundit.serial.SerialComManager;
 
 /**
  * <p>Represents Proactor in our IO design pattern.</p>
  * 
  * <p>An application may register data listener only, event listener only or both listeners. 
  * A single dedicated looper handles both the listeners. We first check if a looper exist for 
- * given handle or not. If it does not exist we create and start looper thread which loops over 
- * data or event as specified by application. If it exist, we start data or event looper thread 
- * as specified by application.</p>
+ * given handle or not. If it does not exist we create looper which queues data or event as 
+ * specified by application. If it exist, we start data or event looper as specified by application. 
+ * Loopers of all the handles are run by a reactor i.e. a small pool of threads shared by all the 
+ * handles, so no Java thread is created per handle.</p>
  * 
  * <p>An application can have multiple handles for the same port (if there is no exclusive owner 
  * of port).</p>
@@ -39,7 +40,11 @@ import com.serialpundit.serial.ISerialComEventListener;
 public final class SerialComCompletionDispatcher {
 
     private SerialComPortJNIBridge mComPortJNIBridge = null;
-    private TreeMap<Long, SerialComPortHandleInfo> mPortHandleInfo = null;
+    private SerialComPortHandleRegistry mPortHandleInfo = null;
+
+    // Threads delivering data/events to listeners of all handles, unless application has given its own executor.
+    private final SerialComReactor mReactor = new SerialComReactor();
+    private volatile Executor mSharedExecutor = mReactor;
 
     /**
      * <p>Allocates a new SerialComCompletionDispatcher object.</p>
@@ -47,21 +52,39 @@ public final class SerialComCompletionDispatcher {
      * @param mComPortJNIBridge interface used to invoke appropriate native function
      * @param portHandleInfo reference to portHandleInfo object to get/set information about handle/port
      */
-    public SerialComCompletionDispatcher(SerialComPortJNIBridge mComPortJNIBridge, TreeMap<Long, SerialComPortHandleInfo> portHandleInfo) {
+    public SerialComCompletionDispatcher(SerialComPortJNIBridge mComPortJNIBridge, SerialComPortHandleRegistry portHandleInfo) {
         this.mComPortJNIBridge = mComPortJNIBridge;
         this.mPortHandleInfo = portHandleInfo;
     }
 
+    /**
+     * <p>Sets executor used for delivering data/events to listeners registered with DISPATCHPOLICY.SHARED 
+     * after this call. Listeners already registered are not affected.</p>
+     * 
+     * @param executor application supplied executor or null to use SDK's own reactor.
+     */
+    public void setSharedExecutor(Executor executor) {
+        if(executor == null) {
+            mSharedExecutor = mReactor;
+        }else {
+            mSharedExecutor = executor;
+        }
+    }
+
     /**
      * <p>This method creates data looper thread and initialize subsystem for data event passing. </p>
      * 
      * @param handle handle of the opened port for which data looper need to be set up.
      * @param mHandleInfo Reference to SerialComPortHandleInfo object associated with given handle.
      * @param dataListener listener for which looper has to be set up.
+     * @param overflowPolicy what to do when data queue is full.
+     * @param queueCapacity maximum number of data chunks in queue.
+     * @param dispatchPolicy which thread delivers data to listener.
      * @return true on success.
      * @throws SerialComException if not able to complete requested operation.
      */
-    public boolean setUpDataLooper(long handle, SerialComPortHandleInfo mHandleInfo, ISerialComDataListener dataListener) throws SerialComException {
+    public boolean setUpDataLooper(long handle, SerialComPortHandleInfo mHandleInfo, ISerialComDataListener dataListener, 
+            SerialComManager.OVERFLOWPOLICY overflowPolicy, int queueCapacity, SerialComManager.DISPATCHPOLICY dispatchPolicy) throws SerialComException {
 
         int ret = 0;
         SerialComLooper looper = mHandleInfo.getLooper();
@@ -73,14 +96,15 @@ public final class SerialComCompletionDispatcher {
         }
 
         // set up queue and start thread first, then set up native thread
-        looper.startDataLooper(handle, dataListener, mHandleInfo.getOpenedPortName());
-        mHandleInfo.setDataListener(dataListener);
+        looper.startDataLooper(handle, dataListener, mHandleInfo.getOpenedPortName(), overflowPolicy, queueCapacity, 
+                dispatchPolicy, mSharedExecutor);
+        mPortHandleInfo.setDataListener(mHandleInfo, dataListener);
 
         try {
             ret = mComPortJNIBridge.setUpDataLooperThread(handle, looper);
             if(ret < 0) {
                 looper.stopDataLooper();
-                mHandleInfo.setDataListener(null);
+                mPortHandleInfo.setDataListener(mHandleInfo, null);
                 if(mHandleInfo.getEventListener() == null) {
                     mHandleInfo.setLooper(null);
                 }
@@ -88,7 +112,7 @@ public final class SerialComCompletionDispatcher {
             }
         }catch (SerialComException e) {
             looper.stopDataLooper();
-            mHandleInfo.setDataListener(null);
+            mPortHandleInfo.setDataListener(mHandleInfo, null);
             if(mHandleInfo.getEventListener() == null) {
                 mHandleInfo.setLooper(null);
             }
@@ -109,9 +133,13 @@ public final class SerialComCompletionDispatcher {
      */
     public boolean destroyDataLooper(long handle, SerialComPortHandleInfo handleInfo, ISerialComDataListener dataListener) throws SerialComException {
 
+        // Native thread may be waiting for space in queue (BLOCK policy), let it go so that it can exit.
+        handleInfo.getLooper().releaseBlockedDataInserts(true);
+
         // We got valid handle so destroy native threads for this listener.
         int ret = mComPortJNIBridge.destroyDataLooperThread(handle);
         if(ret < 0) {
+            handleInfo.getLooper().releaseBlockedDataInserts(false);
             throw new SerialComException("Could not unregister data listener (termination of native thread failed.). Please retry !");
         }
 
@@ -119,7 +147,7 @@ public final class SerialComCompletionDispatcher {
         handleInfo.getLooper().stopDataLooper();
 
         // Remove data listener from information object about this handle.
-        handleInfo.setDataListener(null);
+        mPortHandleInfo.setDataListener(handleInfo, null);
 
         // If neither data nor event listener exist, looper object should be destroyed.
         if((handleInfo.getEventListener() == null) && (handleInfo.getDataListener() == null)) {
@@ -135,10 +163,14 @@ public final class SerialComCompletionDispatcher {
      * @param handle handle of the opened port for which event looper need to be set up.
      * @param mHandleInfo Reference to SerialComPortHandleInfo object associated with given handle.
      * @param eventListener listener for which looper has to be set up.
+     * @param overflowPolicy what to do when event queue is full.
+     * @param queueCapacity maximum number of line events in queue.
+     * @param dispatchPolicy which thread delivers events to listener.
      * @return true on success.
      * @throws SerialComException if an error occurs. 
      */
-    public boolean setUpEventLooper(long handle, SerialComPortHandleInfo mHandleInfo, ISerialComEventListener eventListener) throws SerialComException {
+    public boolean setUpEventLooper(long handle, SerialComPortHandleInfo mHandleInfo, ISerialComEventListener eventListener, 
+            SerialComManager.OVERFLOWPOLICY overflowPolicy, int queueCapacity, SerialComManager.DISPATCHPOLICY dispatchPolicy) throws SerialComException {
 
         int ret = 0;
         SerialComLooper looper = mHandleInfo.getLooper();
@@ -149,14 +181,15 @@ public final class SerialComCompletionDispatcher {
             mHandleInfo.setLooper(looper);
         }
 
-        looper.startEventLooper(handle, eventListener, mHandleInfo.getOpenedPortName());
-        mHandleInfo.setEventListener(eventListener);
+        looper.startEventLooper(handle, eventListener, mHandleInfo.getOpenedPortName(), overflowPolicy, queueCapacity, 
+                dispatchPolicy, mSharedExecutor);
+        mPortHandleInfo.setEventListener(mHandleInfo, eventListener);
 
         try {
             ret = mComPortJNIBridge.setUpEventLooperThread(handle, looper);
             if(ret < 0) {
                 looper.stopEventLooper();
-                mHandleInfo.setEventListener(null);
+                mPortHandleInfo.setEventListener(mHandleInfo, null);
                 if(mHandleInfo.getDataListener() == null) {
                     mHandleInfo.setLooper(null);
                 }
@@ -164,7 +197,7 @@ public final class SerialComCompletionDispatcher {
             }
         }catch (SerialComException e) {
             looper.stopEventLooper();
-            mHandleInfo.setEventListener(null);
+            mPortHandleInfo.setEventListener(mHandleInfo, null);
             if(mHandleInfo.getDataListener() == null) {
                 mHandleInfo.setLooper(null);
             }
@@ -185,9 +218,13 @@ public final class SerialComCompletionDispatcher {
      */
     public boolean destroyEventLooper(long handle, SerialComPortHandleInfo handleInfo, ISerialComEventListener eventListener) throws SerialComException {
 
+        // Native thread may be waiting for space in queue (BLOCK policy), let it go so that it can exit.
+        handleInfo.getLooper().releaseBlockedEventInserts(true);
+
         // We got valid handle so destroy native threads for this listener.
         int ret = mComPortJNIBridge.destroyEventLooperThread(handle);
         if(ret < 0) {
+            handleInfo.getLooper().releaseBlockedEventInserts(false);
             throw new SerialComException("Could not unregister event listener (termination of native thread failed.). Please retry !");
         }
 
@@ -195,7 +232,7 @@ public final class SerialComCompletionDispatcher {
         handleInfo.getLooper().stopEventLooper();
 
         // Remove event listener from information object about this handle.
-        handleInfo.setEventListener(null);
+        mPortHandleInfo.setEventListener(handleInfo, null);
 
         // If neither data nor event listener exist, looper object should be destroyed.
         if((handleInfo.getEventListener() == null) && (handleInfo.getDataListener() == null)) {
@@ -218,15 +255,10 @@ public final class SerialComCompletionDispatcher {
         SerialComLooper looper = null;
         SerialComPortHandleInfo handleInfo = null;
 
-        for (Map.Entry<Long, SerialComPortHandleInfo> entry : mPortHandleInfo.entrySet()) {
-            handleInfo = entry.getValue();
-            if(handleInfo != null) {
-                if(handleInfo.getEventListener() ==  listener) {
-                    handle = handleInfo.getPortHandle();
-                    looper = handleInfo.getLooper();
-                    break;
-                }
-            }
+        handleInfo = mPortHandleInfo.getByEventListener(listener);
+        if(handleInfo != null) {
+            handle = handleInfo.getPortHandle();
+            looper = handleInfo.getLooper();
         }
 
         if(handle != -1) {
@@ -257,15 +289,10 @@ public final class SerialComCompletionDispatcher {
         SerialComLooper looper = null;
         SerialComPortHandleInfo handleInfo = null;
 
-        for (Map.Entry<Long, SerialComPortHandleInfo> entry : mPortHandleInfo.entrySet()) {
-            handleInfo = entry.getValue();
-            if(handleInfo != null) {
-                if(handleInfo.getEventListener() ==  listener) {
-                    handle = handleInfo.getPortHandle();
-                    looper = handleInfo.getLooper();
-                    break;
-                }
-            }
+        handleInfo = mPortHandleInfo.getByEventListener(listener);
+        if(handleInfo != null) {
+            handle = handleInfo.getPortHandle();
+            looper = handleInfo.getLooper();
         }
 
         if(handle != -1) {
@@ -0,0 +1,71 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.internal;
+
+import java.util.concurrent.atomic.AtomicLongArray;
+
+import com.serialpundit.serial.SerialComListenerStats;
+
+/**
+ * <p>Histogram of durations with power of 2 buckets in microseconds. Bucket 0 counts durations less 
+ * than 1 microsecond, bucket n (1 to NUM_BUCKETS - 2) counts durations from 2^(n-1) to less than 
+ * 2^n microseconds and last bucket counts all longer durations.</p>
+ * 
+ * <p>Recording a value is lock free and does not allocate memory.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComHistogram {
+
+    /** <p>Number of buckets in histogram. </p>*/
+    public static final int NUM_BUCKETS = SerialComListenerStats.NUM_HISTOGRAM_BUCKETS;
+
+    private final AtomicLongArray mBuckets = new AtomicLongArray(NUM_BUCKETS);
+
+    /**
+     * <p>Counts the given duration in its bucket.</p>
+     * 
+     * @param nanos duration in nanoseconds.
+     */
+    public void record(long nanos) {
+        long micros = nanos / 1000;
+        int bucket = 0;
+        if(micros > 0) {
+            bucket = Math.min(64 - Long.numberOfLeadingZeros(micros), NUM_BUCKETS - 1);
+        }
+        mBuckets.incrementAndGet(bucket);
+    }
+
+    /**
+     * <p>Gives count in every bucket.</p>
+     * 
+     * @return array of NUM_BUCKETS counts.
+     */
+    public long[] getCounts() {
+        long[] counts = new long[NUM_BUCKETS];
+        for(int x = 0; x < NUM_BUCKETS; x++) {
+            counts[x] = mBuckets.get(x);
+        }
+        return counts;
+    }
+
+    /**
+     * <p>Sets count in every bucket to 0.</p>
+     */
+    public void clear() {
+        for(int x = 0; x < NUM_BUCKETS; x++) {
+            mBuckets.set(x, 0);
+        }
+    }
+}
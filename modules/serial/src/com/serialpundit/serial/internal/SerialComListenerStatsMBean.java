@@ -0,0 +1,121 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.internal;
+
+import com.serialpundit.serial.ISerialComListenerStatsMXBean;
+import com.serialpundit.serial.SerialComListenerStats;
+
+/**
+ * <p>MXBean exposing listener statistics of a port through JMX. Every attribute is read from the looper 
+ * serving the port at the time of query, if no listener is registered all values are 0.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComListenerStatsMBean implements ISerialComListenerStatsMXBean {
+
+    private final SerialComPortHandleInfo mHandleInfo;
+
+    /**
+     * <p>Allocates a new SerialComListenerStatsMBean object.</p>
+     * 
+     * @param handleInfo information object of the port whose statistics are to be exposed.
+     */
+    public SerialComListenerStatsMBean(SerialComPortHandleInfo handleInfo) {
+        mHandleInfo = handleInfo;
+    }
+
+    private SerialComListenerStats getStats() {
+        SerialComLooper looper = mHandleInfo.getLooper();
+        if(looper == null) {
+            long[] empty = new long[SerialComListenerStats.NUM_HISTOGRAM_BUCKETS];
+            return new SerialComListenerStats(mHandleInfo.getOpenedPortName(), new long[10], empty, empty, empty, empty);
+        }
+        return looper.getListenerStats(mHandleInfo.getOpenedPortName());
+    }
+
+    @Override
+    public String getPortName() {
+        return mHandleInfo.getOpenedPortName();
+    }
+
+    @Override
+    public long getDataChunksDelivered() {
+        return getStats().getDataChunksDelivered();
+    }
+
+    @Override
+    public long getDataBytesDelivered() {
+        return getStats().getDataBytesDelivered();
+    }
+
+    @Override
+    public long getDataQueueDepth() {
+        return getStats().getDataQueueDepth();
+    }
+
+    @Override
+    public long getDataQueuePeak() {
+        return getStats().getDataQueuePeak();
+    }
+
+    @Override
+    public long getDataChunksDropped() {
+        return getStats().getDataChunksDropped();
+    }
+
+    @Override
+    public long getDataBytesDropped() {
+        return getStats().getDataBytesDropped();
+    }
+
+    @Override
+    public long getEventsDelivered() {
+        return getStats().getEventsDelivered();
+    }
+
+    @Override
+    public long getEventQueueDepth() {
+        return getStats().getEventQueueDepth();
+    }
+
+    @Override
+    public long getEventQueuePeak() {
+        return getStats().getEventQueuePeak();
+    }
+
+    @Override
+    public long getEventsDropped() {
+        return getStats().getEventsDropped();
+    }
+
+    @Override
+    public long[] getDataCallbackHistogram() {
+        return getStats().getDataCallbackHistogram();
+    }
+
+    @Override
+    public long[] getEventCallbackHistogram() {
+        return getStats().getEventCallbackHistogram();
+    }
+
+    @Override
+    public long[] getDataLatencyHistogram() {
+        return getStats().getDataLatencyHistogram();
+    }
+
+    @Override
+    public long[] getEventLatencyHistogram() {
+        return getStats().getEventLatencyHistogram();
+    }
+}
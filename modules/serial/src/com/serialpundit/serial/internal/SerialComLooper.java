@@ -13,129 +13,505 @@
 
 package com.serialpundit.serial.internal;
 
+import java.util.ArrayList;
 import java.util.concurrent.BlockingQueue;
 import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.Executor;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ScheduledThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLong;
 
 import com.serialpundit.core.SerialComException;
 import com.serialpundit.serial.ISerialComDataListener;
 import com.serialpundit.serial.ISerialComEventListener;
+import com.serialpundit.serial.ISerialComLeasedDataListener;
+import com.serialpundit.serial.ISerialComTimestampedDataListener;
+import com.serialpundit.serial.SerialComLeasedBuffer;
 import com.serialpundit.serial.SerialComLineEvent;
+import com.serialpundit.serial.SerialComListenerStats;
 import com.serialpundit.serial.SerialComManager;
 
 /**
- * <p>Encapsulates environment for data and event looper implementation. This runs in as a 
- * different thread context and keep looping over data/event queue, delivering data/events 
- * to the intended registered listener (data/event handler) one by one.</p>
+ * <p>Encapsulates environment for data and event looper implementation. Native threads put data/events 
+ * in queues of this looper. Whenever a queue has something to deliver, its looper task is submitted to 
+ * an executor and the executor's thread delivers data/events to the intended registered listener 
+ * (data/event handler) one by one. As per the dispatch policy of the listener, executor is the reactor 
+ * (or application supplied executor) shared by all the ports, a thread dedicated to this listener, or 
+ * the native thread itself which inserted data/event.</p>
  * 
  * <p>The rate of delivery of data/events are directly proportional to how fast listener finishes
- * his job and let us return.</p>
+ * his job and let us return. A listener is never called concurrently from more than one thread and 
+ * data/events are always delivered in the order they were received.</p>
+ * 
+ * <p>When a queue is full, the overflow policy given at the time of registering listener decides whether 
+ * oldest or newest item is discarded, native thread waits for space or queued items are merged. Number 
+ * of items discarded and maximum queue occupancy are recorded for application to inspect.</p>
  * 
  * @author Rishi Gupta
  */
 public final class SerialComLooper {
 
-    private final int MAX_NUM_EVENTS = 5000;
+    // Interval after which a native thread blocked on full queue checks whether it should give up.
+    private final long BLOCK_RECHECK_INTERVAL_MS = 100;
+
+    // Maximum number of free receive buffers retained in pool of a port.
+    private final int MAX_POOLED_BUFFERS = 64;
+
+    // Maximum number of data/events a looper delivers in one go, before giving other loopers sharing 
+    // the reactor a chance to run.
+    private final int MAX_DELIVERIES_PER_RUN = 64;
+
+    // Wakes up data loopers whose partial batch has reached its deadline, shared by all the loopers so 
+    // that no reactor thread waits for data to arrive.
+    private static final ScheduledThreadPoolExecutor BATCH_TIMER = createBatchTimer();
+
+    // Runs looper task in the thread which scheduled it (native reader thread).
+    private static final Executor INLINE_EXECUTOR = new Executor() {
+        @Override
+        public void execute(Runnable task) {
+            task.run();
+        }
+    };
+
     private SerialComPortJNIBridge mComPortJNIBridge;
 
-    private BlockingQueue<byte[]> mDataQueue = null;
-    private ISerialComDataListener mDataListener = null;
-    private Object mDataLock = new Object();
-    private Thread mDataLooperThread = null;
+    private static ScheduledThreadPoolExecutor createBatchTimer() {
+        ScheduledThreadPoolExecutor timer = new ScheduledThreadPoolExecutor(1, 
+                new SerialComReactor.ReactorThreadFactory("SerialPundit batch timer"));
+        timer.setRemoveOnCancelPolicy(true);
+        return timer;
+    }
+    private SerialComManager.DISPATCHPOLICY mDataDispatchPolicy = SerialComManager.DISPATCHPOLICY.SHARED;
+    private SerialComManager.DISPATCHPOLICY mEventDispatchPolicy = SerialComManager.DISPATCHPOLICY.SHARED;
+
+    private volatile BlockingQueue<byte[]> mDataQueue = null;
+    private volatile ISerialComDataListener mDataListener = null;
+    private final DataLooper mDataLooper = new DataLooper();
+
+    private volatile BlockingQueue<SerialComLeasedBuffer> mLeasedDataQueue = null;
+    private volatile ISerialComLeasedDataListener mLeasedDataListener = null;
+    private volatile ISerialComTimestampedDataListener mTimestampedDataListener = null;
+    private volatile SerialComBufferPool mBufferPool = null;
+
+    // Batching of data chunks, disabled when mBatchMaxBytes is 0. Batch lists are used only by the 
+    // data looper task which never runs concurrently with itself. startDataLooper increments 
+    // mDataGeneration and the looper task itself drops batch of previous listener when it sees new value.
+    private volatile int mBatchMaxBytes = 0;
+    private volatile int mBatchMaxChunks = 0;
+    private volatile long mBatchMaxDelayNanos = 0;
+    private final ArrayList<byte[]> mBatch = new ArrayList<byte[]>();
+    private final ArrayList<SerialComLeasedBuffer> mLeasedBatch = new ArrayList<SerialComLeasedBuffer>();
+    private byte[] mBatchCarry = null;
+    private SerialComLeasedBuffer mLeasedBatchCarry = null;
+    private int mBatchBytes = 0;
+    private long mBatchDeadline = 0;
+    private volatile boolean mBatchHasData = false;
+    private final AtomicBoolean mBatchTimerArmed = new AtomicBoolean(false);
+    private final AtomicInteger mDataGeneration = new AtomicInteger(0);
+    private int mBatchGeneration = 0;
     private AtomicBoolean deliverDataEvent = new AtomicBoolean(true);
-    private AtomicBoolean exitDataThread = new AtomicBoolean(false);
 
-    private BlockingQueue<Integer> mDataErrorQueue = null;
-    private Object mDataErrorLock = new Object();
-    private Thread mDataErrorLooperThread = null;
-    private AtomicBoolean exitDataErrorThread = new AtomicBoolean(false);
+    private volatile BlockingQueue<Integer> mDataErrorQueue = null;
+    private final DataErrorLooper mDataErrorLooper = new DataErrorLooper();
+
+    private volatile BlockingQueue<SerialComLineEvent> mEventQueue = null;
+    private volatile ISerialComEventListener mEventListener = null;
+    private final EventLooper mEventLooper = new EventLooper();
+
+    private SerialComManager.OVERFLOWPOLICY mDataOverflowPolicy = SerialComManager.OVERFLOWPOLICY.DROP_OLDEST;
+    private SerialComManager.OVERFLOWPOLICY mEventOverflowPolicy = SerialComManager.OVERFLOWPOLICY.DROP_OLDEST;
+    private volatile boolean releaseDataInserts = false;
+    private volatile boolean releaseEventInserts = false;
 
-    private BlockingQueue<SerialComLineEvent> mEventQueue = null;
-    private ISerialComEventListener mEventListener = null;
-    private Thread mEventLooperThread = null;
-    private AtomicBoolean exitEventThread = null;
+    private final AtomicLong dataChunksDropped = new AtomicLong(0);
+    private final AtomicLong dataBytesDropped = new AtomicLong(0);
+    private final AtomicLong dataErrorsDropped = new AtomicLong(0);
+    private final AtomicLong dataQueueHighWatermark = new AtomicLong(0);
+    private final AtomicLong eventsDropped = new AtomicLong(0);
+    private final AtomicLong eventQueueHighWatermark = new AtomicLong(0);
+
+    // Delivery statistics, updated only by looper tasks.
+    private final AtomicLong dataChunksDelivered = new AtomicLong(0);
+    private final AtomicLong dataBytesDelivered = new AtomicLong(0);
+    private final AtomicLong eventsDelivered = new AtomicLong(0);
+    private final SerialComHistogram mDataCallbackTime = new SerialComHistogram();
+    private final SerialComHistogram mEventCallbackTime = new SerialComHistogram();
+    private final SerialComHistogram mDataLatency = new SerialComHistogram();
+    private final SerialComHistogram mEventLatency = new SerialComHistogram();
 
     private int appliedMask = SerialComManager.CTS | SerialComManager.DSR | SerialComManager.DCD | SerialComManager.RI;
     private int oldLineState = 0;
     private int newLineState = 0;
 
+    // Line events coalescing and transition history, guarded by mLineEventLock. Only native event thread 
+    // records transitions, event looper task takes coalesced event and application reads history.
+    private final Object mLineEventLock = new Object();
+    private volatile boolean mCoalesceLineEvents = false;
+    private volatile boolean mCoalescedEventPending = false;
+    private int mCoalescedOldState = 0;
+    private int mCoalescedNewState = 0;
+    private final int[] mCoalescedTransitions = new int[4];
+    private long mCoalescedFirstTimestamp = 0;
+    private long mCoalescedLastTimestamp = 0;
+    private long[] mHistoryTimestamps = null;
+    private int[] mHistoryStates = null;
+    private int mHistoryHead = 0;
+    private int mHistoryCount = 0;
+
     /**
-     * <p>This class runs in as a different thread context and keep looping over data queue, delivering 
-     * data to the intended registered listener (data handler) one by one. The rate of delivery of
-     * new data is directly proportional to how fast listener finishes his job and let us return.</p>
+     * <p>Common scheduling logic of data, data error and event loopers. A looper task is submitted to 
+     * reactor only if it is not already submitted/running, so a listener is invoked by one thread at a 
+     * time. After delivering, the task checks queue again as new items may have been inserted meanwhile.</p>
      */
-    class DataLooper implements Runnable {
+    abstract class Looper implements Runnable {
+
+        private final AtomicBoolean scheduled = new AtomicBoolean(false);
+        protected volatile boolean active = false;
+        protected volatile Executor executor = null;
+
+        /* Deliver next item in queue to listener, return false if there is nothing to deliver. */
+        protected abstract boolean deliverNext();
+
+        protected abstract boolean hasPending();
+
+        protected boolean isPaused() {
+            return false;
+        }
+
+        /*
+         * Submit this looper to reactor if it has something to deliver and is not already submitted.
+         */
+        void schedule() {
+            if((active == true) && (isPaused() == false) && (hasPending() == true)) {
+                if(scheduled.compareAndSet(false, true)) {
+                    try {
+                        executor.execute(this);
+                    } catch (RejectedExecutionException e) {
+                        scheduled.set(false);
+                    }
+                }
+            }
+        }
+
         @Override
         public void run() {
-            /* take() method blocks if there is no event to deliver. So we don't keep wasting 
-             * CPU cycle in case queue is empty. */
-            while(true) {
-                synchronized(mDataLock) {
-                    try {
-                        mDataListener.onNewSerialDataAvailable(mDataQueue.take());
-                        if(deliverDataEvent.get() == false) {
-                            /* Causes the current thread to wait until another thread
-                             * invokes the notify method. */
-                            mDataLock.wait();
-                        }
-                    } catch (InterruptedException e) {
-                        if(exitDataThread.get() == true) {
-                            break;
-                        }
+            try {
+                for(int x = 0; x < MAX_DELIVERIES_PER_RUN; x++) {
+                    if((active == false) || (isPaused() == true) || (deliverNext() == false)) {
+                        break;
                     }
                 }
+            } finally {
+                scheduled.set(false);
+                // new items may have been queued after last check or budget for this run has exhausted.
+                schedule();
             }
-            exitDataThread.set(false); // Reset exit flag
-            mDataQueue = null;
         }
     }
 
     /**
-     * <p>This class runs in as a different thread context and keep looping over data error queue, delivering 
-     * error event to the intended registered listener (error data handler) one by one. The rate of delivery of
-     * new error event is directly proportional to how fast listener finishes his job and let us return.</p>
+     * <p>Delivers data in data queue to the intended registered listener (data handler) one by one. The 
+     * rate of delivery of new data is directly proportional to how fast listener finishes his job and 
+     * let us return.</p>
      */
-    class DataErrorLooper implements Runnable {
+    class DataLooper extends Looper {
         @Override
-        public void run() {
+        protected boolean deliverNext() {
+            int generation = mDataGeneration.get();
+            if(generation != mBatchGeneration) {
+                discardBatch();
+                mBatchGeneration = generation;
+            }
+
+            BlockingQueue<SerialComLeasedBuffer> leasedQueue = mLeasedDataQueue;
+            if(leasedQueue != null) {
+                SerialComLeasedBuffer buffer;
+                if((mBatchMaxBytes > 0) || (mBatchHasData == true)) {
+                    buffer = collectLeasedBatch(leasedQueue);
+                }else {
+                    buffer = leasedQueue.poll();
+                }
+                if(buffer == null) {
+                    return false;
+                }
+                // Listener may release buffer, so note what is needed for statistics before calling it.
+                int length = buffer.length();
+                long start = System.nanoTime();
+                if(buffer.getTimestamp() != 0) {
+                    mDataLatency.record(start - buffer.getTimestamp());
+                }
+                ISerialComLeasedDataListener leasedListener = mLeasedDataListener;
+                if(leasedListener != null) {
+                    leasedListener.onNewSerialDataLeased(buffer);
+                }else {
+                    deliverTimestamped(buffer);
+                }
+                recordDataDelivery(length, start);
+                return true;
+            }
+
+            byte[] data;
+            if((mBatchMaxBytes > 0) || (mBatchHasData == true)) {
+                data = collectBatch(mDataQueue);
+            }else {
+                data = mDataQueue.poll();
+            }
+            if(data == null) {
+                return false;
+            }
+            long start = System.nanoTime();
+            mDataListener.onNewSerialDataAvailable(data);
+            recordDataDelivery(data.length, start);
+            return true;
+        }
+
+        private void recordDataDelivery(int length, long start) {
+            mDataCallbackTime.record(System.nanoTime() - start);
+            dataChunksDelivered.incrementAndGet();
+            dataBytesDelivered.addAndGet(length);
+        }
+
+        /*
+         * Buffers carrying data for timestamped listener normally wrap the array given by native layer, that 
+         * array is handed over as it is. Pooled (merged) buffers are copied as pooled array will be re-used.
+         */
+        private void deliverTimestamped(SerialComLeasedBuffer buffer) {
+            byte[] data = buffer.array();
+            if((buffer.isPooled() == true) || (buffer.length() != data.length)) {
+                data = buffer.toByteArray();
+            }
+            long timestamp = buffer.getTimestamp();
+            buffer.release();
+            mTimestampedDataListener.onNewSerialDataTimestamped(data, timestamp);
+        }
+
+        /*
+         * Adds chunks from queue to batch being built till byte or chunk limit is reached, and gives the batch 
+         * as one contiguous chunk. Every chunk is removed from queue before it is looked at, as native thread 
+         * may remove chunks from a full queue concurrently. A chunk which does not fit is kept as the first 
+         * chunk of next batch, chunks are never split. If queue gets empty before limit is reached, null is 
+         * returned and a timer schedules this looper again at the deadline of batch, so no thread waits for 
+         * data to arrive.
+         */
+        private byte[] collectBatch(BlockingQueue<byte[]> queue) {
+            int maxBytes = mBatchMaxBytes;
             while(true) {
-                synchronized(mDataErrorLock) {
-                    try {
-                        mDataListener.onDataListenerError(mDataErrorQueue.take());
-                        if(deliverDataEvent.get() == false) {
-                            mDataErrorLock.wait();
-                        }
-                    } catch (InterruptedException e) {
-                        if(exitDataErrorThread.get() == true) {
-                            break;
-                        }
+                byte[] next = mBatchCarry;
+                if(next != null) {
+                    mBatchCarry = null;
+                }else {
+                    next = queue.poll();
+                    if(next == null) {
+                        break;
+                    }
+                }
+                if(mBatch.isEmpty()) {
+                    mBatchDeadline = System.nanoTime() + mBatchMaxDelayNanos;
+                    mBatchHasData = true;
+                }else if((mBatchBytes + next.length) > maxBytes) {
+                    mBatchCarry = next;
+                    return mergeBatch();
+                }
+                mBatch.add(next);
+                mBatchBytes = mBatchBytes + next.length;
+                if((mBatchBytes >= maxBytes) || (mBatch.size() >= mBatchMaxChunks)) {
+                    return mergeBatch();
+                }
+            }
+
+            if(mBatch.isEmpty()) {
+                return null;
+            }
+            if(isBatchDue(maxBytes)) {
+                return mergeBatch();
+            }
+            armBatchTimer();
+            return null;
+        }
+
+        private byte[] mergeBatch() {
+            byte[] merged;
+            if(mBatch.size() == 1) {
+                merged = mBatch.get(0);
+            }else {
+                int offset = 0;
+                merged = new byte[mBatchBytes];
+                for(byte[] chunk : mBatch) {
+                    System.arraycopy(chunk, 0, merged, offset, chunk.length);
+                    offset = offset + chunk.length;
+                }
+            }
+            mBatch.clear();
+            mBatchBytes = 0;
+            mBatchHasData = (mBatchCarry != null);
+            return merged;
+        }
+
+        private SerialComLeasedBuffer collectLeasedBatch(BlockingQueue<SerialComLeasedBuffer> queue) {
+            int maxBytes = mBatchMaxBytes;
+            while(true) {
+                SerialComLeasedBuffer next = mLeasedBatchCarry;
+                if(next != null) {
+                    mLeasedBatchCarry = null;
+                }else {
+                    next = queue.poll();
+                    if(next == null) {
+                        break;
                     }
                 }
+                if(mLeasedBatch.isEmpty()) {
+                    mBatchDeadline = System.nanoTime() + mBatchMaxDelayNanos;
+                    mBatchHasData = true;
+                }else if((mBatchBytes + next.length()) > maxBytes) {
+                    mLeasedBatchCarry = next;
+                    return mergeLeasedBatch();
+                }
+                mLeasedBatch.add(next);
+                mBatchBytes = mBatchBytes + next.length();
+                if((mBatchBytes >= maxBytes) || (mLeasedBatch.size() >= mBatchMaxChunks)) {
+                    return mergeLeasedBatch();
+                }
+            }
+
+            if(mLeasedBatch.isEmpty()) {
+                return null;
+            }
+            if(isBatchDue(maxBytes)) {
+                return mergeLeasedBatch();
+            }
+            armBatchTimer();
+            return null;
+        }
+
+        private SerialComLeasedBuffer mergeLeasedBatch() {
+            SerialComLeasedBuffer merged;
+            if(mLeasedBatch.size() == 1) {
+                merged = mLeasedBatch.get(0);
+            }else {
+                int offset = 0;
+                merged = mBufferPool.lease(mBatchBytes);
+                for(SerialComLeasedBuffer chunk : mLeasedBatch) {
+                    System.arraycopy(chunk.array(), 0, merged.array(), offset, chunk.length());
+                    offset = offset + chunk.length();
+                    chunk.release();
+                }
+                merged.setLength(mBatchBytes);
+                merged.setTimestamp(mLeasedBatch.get(mLeasedBatch.size() - 1).getTimestamp());
+            }
+            mLeasedBatch.clear();
+            mBatchBytes = 0;
+            mBatchHasData = (mLeasedBatchCarry != null);
+            return merged;
+        }
+
+        /*
+         * Partial batch is delivered when its deadline has passed, when batching has been disabled meanwhile, 
+         * or when delivering inline as data producer itself is running this looper.
+         */
+        private boolean isBatchDue(int maxBytes) {
+            return (maxBytes == 0) || (active == false) || (executor == INLINE_EXECUTOR) || 
+                    ((System.nanoTime() - mBatchDeadline) >= 0);
+        }
+
+        private void armBatchTimer() {
+            if(mBatchTimerArmed.compareAndSet(false, true)) {
+                long delay = mBatchDeadline - System.nanoTime();
+                try {
+                    BATCH_TIMER.schedule(mBatchTimeout, (delay > 0) ? delay : 0, TimeUnit.NANOSECONDS);
+                } catch (RejectedExecutionException e) {
+                    mBatchTimerArmed.set(false);
+                }
             }
-            exitDataErrorThread.set(false); // Reset exit flag
-            mDataErrorQueue = null;
+        }
+
+        private final Runnable mBatchTimeout = new Runnable() {
+            @Override
+            public void run() {
+                mBatchTimerArmed.set(false);
+                schedule();
+            }
+        };
+
+        @Override
+        protected boolean hasPending() {
+            // A partial batch is looked at again only when its timer has expired.
+            if((mBatchHasData == true) && (mBatchTimerArmed.get() == false)) {
+                return true;
+            }
+            BlockingQueue<SerialComLeasedBuffer> leasedQueue = mLeasedDataQueue;
+            if(leasedQueue != null) {
+                return leasedQueue.isEmpty() == false;
+            }
+            BlockingQueue<byte[]> queue = mDataQueue;
+            return (queue != null) && (queue.isEmpty() == false);
+        }
+
+        @Override
+        protected boolean isPaused() {
+            return deliverDataEvent.get() == false;
         }
     }
 
     /**
-     * <p>This class runs in as a different thread context and keep looping over event queue, delivering 
-     * events to the intended registered listener (event handler) one by one. The rate of delivery of
-     * events are directly proportional to how fast listener finishes his job and let us return.</p>
+     * <p>Delivers error events in data error queue to the intended registered listener (error data 
+     * handler) one by one.</p>
      */
-    class EventLooper implements Runnable {
+    class DataErrorLooper extends Looper {
         @Override
-        public void run() {
-            while(true) {
-                try {
-                    mEventListener.onNewSerialEvent(mEventQueue.take());
-                } catch (InterruptedException e) {
-                    if(exitEventThread.get() == true) {
-                        break;
-                    }
+        protected boolean deliverNext() {
+            Integer errorNum = mDataErrorQueue.poll();
+            if(errorNum == null) {
+                return false;
+            }
+            mDataListener.onDataListenerError(errorNum);
+            return true;
+        }
+
+        @Override
+        protected boolean hasPending() {
+            BlockingQueue<Integer> queue = mDataErrorQueue;
+            return (queue != null) && (queue.isEmpty() == false);
+        }
+
+        @Override
+        protected boolean isPaused() {
+            return deliverDataEvent.get() == false;
+        }
+    }
+
+    /**
+     * <p>Delivers events in event queue to the intended registered listener (event handler) one by one. 
+     * The rate of delivery of events are directly proportional to how fast listener finishes his job 
+     * and let us return.</p>
+     */
+    class EventLooper extends Looper {
+        @Override
+        protected boolean deliverNext() {
+            SerialComLineEvent lineEvent = mEventQueue.poll();
+            if(lineEvent == null) {
+                // Events queued before coalescing was enabled are delivered first.
+                lineEvent = takeCoalescedEvent();
+                if(lineEvent == null) {
+                    return false;
                 }
             }
-            exitEventThread.set(false); // Reset exit flag
-            mEventQueue = null;
+            long start = System.nanoTime();
+            if(lineEvent.getLastTimestamp() != 0) {
+                mEventLatency.record(start - lineEvent.getLastTimestamp());
+            }
+            mEventListener.onNewSerialEvent(lineEvent);
+            mEventCallbackTime.record(System.nanoTime() - start);
+            eventsDelivered.incrementAndGet();
+            return true;
+        }
+
+        @Override
+        protected boolean hasPending() {
+            BlockingQueue<SerialComLineEvent> queue = mEventQueue;
+            return ((queue != null) && (queue.isEmpty() == false)) || (mCoalescedEventPending == true);
         }
     }
 
@@ -148,91 +524,571 @@ public final class SerialComLooper {
         this.mComPortJNIBridge = mComPortJNIBridge;
     }
 
+    /*
+     * Gives executor which will run looper task as per the dispatch policy.
+     */
+    private static Executor createExecutor(SerialComManager.DISPATCHPOLICY dispatchPolicy, Executor sharedExecutor, String name) {
+        switch(dispatchPolicy) {
+        case DEDICATED:
+            return new SerialComReactor(1, name);
+        case INLINE:
+            return INLINE_EXECUTOR;
+        default:
+            return sharedExecutor;
+        }
+    }
+
+    private static void releaseExecutor(SerialComManager.DISPATCHPOLICY dispatchPolicy, Executor executor) {
+        if((dispatchPolicy == SerialComManager.DISPATCHPOLICY.DEDICATED) && (executor instanceof SerialComReactor)) {
+            ((SerialComReactor) executor).shutdown();
+        }
+    }
+
     /**
-     * <p>This method is called from native code to pass data bytes.</p>
+     * <p>This method is called from native code to pass data bytes. If data queue is full, data 
+     * is handled as per the overflow policy set for this listener.</p>
+     * 
+     * <p>Arrival time is recorded here, on the native reader thread, before data is queued.</p>
+     * 
      * @param newData byte array containing data read from serial port
      */
     public void insertInDataQueue(byte[] newData) {
+        long timestamp = System.nanoTime();
+
+        SerialComBufferPool pool = mBufferPool;
+        if(pool != null) {
+            SerialComLeasedBuffer buffer;
+            if((mLeasedDataListener != null) && (newData.length <= pool.getBufferSize())) {
+                // Copied in a pooled buffer, so memory held by leased listener is re-used and the array 
+                // given by native layer is garbage right away.
+                buffer = pool.lease(newData, 0, newData.length);
+            }else {
+                // Timestamped listener gets this array back as it is, a bigger chunk would not fit in 
+                // pooled buffer anyway.
+                buffer = new SerialComLeasedBuffer(newData, null);
+                buffer.setLength(newData.length);
+            }
+            buffer.setTimestamp(timestamp);
+            insertInDataQueue(buffer);
+            return;
+        }
+
+        BlockingQueue<byte[]> queue = mDataQueue;
+        if(queue == null) {
+            return;
+        }
+
+        try {
+            if(queue.offer(newData) == false) {
+                switch(mDataOverflowPolicy) {
+                case DROP_NEWEST:
+                    countDroppedData(newData);
+                    break;
+                case BLOCK:
+                    // Native thread stops reading, data accumulates in operating system buffers and if 
+                    // flow control is enabled, sender will be asked to stop sending.
+                    while(queue.offer(newData, BLOCK_RECHECK_INTERVAL_MS, TimeUnit.MILLISECONDS) == false) {
+                        if((mDataLooper.active == false) || (releaseDataInserts == true)) {
+                            countDroppedData(newData);
+                            break;
+                        }
+                    }
+                    break;
+                case COALESCE:
+                    coalesceData(queue, newData);
+                    break;
+                default:
+                    // DROP_OLDEST, loop as reactor thread may have just made space for us.
+                    do {
+                        byte[] oldest = queue.poll();
+                        if(oldest != null) {
+                            countDroppedData(oldest);
+                        }
+                    } while(queue.offer(newData) == false);
+                    break;
+                }
+            }
+        } catch (InterruptedException e) {
+            countDroppedData(newData);
+        }
+
+        updateHighWatermark(dataQueueHighWatermark, queue.size());
+        mDataLooper.schedule();
+    }
+
+    /*
+     * Merge all the data chunks in queue and the given data in one chunk. Only native thread inserts 
+     * in data queue, so after draining there is always room for merged chunk.
+     */
+    private void coalesceData(BlockingQueue<byte[]> queue, byte[] newData) {
+        ArrayList<byte[]> pending = new ArrayList<byte[]>(queue.size());
+        queue.drainTo(pending);
+
+        int length = newData.length;
+        for(byte[] chunk : pending) {
+            length = length + chunk.length;
+        }
+
+        int offset = 0;
+        byte[] merged = new byte[length];
+        for(byte[] chunk : pending) {
+            System.arraycopy(chunk, 0, merged, offset, chunk.length);
+            offset = offset + chunk.length;
+        }
+        System.arraycopy(newData, 0, merged, offset, newData.length);
+
+        if(queue.offer(merged) == false) {
+            countDroppedData(merged);
+        }
+    }
+
+    /**
+     * <p>Inserts a filled leased buffer in data queue for delivery to ISerialComLeasedDataListener. If 
+     * data queue is full, buffer is handled as per the overflow policy set for this listener and 
+     * discarded buffers are returned to pool. Producer should set arrival time in buffer.</p>
+     * 
+     * @param buffer leased buffer containing data read from serial port.
+     */
+    public void insertInDataQueue(SerialComLeasedBuffer buffer) {
+        BlockingQueue<SerialComLeasedBuffer> queue = mLeasedDataQueue;
+        if(queue == null) {
+            buffer.release();
+            return;
+        }
+
         try {
-            if(mDataQueue.remainingCapacity() == 0) {
-                mDataQueue.poll();
+            if(queue.offer(buffer) == false) {
+                switch(mDataOverflowPolicy) {
+                case DROP_NEWEST:
+                    dropLeasedData(buffer);
+                    break;
+                case BLOCK:
+                    while(queue.offer(buffer, BLOCK_RECHECK_INTERVAL_MS, TimeUnit.MILLISECONDS) == false) {
+                        if((mDataLooper.active == false) || (releaseDataInserts == true)) {
+                            dropLeasedData(buffer);
+                            break;
+                        }
+                    }
+                    break;
+                case COALESCE:
+                    coalesceLeasedData(queue, buffer);
+                    break;
+                default:
+                    do {
+                        SerialComLeasedBuffer oldest = queue.poll();
+                        if(oldest != null) {
+                            dropLeasedData(oldest);
+                        }
+                    } while(queue.offer(buffer) == false);
+                    break;
+                }
+            }
+        } catch (InterruptedException e) {
+            dropLeasedData(buffer);
+        }
+
+        updateHighWatermark(dataQueueHighWatermark, queue.size());
+        mDataLooper.schedule();
+    }
+
+    private void coalesceLeasedData(BlockingQueue<SerialComLeasedBuffer> queue, SerialComLeasedBuffer buffer) {
+        ArrayList<SerialComLeasedBuffer> pending = new ArrayList<SerialComLeasedBuffer>(queue.size() + 1);
+        queue.drainTo(pending);
+        pending.add(buffer);
+
+        int length = 0;
+        for(SerialComLeasedBuffer chunk : pending) {
+            length = length + chunk.length();
+        }
+
+        int offset = 0;
+        SerialComLeasedBuffer merged = mBufferPool.lease(length);
+        for(SerialComLeasedBuffer chunk : pending) {
+            System.arraycopy(chunk.array(), 0, merged.array(), offset, chunk.length());
+            offset = offset + chunk.length();
+            chunk.release();
+        }
+        merged.setLength(length);
+        merged.setTimestamp(buffer.getTimestamp());
+
+        if(queue.offer(merged) == false) {
+            dropLeasedData(merged);
+        }
+    }
+
+    private void dropLeasedData(SerialComLeasedBuffer buffer) {
+        dataChunksDropped.incrementAndGet();
+        dataBytesDropped.addAndGet(buffer.length());
+        buffer.release();
+    }
+
+    private void countDroppedData(byte[] data) {
+        dataChunksDropped.incrementAndGet();
+        dataBytesDropped.addAndGet(data.length);
+    }
+
+    private static void updateHighWatermark(AtomicLong watermark, long size) {
+        long current = watermark.get();
+        while(size > current) {
+            if(watermark.compareAndSet(current, size)) {
+                break;
             }
-            mDataQueue.offer(newData);
-        } catch (Exception e) {
+            current = watermark.get();
         }
     }
 
     /**
-     * <p>This method insert error info in error queue which will be later delivered to application.</p>
+     * <p>This method insert error info in error queue which will be later delivered to application. 
+     * Errors are never blocked or merged, if queue is full oldest error is discarded.</p>
      * 
      * @param errorNum operating system specific error number to be sent to application.
      */
     public void insertInDataErrorQueue(int errorNum) {
-        if(mDataErrorQueue.remainingCapacity() == 0) {
-            mDataErrorQueue.poll();
+        BlockingQueue<Integer> queue = mDataErrorQueue;
+        if(queue == null) {
+            return;
         }
-        try {
-            mDataErrorQueue.offer(errorNum);
-        } catch (Exception e) {
+
+        if(queue.offer(errorNum) == false) {
+            if(mDataOverflowPolicy == SerialComManager.OVERFLOWPOLICY.DROP_NEWEST) {
+                dataErrorsDropped.incrementAndGet();
+            }else {
+                do {
+                    if(queue.poll() != null) {
+                        dataErrorsDropped.incrementAndGet();
+                    }
+                } while(queue.offer(errorNum) == false);
+            }
         }
+
+        mDataErrorLooper.schedule();
     }
 
     /**
      * <p>Native side detects the change in status of lines, get the new line status and call this method. 
-     * Based on the mask this method determines whether this event should be sent to application or not.</p>
+     * Based on the mask this method determines whether this event should be sent to application or not. 
+     * Change in lines which are masked is discarded here without creating any event object. If event queue 
+     * is full, event is handled as per the overflow policy set for this listener.</p>
+     * 
+     * <p>If coalescing is enabled, transition is merged in the event waiting to be delivered instead of 
+     * queuing a new event.</p>
      * 
      * @param newEvent bit mask representing event on serial port control lines.
      */
     public void insertInEventQueue(int newEvent) {
+        BlockingQueue<SerialComLineEvent> queue = mEventQueue;
+        if(queue == null) {
+            return;
+        }
+
+        long timestamp = System.nanoTime();
+        int previousLineState = oldLineState;
         newLineState = newEvent & appliedMask;
-        if(mEventQueue.remainingCapacity() == 0) {
-            mEventQueue.poll();
+        if(newLineState == previousLineState) {
+            // Only lines not of interest to application have changed.
+            return;
+        }
+        oldLineState = newLineState;
+        int changed = previousLineState ^ newLineState;
+
+        if((mCoalesceLineEvents == true) || (mHistoryStates != null)) {
+            synchronized(mLineEventLock) {
+                if(mHistoryStates != null) {
+                    mHistoryTimestamps[mHistoryHead] = timestamp;
+                    mHistoryStates[mHistoryHead] = newLineState;
+                    mHistoryHead = (mHistoryHead + 1) % mHistoryStates.length;
+                    if(mHistoryCount < mHistoryStates.length) {
+                        mHistoryCount++;
+                    }
+                }
+                if(mCoalesceLineEvents == true) {
+                    if(mCoalescedEventPending == false) {
+                        mCoalescedOldState = previousLineState;
+                        mCoalescedFirstTimestamp = timestamp;
+                        mCoalescedTransitions[0] = 0;
+                        mCoalescedTransitions[1] = 0;
+                        mCoalescedTransitions[2] = 0;
+                        mCoalescedTransitions[3] = 0;
+                    }
+                    mCoalescedNewState = newLineState;
+                    mCoalescedLastTimestamp = timestamp;
+                    countTransitions(mCoalescedTransitions, changed);
+                    mCoalescedEventPending = true;
+                }
+            }
+            if(mCoalesceLineEvents == true) {
+                mEventLooper.schedule();
+                return;
+            }
         }
+
+        SerialComLineEvent lineEvent = new SerialComLineEvent(previousLineState, newLineState, 
+                (changed & SerialComManager.CTS) != 0 ? 1 : 0, (changed & SerialComManager.DSR) != 0 ? 1 : 0, 
+                (changed & SerialComManager.DCD) != 0 ? 1 : 0, (changed & SerialComManager.RI) != 0 ? 1 : 0, 
+                timestamp, timestamp);
+
         try {
-            mEventQueue.offer(new SerialComLineEvent(oldLineState, newLineState));
-        } catch (Exception e) {
+            if(queue.offer(lineEvent) == false) {
+                switch(mEventOverflowPolicy) {
+                case DROP_NEWEST:
+                    eventsDropped.incrementAndGet();
+                    break;
+                case BLOCK:
+                    while(queue.offer(lineEvent, BLOCK_RECHECK_INTERVAL_MS, TimeUnit.MILLISECONDS) == false) {
+                        if((mEventLooper.active == false) || (releaseEventInserts == true)) {
+                            eventsDropped.incrementAndGet();
+                            break;
+                        }
+                    }
+                    break;
+                case COALESCE:
+                    // One event from the oldest previous state to the latest state.
+                    ArrayList<SerialComLineEvent> pending = new ArrayList<SerialComLineEvent>(queue.size());
+                    queue.drainTo(pending);
+                    if(pending.isEmpty() == false) {
+                        pending.add(lineEvent);
+                        lineEvent = mergeLineEvents(pending);
+                    }
+                    if(queue.offer(lineEvent) == false) {
+                        eventsDropped.incrementAndGet();
+                    }
+                    break;
+                default:
+                    do {
+                        if(queue.poll() != null) {
+                            eventsDropped.incrementAndGet();
+                        }
+                    } while(queue.offer(lineEvent) == false);
+                    break;
+                }
+            }
+        } catch (InterruptedException e) {
+            eventsDropped.incrementAndGet();
+        }
+
+        updateHighWatermark(eventQueueHighWatermark, queue.size());
+        mEventLooper.schedule();
+    }
+
+    private static void countTransitions(int[] transitions, int changed) {
+        if((changed & SerialComManager.CTS) != 0) {
+            transitions[0]++;
+        }
+        if((changed & SerialComManager.DSR) != 0) {
+            transitions[1]++;
+        }
+        if((changed & SerialComManager.DCD) != 0) {
+            transitions[2]++;
+        }
+        if((changed & SerialComManager.RI) != 0) {
+            transitions[3]++;
+        }
+    }
+
+    /*
+     * One event from the oldest previous state to the latest state, adding up transitions.
+     */
+    private static SerialComLineEvent mergeLineEvents(ArrayList<SerialComLineEvent> events) {
+        SerialComLineEvent first = events.get(0);
+        SerialComLineEvent last = events.get(events.size() - 1);
+        int cts = 0;
+        int dsr = 0;
+        int dcd = 0;
+        int ri = 0;
+        for(SerialComLineEvent event : events) {
+            cts = cts + event.getTransitionCount(SerialComManager.CTS);
+            dsr = dsr + event.getTransitionCount(SerialComManager.DSR);
+            dcd = dcd + event.getTransitionCount(SerialComManager.DCD);
+            ri = ri + event.getTransitionCount(SerialComManager.RI);
+        }
+        return new SerialComLineEvent(first.getOldLineState(), last.getNewLineState(), cts, dsr, dcd, ri, 
+                first.getFirstTimestamp(), last.getLastTimestamp());
+    }
+
+    /*
+     * Gives event representing all transitions since last coalesced event was taken, null if none.
+     */
+    private SerialComLineEvent takeCoalescedEvent() {
+        if(mCoalescedEventPending == false) {
+            return null;
+        }
+        synchronized(mLineEventLock) {
+            if(mCoalescedEventPending == false) {
+                return null;
+            }
+            mCoalescedEventPending = false;
+            return new SerialComLineEvent(mCoalescedOldState, mCoalescedNewState, mCoalescedTransitions[0], 
+                    mCoalescedTransitions[1], mCoalescedTransitions[2], mCoalescedTransitions[3], 
+                    mCoalescedFirstTimestamp, mCoalescedLastTimestamp);
+        }
+    }
+
+    /**
+     * <p>Enables or disables coalescing of line events and recording of transition history.</p>
+     * 
+     * @param coalesce true if transitions happening before listener takes previous event should be 
+     *         merged in one event.
+     * @param historyCapacity number of latest transitions to be remembered, 0 to disable history.
+     */
+    public void setLineEventCoalescing(boolean coalesce, int historyCapacity) {
+        synchronized(mLineEventLock) {
+            if(historyCapacity > 0) {
+                if((mHistoryStates == null) || (mHistoryStates.length != historyCapacity)) {
+                    mHistoryTimestamps = new long[historyCapacity];
+                    mHistoryStates = new int[historyCapacity];
+                    mHistoryHead = 0;
+                    mHistoryCount = 0;
+                }
+            }else {
+                mHistoryTimestamps = null;
+                mHistoryStates = null;
+                mHistoryHead = 0;
+                mHistoryCount = 0;
+            }
+            mCoalesceLineEvents = coalesce;
+        }
+        // A merged event may be waiting, deliver it even if coalescing has been disabled now.
+        mEventLooper.schedule();
+    }
+
+    /**
+     * <p>Copies recorded transitions, oldest first, in the given arrays and removes them from history.</p>
+     * 
+     * @param timestamps array in which time of transitions (System.nanoTime()) will be saved.
+     * @param lineStates array in which line state after each transition will be saved.
+     * @return number of transitions copied.
+     */
+    public int getLineEventHistory(long[] timestamps, int[] lineStates) {
+        synchronized(mLineEventLock) {
+            if(mHistoryStates == null) {
+                return 0;
+            }
+            int count = Math.min(mHistoryCount, Math.min(timestamps.length, lineStates.length));
+            int index = (mHistoryHead - mHistoryCount + mHistoryStates.length) % mHistoryStates.length;
+            for(int x = 0; x < count; x++) {
+                timestamps[x] = mHistoryTimestamps[index];
+                lineStates[x] = mHistoryStates[index];
+                index = (index + 1) % mHistoryStates.length;
+            }
+            mHistoryCount = mHistoryCount - count;
+            return count;
         }
-        oldLineState = newLineState;
     }
 
     /**
-     * <p>Start the thread to loop over data queue. </p>
+     * <p>Prepare queues and make data loopers ready to be scheduled on reactor.</p>
      * 
      * @param handle handle of the opened port for which data looper need to be started.
      * @param dataListener listener to which data will be delivered.
      * @param portName name of port represented by this handle.
+     * @param overflowPolicy what to do when data queue is full.
+     * @param queueCapacity maximum number of data chunks in queue.
+     * @param dispatchPolicy which thread delivers data to listener.
+     * @param sharedExecutor executor to be used for DISPATCHPOLICY.SHARED.
      */
-    public void startDataLooper(long handle, ISerialComDataListener dataListener, String portName) {
+    public void startDataLooper(long handle, ISerialComDataListener dataListener, String portName, 
+            SerialComManager.OVERFLOWPOLICY overflowPolicy, int queueCapacity, 
+            SerialComManager.DISPATCHPOLICY dispatchPolicy, Executor sharedExecutor) {
+        Executor executor = createExecutor(dispatchPolicy, sharedExecutor, "SerialPundit data looper " + portName);
+        mDataDispatchPolicy = dispatchPolicy;
+        mDataLooper.executor = executor;
+        mDataErrorLooper.executor = executor;
+        mDataOverflowPolicy = overflowPolicy;
+        releaseDataInserts = false;
+        dataChunksDropped.set(0);
+        dataBytesDropped.set(0);
+        dataErrorsDropped.set(0);
+        dataQueueHighWatermark.set(0);
+        dataChunksDelivered.set(0);
+        dataBytesDelivered.set(0);
+        mDataCallbackTime.clear();
+        mDataLatency.clear();
+        mBatchMaxBytes = 0;
+        mDataGeneration.incrementAndGet();
         mDataListener = dataListener;
-        mDataQueue = new ArrayBlockingQueue<byte[]>(MAX_NUM_EVENTS);
-        mDataErrorQueue = new ArrayBlockingQueue<Integer>(MAX_NUM_EVENTS);
-        mDataLooperThread = new Thread(new DataLooper(), "SerialPundit DataLooper for handle " + handle + " and port " + portName);
-        mDataErrorLooperThread = new Thread(new DataErrorLooper(), "SerialPundit DataErrorLooper for handle " + handle + " and port " + portName);
-        mDataLooperThread.start();
-        mDataErrorLooperThread.start();
+        if((dataListener instanceof ISerialComLeasedDataListener) || (dataListener instanceof ISerialComTimestampedDataListener)) {
+            // Leased buffers carry arrival time, so they are used for timestamped listener too.
+            if(dataListener instanceof ISerialComLeasedDataListener) {
+                mLeasedDataListener = (ISerialComLeasedDataListener) dataListener;
+                mTimestampedDataListener = null;
+            }else {
+                mLeasedDataListener = null;
+                mTimestampedDataListener = (ISerialComTimestampedDataListener) dataListener;
+            }
+            mBufferPool = new SerialComBufferPool(SerialComManager.DEFAULT_READBYTECOUNT, MAX_POOLED_BUFFERS);
+            mLeasedDataQueue = new ArrayBlockingQueue<SerialComLeasedBuffer>(queueCapacity);
+            mDataQueue = null;
+        }else {
+            mLeasedDataListener = null;
+            mTimestampedDataListener = null;
+            mLeasedDataQueue = null;
+            mBufferPool = null;
+            mDataQueue = new ArrayBlockingQueue<byte[]>(queueCapacity);
+        }
+        mDataErrorQueue = new ArrayBlockingQueue<Integer>(queueCapacity);
+        mDataLooper.active = true;
+        mDataErrorLooper.active = true;
+    }
+
+    /*
+     * Drops partially built batch of previous listener, if any. Called only by data looper task.
+     */
+    private void discardBatch() {
+        for(SerialComLeasedBuffer chunk : mLeasedBatch) {
+            chunk.release();
+        }
+        if(mLeasedBatchCarry != null) {
+            mLeasedBatchCarry.release();
+            mLeasedBatchCarry = null;
+        }
+        mLeasedBatch.clear();
+        mBatch.clear();
+        mBatchCarry = null;
+        mBatchBytes = 0;
+        mBatchHasData = false;
     }
 
     /**
-     * <p>Set the flag to indicate that the thread is supposed to run to completion and exit.
-     * Interrupt the thread so that take() method can come out of blocked sleep state.</p>
+     * <p>Stop delivering data and discard data not yet delivered. If a reactor thread is delivering 
+     * data to listener at this moment, it finishes that delivery and then leaves this looper.</p>
      */
     public void stopDataLooper() {
-        exitDataThread.set(true);
-        exitDataErrorThread.set(true);
-        mDataLooperThread.interrupt();
-        mDataErrorLooperThread.interrupt();
+        mDataLooper.active = false;
+        mDataErrorLooper.active = false;
+        BlockingQueue<byte[]> dataQueue = mDataQueue;
+        if(dataQueue != null) {
+            dataQueue.clear();
+        }
+        BlockingQueue<SerialComLeasedBuffer> leasedQueue = mLeasedDataQueue;
+        if(leasedQueue != null) {
+            SerialComLeasedBuffer buffer = null;
+            while((buffer = leasedQueue.poll()) != null) {
+                buffer.release();
+            }
+        }
+        BlockingQueue<Integer> dataErrorQueue = mDataErrorQueue;
+        if(dataErrorQueue != null) {
+            dataErrorQueue.clear();
+        }
+        releaseExecutor(mDataDispatchPolicy, mDataLooper.executor);
     }
 
     /**
-     * <p>Get initial status of control lines and start Java worker thread.</p>
+     * <p>Get initial status of control lines and make event looper ready to be scheduled on reactor.</p>
      * 
      * @param handle handle of the opened port for which event looper need to be started.
      * @param eventListener listener to which event will be delivered.
      * @param portName name of port represented by this handle.
+     * @param overflowPolicy what to do when event queue is full.
+     * @param queueCapacity maximum number of line events in queue.
+     * @param dispatchPolicy which thread delivers events to listener.
+     * @param sharedExecutor executor to be used for DISPATCHPOLICY.SHARED.
      * 
      * @throws SerialComException if an error occurs.
      */
-    public void startEventLooper(long handle, ISerialComEventListener eventListener, String portName) throws SerialComException {
+    public void startEventLooper(long handle, ISerialComEventListener eventListener, String portName, 
+            SerialComManager.OVERFLOWPOLICY overflowPolicy, int queueCapacity, 
+            SerialComManager.DISPATCHPOLICY dispatchPolicy, Executor sharedExecutor) throws SerialComException {
         int state = 0;
         int[] linestate = null;
 
@@ -246,27 +1102,129 @@ public final class SerialComLooper {
         state = linestate[0] | linestate[1] | linestate[2] | linestate[3];
         oldLineState = state & appliedMask;
 
-        mEventQueue = new ArrayBlockingQueue<SerialComLineEvent>(MAX_NUM_EVENTS);
-        exitEventThread = new AtomicBoolean(false);
+        mEventOverflowPolicy = overflowPolicy;
+        releaseEventInserts = false;
+        eventsDropped.set(0);
+        eventQueueHighWatermark.set(0);
+        eventsDelivered.set(0);
+        mEventCallbackTime.clear();
+        mEventLatency.clear();
+        mEventQueue = new ArrayBlockingQueue<SerialComLineEvent>(queueCapacity);
         mEventListener = eventListener;
-
-        mEventLooperThread = new Thread(new EventLooper(), "SerialPundit EventLooper for handle " + handle + " and port " + portName);
-        mEventLooperThread.start();
+        mEventDispatchPolicy = dispatchPolicy;
+        setLineEventCoalescing(false, 0);
+        mCoalescedEventPending = false;
+        mEventLooper.executor = createExecutor(dispatchPolicy, sharedExecutor, "SerialPundit event looper " + portName);
+        mEventLooper.active = true;
     }
 
     /**
-     * <p>Set the flag to indicate that the thread is supposed to run to completion and exit.
-     * Interrupt the thread so that take() method can come out of blocked sleep state.</p>
+     * <p>Stop delivering events and discard events not yet delivered.</p>
      * 
      * @throws SerialComException if an error occurs.
      */
     public void stopEventLooper() throws SerialComException {
-        exitEventThread.set(true);
-        mEventLooperThread.interrupt();
+        mEventLooper.active = false;
+        BlockingQueue<SerialComLineEvent> eventQueue = mEventQueue;
+        if(eventQueue != null) {
+            eventQueue.clear();
+        }
+        mCoalescedEventPending = false;
+        releaseExecutor(mEventDispatchPolicy, mEventLooper.executor);
+    }
+
+    /**
+     * <p>When set to true, native thread waiting for space in data queue stops waiting and discards 
+     * the data. Used while destroying native thread so that it does not wait forever.</p>
+     * 
+     * @param release true to release waiting native thread, false to restore normal behavior.
+     */
+    public void releaseBlockedDataInserts(boolean release) {
+        releaseDataInserts = release;
+    }
+
+    /**
+     * <p>When set to true, native thread waiting for space in event queue stops waiting and discards 
+     * the event. Used while destroying native thread so that it does not wait forever.</p>
+     * 
+     * @param release true to release waiting native thread, false to restore normal behavior.
+     */
+    public void releaseBlockedEventInserts(boolean release) {
+        releaseEventInserts = release;
+    }
+
+    /**
+     * <p>Sets how data chunks are batched before delivering to data listener. Chunks waiting in queue, and 
+     * those arriving within maxDelayNanos of starting a batch, are delivered as one contiguous chunk of at 
+     * the most maxBytes bytes made from at the most maxChunks chunks. Passing 0 as maxBytes disables batching.</p>
+     * 
+     * @param maxBytes maximum number of bytes in a batch, 0 to deliver every chunk as it is.
+     * @param maxChunks maximum number of chunks merged in a batch.
+     * @param maxDelayNanos maximum time to wait for more data before delivering a batch.
+     */
+    public void setDataBatching(int maxBytes, int maxChunks, long maxDelayNanos) {
+        mBatchMaxChunks = maxChunks;
+        mBatchMaxDelayNanos = maxDelayNanos;
+        mBatchMaxBytes = maxBytes;
+    }
+
+    /**
+     * <p>Gives drop counters and high watermarks of data and event queues in the order data chunks 
+     * dropped, data bytes dropped, data errors dropped, data queue high watermark, events dropped and 
+     * event queue high watermark.</p>
+     * 
+     * @return array containing queue statistics.
+     */
+    public long[] getQueueStatistics() {
+        long[] stats = new long[6];
+        stats[0] = dataChunksDropped.get();
+        stats[1] = dataBytesDropped.get();
+        stats[2] = dataErrorsDropped.get();
+        stats[3] = dataQueueHighWatermark.get();
+        stats[4] = eventsDropped.get();
+        stats[5] = eventQueueHighWatermark.get();
+        return stats;
+    }
+
+    /**
+     * <p>Gives snapshot of delivery statistics of data and event listeners served by this looper.</p>
+     * 
+     * @param portName name of port served by this looper.
+     * @return listener statistics.
+     */
+    public SerialComListenerStats getListenerStats(String portName) {
+        long dataQueueDepth = 0;
+        BlockingQueue<SerialComLeasedBuffer> leasedQueue = mLeasedDataQueue;
+        BlockingQueue<byte[]> dataQueue = mDataQueue;
+        if(leasedQueue != null) {
+            dataQueueDepth = leasedQueue.size();
+        }else if(dataQueue != null) {
+            dataQueueDepth = dataQueue.size();
+        }
+        long eventQueueDepth = 0;
+        BlockingQueue<SerialComLineEvent> eventQueue = mEventQueue;
+        if(eventQueue != null) {
+            eventQueueDepth = eventQueue.size() + (mCoalescedEventPending ? 1 : 0);
+        }
+
+        long[] counters = new long[10];
+        counters[0] = dataChunksDelivered.get();
+        counters[1] = dataBytesDelivered.get();
+        counters[2] = dataQueueDepth;
+        counters[3] = dataQueueHighWatermark.get();
+        counters[4] = dataChunksDropped.get();
+        counters[5] = dataBytesDropped.get();
+        counters[6] = eventsDelivered.get();
+        counters[7] = eventQueueDepth;
+        counters[8] = eventQueueHighWatermark.get();
+        counters[9] = eventsDropped.get();
+
+        return new SerialComListenerStats(portName, counters, mDataCallbackTime.getCounts(), mEventCallbackTime.getCounts(), 
+                mDataLatency.getCounts(), mEventLatency.getCounts());
     }
 
     /**
-     * <p>Data looper thread refrains from sending new data to the data listener.</p>
+     * <p>Data looper refrains from sending new data to the data listener.</p>
      */
     public void pause() {
         deliverDataEvent.set(false);
@@ -277,8 +1235,8 @@ public final class SerialComLooper {
      */
     public void resume() {
         deliverDataEvent.set(true);
-        mDataLock.notify();
-        mDataErrorLock.notify();
+        mDataLooper.schedule();
+        mDataErrorLooper.schedule();
     }
 
     /**
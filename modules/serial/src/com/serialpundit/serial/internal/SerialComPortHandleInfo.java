@@ -13,8 +13,11 @@
 
 package com.serialpundit.serial.internal;
 
+import javax.management.ObjectName;
+
 import com.serialpundit.serial.ISerialComDataListener;
 import com.serialpundit.serial.ISerialComEventListener;
+import com.serialpundit.serial.SerialComChannel;
 import com.serialpundit.serial.SerialComInByteStream;
 import com.serialpundit.serial.SerialComOutByteStream;
 
@@ -26,13 +29,16 @@ import com.serialpundit.serial.SerialComOutByteStream;
  */
 public final class SerialComPortHandleInfo {
 
-    private long mPortHandle = -1;
-    private String mOpenedPortName = null;
-    private SerialComLooper mLooper = null;
-    private ISerialComEventListener mEventListener = null;
-    private ISerialComDataListener mDataListener = null;
-    private SerialComInByteStream mSerialComInByteStream = null;
-    private SerialComOutByteStream mSerialComOutByteStream = null;
+    // Modified holding manager's lock but read without it, so fields are volatile.
+    private volatile long mPortHandle = -1;
+    private volatile String mOpenedPortName = null;
+    private volatile SerialComLooper mLooper = null;
+    private volatile ISerialComEventListener mEventListener = null;
+    private volatile ISerialComDataListener mDataListener = null;
+    private volatile SerialComInByteStream mSerialComInByteStream = null;
+    private volatile SerialComOutByteStream mSerialComOutByteStream = null;
+    private volatile SerialComChannel mSerialComChannel = null;
+    private volatile ObjectName mStatsMBeanName = null;
 
     /**
      * <p>Allocates a new SerialComPortHandleInfo object.</p>
@@ -219,4 +225,36 @@ public final class SerialComPortHandleInfo {
     public void setSerialComOutByteStream(SerialComOutByteStream serialComOutByteStream) {
         this.mSerialComOutByteStream  = serialComOutByteStream;
     }
+
+    /** 
+     * <p>Return SerialComChannel object associated with this handle. </p>
+     * @return channel for this port/handle
+     */
+    public SerialComChannel getSerialComChannel() {
+        return mSerialComChannel;
+    }
+
+    /** 
+     * <p>Set the SerialComChannel object associated with this handle. </p>
+     * @param serialComChannel channel for this port/handle
+     */
+    public void setSerialComChannel(SerialComChannel serialComChannel) {
+        this.mSerialComChannel = serialComChannel;
+    }
+
+    /** 
+     * <p>Gives name under which listener statistics MXBean of this port is registered. </p>
+     * @return name of MXBean or null if not registered.
+     */
+    public ObjectName getStatsMBeanName() {
+        return mStatsMBeanName;
+    }
+
+    /** 
+     * <p>Sets name under which listener statistics MXBean of this port is registered. </p>
+     * @param name name of MXBean or null when unregistered.
+     */
+    public void setStatsMBeanName(ObjectName name) {
+        mStatsMBeanName = name;
+    }
 }
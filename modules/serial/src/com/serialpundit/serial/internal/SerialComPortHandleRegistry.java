@@ -0,0 +1,188 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.internal;
+
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.CopyOnWriteArrayList;
+
+import com.serialpundit.serial.ISerialComDataListener;
+import com.serialpundit.serial.ISerialComEventListener;
+
+/**
+ * <p>Keeps information objects of all the opened ports, indexed by handle and by the event listener 
+ * registered for the port. Look ups are lock free and take constant time, so methods called very 
+ * frequently (read, write, configure etc.) do not contend with each other or with open/close.</p>
+ * 
+ * <p>Same event listener instance may be registered for more than one port, so each listener maps to 
+ * the list of information objects of all the ports it is registered for, in order of registration.</p>
+ * 
+ * <p>Modifications (port opened/closed, listener registered/unregistered) are serialized by the caller, 
+ * this class only guarantees that concurrent look ups see a consistent entry.</p>
+ * 
+ * <p>Listeners are matched by reference (same object), not by equals(), as done by 
+ * SerialComPortHandleInfo.containsEventListener() etc.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComPortHandleRegistry {
+
+    private final ConcurrentHashMap<Long, SerialComPortHandleInfo> mHandleInfo = new ConcurrentHashMap<Long, SerialComPortHandleInfo>();
+    private final ConcurrentHashMap<ListenerKey, CopyOnWriteArrayList<SerialComPortHandleInfo>> mEventListenerInfo = 
+            new ConcurrentHashMap<ListenerKey, CopyOnWriteArrayList<SerialComPortHandleInfo>>();
+
+    /*
+     * Wraps a listener so that map uses identity of listener object, application classes may 
+     * override equals()/hashCode().
+     */
+    private static final class ListenerKey {
+        private final Object mListener;
+
+        ListenerKey(Object listener) {
+            mListener = listener;
+        }
+
+        @Override
+        public int hashCode() {
+            return System.identityHashCode(mListener);
+        }
+
+        @Override
+        public boolean equals(Object obj) {
+            if(obj instanceof ListenerKey) {
+                return ((ListenerKey) obj).mListener == mListener;
+            }
+            return false;
+        }
+    }
+
+    /**
+     * <p>Gives information object for the given handle.</p>
+     * 
+     * @param handle handle of the opened port.
+     * @return information object or null if no port is opened with this handle.
+     */
+    public SerialComPortHandleInfo get(long handle) {
+        return mHandleInfo.get(handle);
+    }
+
+    /**
+     * <p>Adds information object of a newly opened port.</p>
+     * 
+     * @param handle handle of the opened port.
+     * @param handleInfo information object for this port.
+     */
+    public void put(long handle, SerialComPortHandleInfo handleInfo) {
+        mHandleInfo.put(handle, handleInfo);
+    }
+
+    /**
+     * <p>Removes information object of a port being closed, along with listeners registered for it.</p>
+     * 
+     * @param handle handle of the port.
+     * @return information object removed or null if no port is opened with this handle.
+     */
+    public SerialComPortHandleInfo remove(long handle) {
+        SerialComPortHandleInfo handleInfo = mHandleInfo.remove(handle);
+        if((handleInfo != null) && (handleInfo.getEventListener() != null)) {
+            removeEventListenerEntry(handleInfo.getEventListener(), handleInfo);
+        }
+        return handleInfo;
+    }
+
+    /**
+     * <p>Checks whether given port is opened. This iterates over all opened ports, it is called only while 
+     * opening a port.</p>
+     * 
+     * @param portName name of the port.
+     * @return true if port is opened at least once.
+     */
+    public boolean isPortOpened(String portName) {
+        for(SerialComPortHandleInfo handleInfo : mHandleInfo.values()) {
+            if(handleInfo.containsPort(portName)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * <p>Sets data listener in information object. Data listeners are always looked up through handle, 
+     * so they are not indexed.</p>
+     * 
+     * @param handleInfo information object of port.
+     * @param dataListener listener being registered or null when unregistering.
+     */
+    public void setDataListener(SerialComPortHandleInfo handleInfo, ISerialComDataListener dataListener) {
+        handleInfo.setDataListener(dataListener);
+    }
+
+    /**
+     * <p>Sets event listener in information object and adds information object to the ports indexed by 
+     * this listener. Other ports sharing the same listener are not affected.</p>
+     * 
+     * @param handleInfo information object of port.
+     * @param eventListener listener being registered or null when unregistering.
+     */
+    public void setEventListener(SerialComPortHandleInfo handleInfo, ISerialComEventListener eventListener) {
+        ISerialComEventListener previous = handleInfo.getEventListener();
+        if(previous != null) {
+            removeEventListenerEntry(previous, handleInfo);
+        }
+        handleInfo.setEventListener(eventListener);
+        if(eventListener != null) {
+            ListenerKey key = new ListenerKey(eventListener);
+            CopyOnWriteArrayList<SerialComPortHandleInfo> entries = mEventListenerInfo.get(key);
+            if(entries == null) {
+                entries = new CopyOnWriteArrayList<SerialComPortHandleInfo>();
+                mEventListenerInfo.put(key, entries);
+            }
+            entries.addIfAbsent(handleInfo);
+        }
+    }
+
+    /*
+     * Removes given port from the ports indexed by this listener, and the listener itself when no port 
+     * is left. Caller serializes modifications so list can not be re-added concurrently.
+     */
+    private void removeEventListenerEntry(ISerialComEventListener eventListener, SerialComPortHandleInfo handleInfo) {
+        ListenerKey key = new ListenerKey(eventListener);
+        CopyOnWriteArrayList<SerialComPortHandleInfo> entries = mEventListenerInfo.get(key);
+        if(entries != null) {
+            entries.remove(handleInfo);
+            if(entries.isEmpty()) {
+                mEventListenerInfo.remove(key);
+            }
+        }
+    }
+
+    /**
+     * <p>Gives information object of the port for which given event listener is registered. If the same 
+     * listener is registered for more than one port, the one registered first among those still 
+     * registered is given.</p>
+     * 
+     * @param eventListener registered event listener.
+     * @return information object or null if this listener is not registered.
+     */
+    public SerialComPortHandleInfo getByEventListener(ISerialComEventListener eventListener) {
+        CopyOnWriteArrayList<SerialComPortHandleInfo> entries = mEventListenerInfo.get(new ListenerKey(eventListener));
+        if(entries != null) {
+            for(SerialComPortHandleInfo handleInfo : entries) {
+                if(handleInfo.containsEventListener(eventListener)) {
+                    return handleInfo;
+                }
+            }
+        }
+        return null;
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ * This file is part of SerialPundit.
+ * 
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero 
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial 
+ * license for commercial use of this software. 
+ * 
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package com.serialpundit.serial.internal;
+
+import java.util.concurrent.Executor;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * <p>Small fixed pool of threads shared by all the loopers of a SerialComManager instance. Instead of 
+ * having dedicated data, data error and event looper threads for every port, a looper submits itself 
+ * to this reactor only when it has something to deliver. Thread count therefore scales with number of 
+ * processors, not with number of ports being listened.</p>
+ * 
+ * <p>Pool threads are daemon threads and exit when they stay idle for some time, they are re-created 
+ * when required.</p>
+ * 
+ * <p>A reactor with single thread is also used as dedicated delivery thread for a listener which asks 
+ * for DISPATCHPOLICY.DEDICATED, it is shut down when that listener is unregistered.</p>
+ * 
+ * @author Rishi Gupta
+ */
+public final class SerialComReactor implements Executor {
+
+    private final int IDLE_TIMEOUT_SECONDS = 60;
+    private final int mPoolSize;
+    private final String mName;
+    private ThreadPoolExecutor mPool = null;
+    private boolean mShutdown = false;
+
+    /**
+     * <p>Thread factory giving meaningful names to reactor threads.</p>
+     */
+    static final class ReactorThreadFactory implements ThreadFactory {
+
+        private static final AtomicInteger poolNumber = new AtomicInteger(1);
+        private final AtomicInteger threadNumber = new AtomicInteger(1);
+        private final String namePrefix;
+
+        ReactorThreadFactory(String name) {
+            if(name == null) {
+                namePrefix = "SerialPundit Reactor " + poolNumber.getAndIncrement() + " thread ";
+            }else {
+                namePrefix = name + " thread ";
+            }
+        }
+
+        @Override
+        public Thread newThread(Runnable r) {
+            Thread t = new Thread(r, namePrefix + threadNumber.getAndIncrement());
+            t.setDaemon(true);
+            return t;
+        }
+    }
+
+    /**
+     * <p>Allocates a new SerialComReactor object with one thread per available processor.</p>
+     */
+    public SerialComReactor() {
+        this(Runtime.getRuntime().availableProcessors());
+    }
+
+    /**
+     * <p>Allocates a new SerialComReactor object.</p>
+     * 
+     * @param poolSize maximum number of threads delivering data/events to listeners.
+     * @throws IllegalArgumentException if poolSize is zero or negative.
+     */
+    public SerialComReactor(int poolSize) {
+        this(poolSize, null);
+    }
+
+    /**
+     * <p>Allocates a new SerialComReactor object whose threads are named after the given name.</p>
+     * 
+     * @param poolSize maximum number of threads delivering data/events to listeners.
+     * @param name prefix for names of threads or null for default name.
+     * @throws IllegalArgumentException if poolSize is zero or negative.
+     */
+    public SerialComReactor(int poolSize, String name) {
+        if(poolSize <= 0) {
+            throw new IllegalArgumentException("Argument poolSize can not be negative or zero !");
+        }
+        mPoolSize = poolSize;
+        mName = name;
+    }
+
+    /*
+     * Threads are created only when first listener is registered.
+     */
+    private synchronized ThreadPoolExecutor getPool() {
+        if(mShutdown == true) {
+            throw new RejectedExecutionException("Reactor has been shut down !");
+        }
+        if(mPool == null) {
+            mPool = new ThreadPoolExecutor(mPoolSize, mPoolSize, IDLE_TIMEOUT_SECONDS, TimeUnit.SECONDS, 
+                    new LinkedBlockingQueue<Runnable>(), new ReactorThreadFactory(mName));
+            mPool.allowCoreThreadTimeOut(true);
+        }
+        return mPool;
+    }
+
+    /**
+     * <p>Runs the given looper task in one of the reactor threads.</p>
+     * 
+     * @param task looper task to be run.
+     */
+    @Override
+    public void execute(Runnable task) {
+        getPool().execute(task);
+    }
+
+    /**
+     * <p>Stops accepting new tasks, threads exit after finishing task being run. Submitting a task after 
+     * this results in RejectedExecutionException.</p>
+     */
+    public synchronized void shutdown() {
+        mShutdown = true;
+        if(mPool != null) {
+            mPool.shutdown();
+        }
+    }
+
+    /**
+     * <p>Returns maximum number of threads in this reactor.</p>
+     * 
+     * @return size of thread pool.
+     */
+    public int getPoolSize() {
+        return mPoolSize;
+    }
+}
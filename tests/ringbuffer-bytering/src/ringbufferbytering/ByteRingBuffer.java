@@ -0,0 +1,330 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package ringbufferbytering;
+
+import java.util.Arrays;
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+import com.serialpundit.core.util.SerialComByteRing;
+
+class Producer implements Runnable {
+
+	final SerialComByteRing ring;
+	final int count;
+
+	public Producer(SerialComByteRing ring, int count) {
+		this.ring = ring;
+		this.count = count;
+	}
+
+	@Override
+	public void run() {
+		try {
+			// byte at position n of stream is (byte) n, written in chunks of random size
+			Random random = new Random(1);
+			byte[] chunk = new byte[100];
+			int position = 0;
+			while(position < count) {
+				int length = Math.min(1 + random.nextInt(chunk.length), count - position);
+				for(int x = 0; x < length; x++) {
+					chunk[x] = (byte) (position + x);
+				}
+				if((position % 2) == 0) {
+					ring.put(chunk, 0, length);
+				}else {
+					int written = 0;
+					while(written < length) {
+						written += ring.offer(chunk, written, length - written, 10, TimeUnit.MILLISECONDS);
+					}
+				}
+				position += length;
+			}
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+class Consumer implements Runnable {
+
+	final SerialComByteRing ring;
+	final int count;
+	int received = 0;
+	int outOfOrder = 0;
+
+	public Consumer(SerialComByteRing ring, int count) {
+		this.ring = ring;
+		this.count = count;
+	}
+
+	@Override
+	public void run() {
+		try {
+			Random random = new Random(2);
+			byte[] data = new byte[100];
+			while(received < count) {
+				int length = 1 + random.nextInt(data.length);
+				int num;
+				if((received % 2) == 0) {
+					num = ring.take(data, 0, length);
+				}else {
+					num = ring.poll(data, 0, length, 10, TimeUnit.MILLISECONDS);
+				}
+				for(int x = 0; x < num; x++) {
+					if(data[x] != (byte) (received + x)) {
+						outOfOrder++;
+					}
+				}
+				received += num;
+			}
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+// Blocks in take() or put() and notes when it returned.
+class Blocked implements Runnable {
+
+	final SerialComByteRing ring;
+	final boolean taking;
+	final byte[] data;
+	volatile long returnedAt = 0;
+	volatile int result = -1;
+
+	public Blocked(SerialComByteRing ring, boolean taking, int length) {
+		this.ring = ring;
+		this.taking = taking;
+		this.data = new byte[length];
+	}
+
+	@Override
+	public void run() {
+		try {
+			if(taking == true) {
+				result = ring.take(data, 0, data.length);
+			}else {
+				ring.put(data, 0, data.length);
+				result = data.length;
+			}
+			returnedAt = System.nanoTime();
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+public final class ByteRingBuffer {
+
+	static int failures = 0;
+
+	static void check(String name, boolean passed) {
+		if(passed != true) {
+			failures++;
+			System.out.println("FAIL : " + name);
+		}
+	}
+
+	static byte[] pattern(int length, int seed) {
+		byte[] data = new byte[length];
+		for(int x = 0; x < length; x++) {
+			data[x] = (byte) (seed + x);
+		}
+		return data;
+	}
+
+	// moves read/write position of an empty ring to given index
+	static void moveTo(SerialComByteRing ring, int index) {
+		byte[] filler = new byte[index];
+		ring.write(filler, 0, index);
+		ring.read(filler, 0, index);
+	}
+
+	public static void main(String[] args) {
+		try {
+			check("capacity rounded to power of 2", new SerialComByteRing(10).capacity() == 16);
+			try {
+				new SerialComByteRing(0);
+				check("zero capacity rejected", false);
+			}catch (IllegalArgumentException e) {
+			}
+
+			// wrap around, data starting at every index of ring
+			for(int start = 0; start < 16; start++) {
+				SerialComByteRing ring = new SerialComByteRing(16);
+				moveTo(ring, start);
+				byte[] data = pattern(16, start);
+				check("write whole capacity, start " + start, ring.write(data, 0, 16) == 16);
+				check("full ring, start " + start, (ring.remaining() == 0) && (ring.available() == 16) && (ring.write(data, 0, 1) == 0));
+				byte[] peeked = new byte[16];
+				check("peek across wrap, start " + start, (ring.peek(peeked, 0, 16) == 16) && Arrays.equals(data, peeked));
+				check("peek byte across wrap, start " + start, ring.peek(15) == (data[15] & 0xFF));
+				byte[] read = new byte[20];
+				check("read across wrap, start " + start, (ring.read(read, 2, 18) == 16) && Arrays.equals(data, Arrays.copyOfRange(read, 2, 18)));
+				check("empty after read, start " + start, (ring.available() == 0) && (ring.read(read, 0, 1) == 0));
+			}
+
+			// random writes and reads compared with expected stream
+			SerialComByteRing ring = new SerialComByteRing(64);
+			Random random = new Random(56);
+			byte[] chunk = new byte[80];
+			int written = 0;
+			int consumed = 0;
+			int mismatch = 0;
+			for(int round = 0; round < 100000; round++) {
+				int length = random.nextInt(chunk.length);
+				for(int x = 0; x < length; x++) {
+					chunk[x] = (byte) (written + x);
+				}
+				int num = ring.write(chunk, 0, length);
+				if(num != Math.min(length, 64 - (written - consumed))) {
+					mismatch++;
+				}
+				written += num;
+				num = ring.read(chunk, 0, random.nextInt(chunk.length));
+				for(int x = 0; x < num; x++) {
+					if(chunk[x] != (byte) (consumed + x)) {
+						mismatch++;
+					}
+				}
+				consumed += num;
+			}
+			check("random writes and reads", (mismatch == 0) && (ring.available() == (written - consumed)));
+
+			// peek(int) gives unsigned value, -1 outside available bytes
+			ring = new SerialComByteRing(8);
+			ring.write(new byte[] { (byte) 0xFF, 0x01 }, 0, 2);
+			check("peek unsigned byte", ring.peek(0) == 255);
+			check("peek outside available bytes", (ring.peek(2) == -1) && (ring.peek(-1) == -1));
+
+			// indexOf over a wrapped frame
+			ring = new SerialComByteRing(16);
+			moveTo(ring, 13);
+			byte[] lines = "AB\nCD\n".getBytes("US-ASCII");
+			ring.write(lines, 0, lines.length);
+			check("indexOf first delimiter", ring.indexOf((byte) '\n', 0) == 2);
+			check("indexOf delimiter after wrap", ring.indexOf((byte) '\n', 3) == 5);
+			check("indexOf negative fromIndex", ring.indexOf((byte) 'A', -5) == 0);
+			check("indexOf not found", (ring.indexOf((byte) 'X', 0) == -1) && (ring.indexOf((byte) '\n', 6) == -1));
+			check("skip up to delimiter", (ring.skip(3) == 3) && (ring.peek(0) == 'C'));
+			check("skip negative", ring.skip(-1) == 0);
+			check("skip more than available", (ring.skip(100) == 3) && (ring.available() == 0));
+
+			// mark/reset re-reads bytes, marked bytes are not overwritten
+			ring = new SerialComByteRing(16);
+			moveTo(ring, 10);
+			byte[] frame = pattern(16, 40);
+			ring.write(frame, 0, 16);
+			ring.mark();
+			byte[] read = new byte[16];
+			ring.read(read, 0, 16);
+			check("marked bytes occupy space", (ring.available() == 0) && (ring.remaining() == 0) && (ring.write(frame, 0, 1) == 0));
+			ring.reset();
+			check("reset makes bytes available again", (ring.available() == 16) && (ring.read(read, 0, 16) == 16) && Arrays.equals(frame, read));
+			try {
+				ring.reset();
+				check("reset without mark rejected", false);
+			}catch (IllegalStateException e) {
+			}
+			ring.mark();
+			ring.write(frame, 0, 4);
+			ring.read(read, 0, 4);
+			ring.unmark();
+			check("unmark frees space", (ring.remaining() == 16) && (ring.available() == 0));
+			ring.write(frame, 0, 8);
+			ring.mark();
+			ring.clear();
+			check("clear discards bytes and mark", (ring.available() == 0) && (ring.remaining() == 16));
+			try {
+				ring.reset();
+				check("mark cleared by clear", false);
+			}catch (IllegalStateException e) {
+			}
+
+			// invalid arguments
+			try {
+				ring.write(null, 0, 1);
+				check("null array rejected", false);
+			}catch (NullPointerException e) {
+			}
+			try {
+				ring.read(read, 10, 7);
+				check("out of bounds rejected", false);
+			}catch (IndexOutOfBoundsException e) {
+			}
+
+			// take() blocks on empty ring until data is written
+			ring = new SerialComByteRing(16);
+			Blocked taker = new Blocked(ring, true, 8);
+			Thread t = new Thread(taker);
+			t.start();
+			Thread.sleep(200);
+			check("take blocks on empty ring", t.isAlive());
+			long writtenAt = System.nanoTime();
+			ring.write(frame, 0, 3);
+			t.join(5000);
+			long wakeup = TimeUnit.NANOSECONDS.toMillis(taker.returnedAt - writtenAt);
+			System.out.println("take wake up latency (ms) : " + wakeup);
+			check("take returns available bytes promptly", (t.isAlive() == false) && (taker.result == 3) && (wakeup < 50));
+
+			// poll() and offer() give up after timeout
+			long start = System.nanoTime();
+			int num = ring.poll(read, 0, 4, 100, TimeUnit.MILLISECONDS);
+			long waited = TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - start);
+			check("poll times out on empty ring", (num == 0) && (waited >= 90));
+			ring.write(frame, 0, 10);
+			start = System.nanoTime();
+			num = ring.offer(frame, 0, 10, 100, TimeUnit.MILLISECONDS);
+			waited = TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - start);
+			check("offer writes what fits and times out", (num == 6) && (ring.remaining() == 0) && (waited >= 90));
+
+			// put() blocks while marked bytes hold space, until mark is cleared
+			ring = new SerialComByteRing(16);
+			ring.write(frame, 0, 16);
+			ring.mark();
+			ring.read(read, 0, 16);
+			Blocked putter = new Blocked(ring, false, 4);
+			t = new Thread(putter);
+			t.start();
+			Thread.sleep(200);
+			check("put blocks while marked bytes fill ring", t.isAlive());
+			long unmarkedAt = System.nanoTime();
+			ring.unmark();
+			t.join(5000);
+			wakeup = TimeUnit.NANOSECONDS.toMillis(putter.returnedAt - unmarkedAt);
+			System.out.println("put wake up latency (ms) : " + wakeup);
+			check("put returns promptly after unmark", (t.isAlive() == false) && (ring.available() == 4) && (wakeup < 50));
+
+			// producer and consumer using blocking and timed methods with a small ring
+			final int count = 4000000;
+			ring = new SerialComByteRing(64);
+			Consumer consumer = new Consumer(ring, count);
+			Thread c = new Thread(consumer);
+			Thread p = new Thread(new Producer(ring, count));
+			start = System.nanoTime();
+			c.start();
+			p.start();
+			p.join(60000);
+			c.join(60000);
+			System.out.println("transfer time (ms) : " + TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - start));
+			check("all bytes received", (c.isAlive() == false) && (consumer.received == count));
+			check("bytes received in order", consumer.outOfOrder == 0);
+
+			System.out.println("failures : " + failures);
+		}catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
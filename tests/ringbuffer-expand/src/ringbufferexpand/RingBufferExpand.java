@@ -0,0 +1,146 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package ringbufferexpand;
+
+import java.util.ArrayList;
+import java.util.concurrent.TimeUnit;
+
+import com.serialpundit.core.util.RingArrayBlockingQueue;
+
+class Producer implements Runnable {
+
+	final RingArrayBlockingQueue<Integer> q;
+	final int count;
+
+	public Producer(RingArrayBlockingQueue<Integer> q, int count) {
+		this.q = q;
+		this.count = count;
+	}
+
+	@Override
+	public void run() {
+		try {
+			for(int x = 0; x < count; x++) {
+				q.put(x);
+			}
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+class Consumer implements Runnable {
+
+	final RingArrayBlockingQueue<Integer> q;
+	final int count;
+	int next = 0;
+	int outOfOrder = 0;
+
+	public Consumer(RingArrayBlockingQueue<Integer> q, int count) {
+		this.q = q;
+		this.count = count;
+	}
+
+	@Override
+	public void run() {
+		try {
+			while(next < count) {
+				int value = q.take();
+				if(value != next) {
+					outOfOrder++;
+				}
+				next = value + 1;
+				// slower than producer so that queue keeps expanding while elements are being removed
+				if((next % 1024) == 0) {
+					Thread.sleep(1);
+				}
+			}
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+public final class RingBufferExpand {
+
+	static int failures = 0;
+
+	static void check(String name, boolean passed) {
+		if(passed != true) {
+			failures++;
+			System.out.println("FAIL : " + name);
+		}
+	}
+
+	public static void main(String[] args) {
+		try {
+			// Expansion with head at every position of the initial ring, so that the elements are rolled
+			// over (split in two parts) in all possible ways when queue is expanded.
+			for(int start = 0; start < 8; start++) {
+				RingArrayBlockingQueue<Integer> q = new RingArrayBlockingQueue<Integer>(8, 4, 64);
+				for(int x = 0; x < start; x++) {
+					q.offer(-1);
+				}
+				for(int x = 0; x < start; x++) {
+					q.poll();
+				}
+
+				// fill initial ring, then expand it 3 times (8 -> 16 -> 32 -> 64)
+				int next = 0;
+				for(int x = 0; x < 40; x++) {
+					check("offer while expanding, head " + start + " element " + x, q.offer(next++));
+				}
+				check("size after expansion, head " + start, q.size() == 40);
+				check("expanded to max capacity, head " + start, q.remainingCapacity() == 24);
+
+				// remove some and wrap tail in the expanded ring, then fill it up to max capacity
+				int expected = 0;
+				for(int x = 0; x < 30; x++) {
+					check("order after expansion, head " + start, q.poll() == expected++);
+				}
+				for(int x = 0; x < 54; x++) {
+					check("offer in expanded ring, head " + start + " element " + x, q.offer(next++));
+				}
+				check("offer beyond max capacity fails, head " + start, q.offer(next) == false);
+
+				ArrayList<Integer> drained = new ArrayList<Integer>();
+				q.drainTo(drained);
+				check("drained count, head " + start, drained.size() == 64);
+				for(Integer value : drained) {
+					check("order of drained elements, head " + start, value == expected++);
+				}
+				check("queue empty, head " + start, q.isEmpty() && (q.poll() == null));
+			}
+
+			// queue expanding from 2 elements while consumer is removing elements concurrently
+			final int count = 1000000;
+			RingArrayBlockingQueue<Integer> q = new RingArrayBlockingQueue<Integer>(2, 1, 1 << 16);
+			Consumer consumer = new Consumer(q, count);
+			Thread c = new Thread(consumer);
+			Thread p = new Thread(new Producer(q, count));
+			long begin = System.nanoTime();
+			c.start();
+			p.start();
+			p.join(60000);
+			c.join(60000);
+			System.out.println("transfer time (ms) : " + TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - begin));
+			check("all elements received", (c.isAlive() == false) && (consumer.next == count));
+			check("elements received in order", consumer.outOfOrder == 0);
+
+			System.out.println("failures : " + failures);
+		}catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
@@ -0,0 +1,169 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package ringbufferputwait;
+
+import java.util.concurrent.TimeUnit;
+
+import com.serialpundit.core.util.RingArrayBlockingQueue;
+
+class Producer implements Runnable {
+
+	final RingArrayBlockingQueue<Integer> q;
+	final int id;
+	final int count;
+
+	public Producer(RingArrayBlockingQueue<Integer> q, int id, int count) {
+		this.q = q;
+		this.id = id;
+		this.count = count;
+	}
+
+	@Override
+	public void run() {
+		try {
+			// element carries producer id in upper bits and sequence number in lower bits
+			for(int x = 0; x < count; x++) {
+				q.put((id << 24) | x);
+			}
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+class Consumer implements Runnable {
+
+	final RingArrayBlockingQueue<Integer> q;
+	final int total;
+	final int[] next;
+	int received = 0;
+	int outOfOrder = 0;
+
+	public Consumer(RingArrayBlockingQueue<Integer> q, int producers, int total) {
+		this.q = q;
+		this.total = total;
+		next = new int[producers];
+	}
+
+	@Override
+	public void run() {
+		try {
+			while(received < total) {
+				int value = q.take();
+				int id = value >>> 24;
+				int seq = value & 0xFFFFFF;
+				if(seq != next[id]) {
+					outOfOrder++;
+				}
+				next[id] = seq + 1;
+				received++;
+			}
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+class BlockedPut implements Runnable {
+
+	final RingArrayBlockingQueue<Integer> q;
+	volatile long returnedAt = 0;
+
+	public BlockedPut(RingArrayBlockingQueue<Integer> q) {
+		this.q = q;
+	}
+
+	@Override
+	public void run() {
+		try {
+			q.put(100);
+			returnedAt = System.nanoTime();
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+public final class RingBufferPutWait {
+
+	static int failures = 0;
+
+	static void check(String name, boolean passed) {
+		System.out.println((passed ? "PASS : " : "FAIL : ") + name);
+		if(passed != true) {
+			failures++;
+		}
+	}
+
+	public static void main(String[] args) {
+		try {
+			// put() on a full queue which can not expand must return as soon as an element is removed,
+			// not after a polling interval.
+			RingArrayBlockingQueue<Integer> q = new RingArrayBlockingQueue<Integer>(4, 1, 4);
+			for(int x = 0; x < 4; x++) {
+				q.put(x);
+			}
+			check("offer on full queue fails", q.offer(4) == false);
+			BlockedPut blocked = new BlockedPut(q);
+			Thread t = new Thread(blocked);
+			t.start();
+			Thread.sleep(200);
+			check("put blocks while queue is full", t.isAlive() && (q.size() == 4));
+			long removedAt = System.nanoTime();
+			Integer head = q.take();
+			t.join(5000);
+			long wakeup = TimeUnit.NANOSECONDS.toMillis(blocked.returnedAt - removedAt);
+			System.out.println("put wake up latency (ms) : " + wakeup);
+			check("put returns promptly after take", (t.isAlive() == false) && (wakeup < 50));
+			check("order after blocked put", (head == 0) && (q.poll() == 1) && (q.poll() == 2) && (q.poll() == 3) && (q.poll() == 100));
+
+			// timed offer on full queue gives up after timeout
+			for(int x = 0; x < 4; x++) {
+				q.put(x);
+			}
+			long start = System.nanoTime();
+			boolean inserted = q.offer(4, 100, TimeUnit.MILLISECONDS);
+			long waited = TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - start);
+			check("timed offer times out on full queue", (inserted == false) && (waited >= 90));
+			q.clear();
+
+			// ordering under load, several producers blocked on a small full queue; elements of each
+			// producer must come out in the order they were put.
+			final int producers = 4;
+			final int count = 250000;
+			q = new RingArrayBlockingQueue<Integer>(8, 8, 16);
+			Consumer consumer = new Consumer(q, producers, producers * count);
+			Thread c = new Thread(consumer);
+			Thread[] p = new Thread[producers];
+			start = System.nanoTime();
+			c.start();
+			for(int x = 0; x < producers; x++) {
+				p[x] = new Thread(new Producer(q, x, count));
+				p[x].start();
+			}
+			for(int x = 0; x < producers; x++) {
+				p[x].join(60000);
+			}
+			c.join(60000);
+			System.out.println("transfer time (ms) : " + TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - start));
+			check("all elements received", (c.isAlive() == false) && (consumer.received == (producers * count)));
+			check("elements of each producer received in order", consumer.outOfOrder == 0);
+			check("queue empty", q.isEmpty());
+
+			System.out.println("failures : " + failures);
+		}catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
@@ -0,0 +1,179 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package ringbufferspsc;
+
+import java.util.ArrayList;
+import java.util.concurrent.TimeUnit;
+
+import com.serialpundit.core.util.SPSCRingArrayBlockingQueue;
+
+class Producer implements Runnable {
+
+	final SPSCRingArrayBlockingQueue<Integer> q;
+	final int count;
+
+	public Producer(SPSCRingArrayBlockingQueue<Integer> q, int count) {
+		this.q = q;
+		this.count = count;
+	}
+
+	@Override
+	public void run() {
+		try {
+			for(int x = 0; x < count; x++) {
+				// mix of all insertion methods
+				if((x % 3) == 0) {
+					q.put(x);
+				}else if((x % 3) == 1) {
+					while(q.offer(x) == false) {
+						Thread.yield();
+					}
+				}else {
+					while(q.offer(x, 10, TimeUnit.MILLISECONDS) == false) {
+					}
+				}
+			}
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+class Consumer implements Runnable {
+
+	final SPSCRingArrayBlockingQueue<Integer> q;
+	final int count;
+	int next = 0;
+	int outOfOrder = 0;
+
+	public Consumer(SPSCRingArrayBlockingQueue<Integer> q, int count) {
+		this.q = q;
+		this.count = count;
+	}
+
+	void verify(int value) {
+		if(value != next) {
+			outOfOrder++;
+		}
+		next = value + 1;
+	}
+
+	@Override
+	public void run() {
+		ArrayList<Integer> drained = new ArrayList<Integer>();
+		try {
+			while(next < count) {
+				// mix of all removal methods
+				if((next % 4) == 0) {
+					verify(q.take());
+				}else if((next % 4) == 1) {
+					Integer value = q.poll();
+					if(value != null) {
+						verify(value);
+					}
+				}else if((next % 4) == 2) {
+					Integer value = q.poll(10, TimeUnit.MILLISECONDS);
+					if(value != null) {
+						verify(value);
+					}
+				}else {
+					drained.clear();
+					q.drainTo(drained, 16);
+					for(Integer value : drained) {
+						verify(value);
+					}
+				}
+			}
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+class BlockedPut implements Runnable {
+
+	final SPSCRingArrayBlockingQueue<Integer> q;
+	volatile long returnedAt = 0;
+
+	public BlockedPut(SPSCRingArrayBlockingQueue<Integer> q) {
+		this.q = q;
+	}
+
+	@Override
+	public void run() {
+		try {
+			q.put(100);
+			returnedAt = System.nanoTime();
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+public final class SPSCRingBuffer {
+
+	static int failures = 0;
+
+	static void check(String name, boolean passed) {
+		System.out.println((passed ? "PASS : " : "FAIL : ") + name);
+		if(passed != true) {
+			failures++;
+		}
+	}
+
+	public static void main(String[] args) {
+		try {
+			// ordering under load, small capacity so that both threads find queue full/empty very often
+			// and sequence counters wrap around the ring many times.
+			final int count = 2000000;
+			SPSCRingArrayBlockingQueue<Integer> q = new SPSCRingArrayBlockingQueue<Integer>(60);
+			check("capacity rounded to power of 2", q.capacity() == 64);
+			Consumer consumer = new Consumer(q, count);
+			Thread c = new Thread(consumer);
+			Thread p = new Thread(new Producer(q, count));
+			long start = System.nanoTime();
+			c.start();
+			p.start();
+			p.join(60000);
+			c.join(60000);
+			System.out.println("transfer time (ms) : " + TimeUnit.NANOSECONDS.toMillis(System.nanoTime() - start));
+			check("all elements received", (c.isAlive() == false) && (consumer.next == count));
+			check("elements received in order", consumer.outOfOrder == 0);
+			check("queue empty", q.isEmpty() && (q.size() == 0) && (q.remainingCapacity() == 64));
+
+			// put() on a full queue must return as soon as consumer takes an element.
+			q = new SPSCRingArrayBlockingQueue<Integer>(4);
+			for(int x = 0; x < 4; x++) {
+				q.offer(x);
+			}
+			check("offer on full queue fails", q.offer(4) == false);
+			BlockedPut blocked = new BlockedPut(q);
+			Thread t = new Thread(blocked);
+			t.start();
+			Thread.sleep(200);
+			check("put blocks while queue is full", t.isAlive() && (q.size() == 4));
+			long removedAt = System.nanoTime();
+			Integer head = q.poll();
+			t.join(5000);
+			long wakeup = TimeUnit.NANOSECONDS.toMillis(blocked.returnedAt - removedAt);
+			System.out.println("put wake up latency (ms) : " + wakeup);
+			check("put returns promptly after poll", (t.isAlive() == false) && (wakeup < 50));
+			check("order after blocked put", (head == 0) && (q.poll() == 1) && (q.poll() == 2) && (q.poll() == 3) && (q.poll() == 100));
+
+			System.out.println("failures : " + failures);
+		}catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
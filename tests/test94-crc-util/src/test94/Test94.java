@@ -0,0 +1,142 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package test94;
+
+import java.nio.ByteBuffer;
+import java.util.Random;
+
+import com.serialpundit.core.util.SerialComCRCUtil;
+
+// Verifies slicing-by-8 CRC engines of SerialComCRCUtil against standard check values and bit by bit
+// reference implementations, and that incremental update gives same result as one shot calculation.
+public class Test94 {
+
+	static int checks = 0;
+	static int failures = 0;
+
+	static void check(String name, int expected, int actual) {
+		checks++;
+		if(expected != actual) {
+			failures++;
+			System.out.println("FAIL : " + name + " expected 0x" + Integer.toHexString(expected) + " got 0x" + Integer.toHexString(actual));
+		}
+	}
+
+	// bit by bit, least significant bit first
+	static int refReflected(int rpoly, int crc, byte[] data, int offset, int length) {
+		for(int x = offset; x < offset + length; x++) {
+			crc ^= data[x] & 0xFF;
+			for(int i = 0; i < 8; i++) {
+				crc = ((crc & 1) != 0) ? ((crc >>> 1) ^ rpoly) : (crc >>> 1);
+			}
+		}
+		return crc;
+	}
+
+	// bit by bit, most significant bit first, 16 bit
+	static int refMSBFirst16(int poly, int crc, byte[] data, int offset, int length) {
+		for(int x = offset; x < offset + length; x++) {
+			crc ^= (data[x] & 0xFF) << 8;
+			for(int i = 0; i < 8; i++) {
+				crc = ((crc & 0x8000) != 0) ? ((crc << 1) ^ poly) : (crc << 1);
+				crc &= 0xFFFF;
+			}
+		}
+		return crc;
+	}
+
+	public static void main(String[] args) {
+		try {
+			SerialComCRCUtil crcUtil = new SerialComCRCUtil();
+			byte[] checkData = "123456789".getBytes("US-ASCII");
+			int last = checkData.length - 1;
+
+			// standard check values of "123456789"
+			check("CRC-8 Dallas 1-wire check", 0xA1, crcUtil.getCRC8Dallas1WireValue(checkData, 0, last));
+			check("CRC-16 check", 0xBB3D, crcUtil.getCRC16Value(checkData, 0, last));
+			check("CRC-16-CCITT (xmodem) check", 0x31C3, crcUtil.getCRC16CCITTValue(checkData, 0, last));
+			check("CRC-16-IBM (modbus) check", 0x4B37, crcUtil.getCRC16IBMValue(checkData, 0, last));
+			// CRC-16/DNP check value is 0xEA82, DNP variant gives it byte swapped
+			check("CRC-16-DNP check", 0x82EA, crcUtil.getCRC16DNPValue(checkData, 0, last));
+
+			// random data of every length from 0 to 64 covers 8 byte blocks and tail, compared with bitwise
+			// reference, incremental update split at every index and heap/direct byte buffers.
+			Random random = new Random(94);
+			for(int length = 0; length <= 64; length++) {
+				byte[] data = new byte[length + 3];
+				random.nextBytes(data);
+				int offset = 3;
+
+				int dallas = refReflected(0x8C, 0x00, data, offset, length);
+				int crc16 = refReflected(0xA001, 0x0000, data, offset, length);
+				int ccitt = refMSBFirst16(0x1021, 0x0000, data, offset, length);
+				int dnp = crcUtil.finishCRC16DNP(refReflected(0xA6BC, 0x0000, data, offset, length));
+				int ibm = refReflected(0xA001, 0xFFFF, data, offset, length);
+
+				if(length > 0) {
+					int end = offset + length - 1;
+					check("Dallas one shot, length " + length, dallas, crcUtil.getCRC8Dallas1WireValue(data, offset, end));
+					check("CRC-16 one shot, length " + length, crc16, crcUtil.getCRC16Value(data, offset, end));
+					check("CCITT one shot, length " + length, ccitt, crcUtil.getCRC16CCITTValue(data, offset, end));
+					check("DNP one shot, length " + length, dnp, crcUtil.getCRC16DNPValue(data, offset, end));
+					check("IBM one shot, length " + length, ibm, crcUtil.getCRC16IBMValue(data, offset, end));
+				}
+
+				for(int split = 0; split <= length; split++) {
+					int s = offset + split;
+					int r = length - split;
+					check("Dallas incremental, length " + length + " split " + split, dallas,
+							crcUtil.updateCRC8Dallas1Wire(crcUtil.updateCRC8Dallas1Wire(0x00, data, offset, split), data, s, r));
+					check("CRC-16 incremental, length " + length + " split " + split, crc16,
+							crcUtil.updateCRC16(crcUtil.updateCRC16(0x0000, data, offset, split), data, s, r));
+					check("CCITT incremental, length " + length + " split " + split, ccitt,
+							crcUtil.updateCRC16CCITT(crcUtil.updateCRC16CCITT(0x0000, data, offset, split), data, s, r));
+					check("DNP incremental, length " + length + " split " + split, dnp, crcUtil.finishCRC16DNP(
+							crcUtil.updateCRC16DNP(crcUtil.updateCRC16DNP(0x0000, data, offset, split), data, s, r)));
+					check("IBM incremental, length " + length + " split " + split, ibm,
+							crcUtil.updateCRC16IBM(crcUtil.updateCRC16IBM(0xFFFF, data, offset, split), data, s, r));
+				}
+
+				ByteBuffer heap = ByteBuffer.wrap(data, offset, length).slice();
+				ByteBuffer direct = ByteBuffer.allocateDirect(length);
+				direct.put(data, offset, length);
+				direct.flip();
+				check("CCITT heap buffer, length " + length, ccitt, crcUtil.updateCRC16CCITT(0x0000, heap));
+				check("heap buffer position advanced, length " + length, heap.limit(), heap.position());
+				check("CCITT direct buffer, length " + length, ccitt, crcUtil.updateCRC16CCITT(0x0000, direct));
+				direct.rewind();
+				check("Dallas direct buffer, length " + length, dallas, crcUtil.updateCRC8Dallas1Wire(0x00, direct));
+				direct.rewind();
+				check("IBM direct buffer, length " + length, ibm, crcUtil.updateCRC16IBM(0xFFFF, direct));
+			}
+
+			// Dallas CRC with every byte value including 0x80 to 0xFF (negative in java byte), alone and in
+			// a block long enough to use 8 byte path.
+			byte[] all = new byte[256];
+			for(int x = 0; x < 256; x++) {
+				all[x] = (byte) x;
+				check("Dallas byte 0x" + Integer.toHexString(x), refReflected(0x8C, 0x00, all, x, 1),
+						crcUtil.getCRC8Dallas1WireValue(all, x, x));
+			}
+			check("Dallas bytes 0x80 to 0xFF", refReflected(0x8C, 0x00, all, 128, 128),
+					crcUtil.getCRC8Dallas1WireValue(all, 128, 255));
+			check("Dallas bytes 0x00 to 0xFF", refReflected(0x8C, 0x00, all, 0, 256),
+					crcUtil.getCRC8Dallas1WireValue(all, 0, 255));
+
+			System.out.println("checks : " + checks + ", failures : " + failures);
+		}catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
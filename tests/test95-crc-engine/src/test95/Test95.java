@@ -0,0 +1,172 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package test95;
+
+import java.nio.ByteBuffer;
+import java.util.Random;
+import java.util.zip.CRC32;
+
+import com.serialpundit.core.util.SerialComCRC;
+import com.serialpundit.core.util.SerialComCRCSpec;
+import com.serialpundit.core.util.SerialComCRCUtil;
+
+// Verifies generic CRC engine SerialComCRC against catalogue check values for predefined and custom
+// specifications (width 3 to 64, reflected and not), a bit by bit reference, java.util.zip.CRC32 and
+// SerialComCRCUtil, and that incremental update gives same result as one shot calculation.
+public class Test95 {
+
+	static int checks = 0;
+	static int failures = 0;
+
+	static void check(String name, long expected, long actual) {
+		checks++;
+		if(expected != actual) {
+			failures++;
+			System.out.println("FAIL : " + name + " expected 0x" + Long.toHexString(expected) + " got 0x" + Long.toHexString(actual));
+		}
+	}
+
+	static long reflect(long value, int width) {
+		long result = 0;
+		for(int x = 0; x < width; x++) {
+			result = (result << 1) | (value & 1L);
+			value = value >>> 1;
+		}
+		return result;
+	}
+
+	// bit by bit, works for any width
+	static long reference(SerialComCRCSpec spec, byte[] data, int offset, int length) {
+		int width = spec.getWidth();
+		long mask = (width == 64) ? -1L : ((1L << width) - 1);
+		long top = 1L << (width - 1);
+		long crc = spec.getInit();
+		for(int x = offset; x < offset + length; x++) {
+			int b = data[x] & 0xFF;
+			if(spec.isRefin()) {
+				b = (int) reflect(b, 8);
+			}
+			for(int i = 7; i >= 0; i--) {
+				boolean bit = ((b >>> i) & 1) != 0;
+				boolean msb = (crc & top) != 0;
+				crc = (crc << 1) & mask;
+				if(bit ^ msb) {
+					crc ^= spec.getPoly();
+				}
+			}
+		}
+		if(spec.isRefout()) {
+			crc = reflect(crc, width);
+		}
+		return (crc ^ spec.getXorout()) & mask;
+	}
+
+	public static void main(String[] args) {
+		try {
+			SerialComCRCSpec[] specs = new SerialComCRCSpec[] {
+					SerialComCRCSpec.CRC8_MAXIM, SerialComCRCSpec.CRC16_ARC, SerialComCRCSpec.CRC16_XMODEM,
+					SerialComCRCSpec.CRC16_KERMIT, SerialComCRCSpec.CRC16_CCITT_FALSE, SerialComCRCSpec.CRC16_MODBUS,
+					SerialComCRCSpec.CRC16_DNP, SerialComCRCSpec.CRC32, SerialComCRCSpec.CRC32C, SerialComCRCSpec.CRC32_MPEG2,
+					new SerialComCRCSpec(3, 0x3L, 0x0L, false, false, 0x7L),                                   // CRC-3/GSM
+					new SerialComCRCSpec(5, 0x05L, 0x1FL, true, true, 0x1FL),                                  // CRC-5/USB
+					new SerialComCRCSpec(12, 0x80FL, 0x000L, false, true, 0x000L),                             // CRC-12/UMTS
+					new SerialComCRCSpec(64, 0x42F0E1EBA9EA3693L, -1L, true, true, -1L),                      // CRC-64/XZ
+					new SerialComCRCSpec(64, 0x42F0E1EBA9EA3693L, 0L, false, false, 0L) };                    // CRC-64/ECMA-182
+			long[] checkValues = new long[] {
+					0xA1L, 0xBB3DL, 0x31C3L,
+					0x2189L, 0x29B1L, 0x4B37L,
+					0xEA82L, 0xCBF43926L, 0xE3069283L, 0x0376E6E7L,
+					0x4L,
+					0x19L,
+					0xDAFL,
+					0x995DC9BBDF1939FAL,
+					0x6C40DF5F0B497347L };
+
+			// standard check values of "123456789", one shot and byte by byte
+			byte[] checkData = "123456789".getBytes("US-ASCII");
+			for(int x = 0; x < specs.length; x++) {
+				check("check value " + specs[x], checkValues[x], SerialComCRC.calculate(specs[x], checkData, 0, checkData.length));
+				check("reference check value " + specs[x], checkValues[x], reference(specs[x], checkData, 0, checkData.length));
+				SerialComCRC crc = new SerialComCRC(specs[x]);
+				for(int i = 0; i < checkData.length; i++) {
+					crc.update(checkData[i]);
+				}
+				check("byte by byte check value " + specs[x], checkValues[x], crc.getValue());
+			}
+
+			// random data of every length from 0 to 64 covers 8 byte blocks and tail
+			Random random = new Random(95);
+			CRC32 zipCrc = new CRC32();
+			for(int length = 0; length <= 64; length++) {
+				byte[] data = new byte[length + 5];
+				random.nextBytes(data);
+				int offset = 5;
+
+				for(int x = 0; x < specs.length; x++) {
+					long expected = reference(specs[x], data, offset, length);
+					check("one shot " + specs[x] + ", length " + length, expected, SerialComCRC.calculate(specs[x], data, offset, length));
+
+					// split at every index, same object reused after reset
+					SerialComCRC crc = new SerialComCRC(specs[x]);
+					for(int split = 0; split <= length; split++) {
+						crc.reset();
+						crc.update(data, offset, split);
+						crc.update(data, offset + split, length - split);
+						check("incremental " + specs[x] + ", length " + length + " split " + split, expected, crc.getValue());
+					}
+
+					crc.reset();
+					ByteBuffer direct = ByteBuffer.allocateDirect(length);
+					direct.put(data, offset, length);
+					direct.flip();
+					crc.update(direct);
+					check("direct buffer " + specs[x] + ", length " + length, expected, crc.getValue());
+					check("direct buffer position advanced, length " + length, direct.limit(), direct.position());
+
+					crc.reset();
+					crc.update(ByteBuffer.wrap(data, offset, length));
+					check("heap buffer " + specs[x] + ", length " + length, expected, crc.getValue());
+				}
+
+				zipCrc.reset();
+				zipCrc.update(data, offset, length);
+				check("java.util.zip.CRC32, length " + length, zipCrc.getValue(), SerialComCRC.calculate(SerialComCRCSpec.CRC32, data, offset, length));
+
+				// same algorithms in SerialComCRCUtil must agree
+				if(length > 0) {
+					SerialComCRCUtil crcUtil = new SerialComCRCUtil();
+					int end = offset + length - 1;
+					check("CRC8_MAXIM vs Dallas 1-wire, length " + length, crcUtil.getCRC8Dallas1WireValue(data, offset, end),
+							SerialComCRC.calculate(SerialComCRCSpec.CRC8_MAXIM, data, offset, length));
+					check("CRC16_ARC vs CRC-16, length " + length, crcUtil.getCRC16Value(data, offset, end),
+							SerialComCRC.calculate(SerialComCRCSpec.CRC16_ARC, data, offset, length));
+					check("CRC16_XMODEM vs CRC-16-CCITT, length " + length, crcUtil.getCRC16CCITTValue(data, offset, end),
+							SerialComCRC.calculate(SerialComCRCSpec.CRC16_XMODEM, data, offset, length));
+					check("CRC16_MODBUS vs CRC-16-IBM, length " + length, crcUtil.getCRC16IBMValue(data, offset, end),
+							SerialComCRC.calculate(SerialComCRCSpec.CRC16_MODBUS, data, offset, length));
+				}
+			}
+
+			// equal specifications share tables, they must also be equal as map keys
+			SerialComCRCSpec copy = new SerialComCRCSpec(32, 0x04C11DB7L, 0xFFFFFFFFL, true, true, 0xFFFFFFFFL);
+			check("equal spec", 1, copy.equals(SerialComCRCSpec.CRC32) ? 1 : 0);
+			check("equal spec hash code", SerialComCRCSpec.CRC32.hashCode(), copy.hashCode());
+			check("different spec", 0, SerialComCRCSpec.CRC32.equals(SerialComCRCSpec.CRC32C) ? 1 : 0);
+
+			System.out.println("checks : " + checks + ", failures : " + failures);
+		}catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
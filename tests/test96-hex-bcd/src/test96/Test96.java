@@ -0,0 +1,148 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package test96;
+
+import java.nio.ByteBuffer;
+import java.nio.CharBuffer;
+import java.util.Arrays;
+import java.util.Random;
+
+import com.serialpundit.core.util.SerialComUtil;
+
+// Verifies round trips of hex encode/decode methods of SerialComUtil against each other and against
+// byteArrayToHexString/hexStringToByteArray, and BCD decoding against String.format for every value.
+public class Test96 {
+
+	static int checks = 0;
+	static int failures = 0;
+
+	static void check(String name, boolean passed) {
+		checks++;
+		if(passed != true) {
+			failures++;
+			System.out.println("FAIL : " + name);
+		}
+	}
+
+	public static void main(String[] args) {
+		try {
+			// output 48:45:4C:4C:4F:20:57:4F:52:4C:44
+			byte[] hello = "HELLO WORLD".getBytes("US-ASCII");
+			StringBuilder sb = new StringBuilder();
+			SerialComUtil.appendHex(sb, hello, 0, hello.length, ":");
+			System.out.println(sb);
+			check("appendHex with separator", "48:45:4C:4C:4F:20:57:4F:52:4C:44".equals(sb.toString()));
+
+			Random random = new Random(96);
+			for(int length = 0; length <= 300; length += (length < 20) ? 1 : 37) {
+				byte[] data = new byte[length + 2];
+				random.nextBytes(data);
+				int offset = 2;
+				byte[] expected = Arrays.copyOfRange(data, offset, offset + length);
+				String hex = SerialComUtil.byteArrayToHexString(expected, null);
+
+				// char array, with offset in destination
+				char[] chars = new char[(2 * length) + 1];
+				int count = SerialComUtil.encodeHex(data, offset, length, chars, 1);
+				check("encodeHex char[] count, length " + length, count == (2 * length));
+				check("encodeHex char[], length " + length, hex.equals(new String(chars, 1, count)));
+
+				byte[] decoded = new byte[length + 1];
+				count = SerialComUtil.decodeHex(new String(chars, 1, 2 * length), 0, 2 * length, decoded, 1);
+				check("decodeHex byte[] count, length " + length, count == length);
+				check("decodeHex byte[], length " + length, Arrays.equals(expected, Arrays.copyOfRange(decoded, 1, 1 + length)));
+
+				// heap and direct char/byte buffers
+				CharBuffer charBuf = CharBuffer.allocate(2 * length);
+				SerialComUtil.encodeHex(data, offset, length, charBuf);
+				charBuf.flip();
+				check("encodeHex CharBuffer, length " + length, hex.contentEquals(charBuf));
+
+				ByteBuffer ascii = ByteBuffer.allocateDirect(2 * length);
+				SerialComUtil.encodeHex(data, offset, length, ascii);
+				ascii.flip();
+				byte[] asciiBytes = new byte[ascii.remaining()];
+				ascii.get(asciiBytes);
+				check("encodeHex ByteBuffer, length " + length, hex.equals(new String(asciiBytes, "US-ASCII")));
+
+				ByteBuffer direct = ByteBuffer.allocateDirect(length);
+				count = SerialComUtil.decodeHex(charBuf, direct);
+				direct.flip();
+				byte[] directBytes = new byte[direct.remaining()];
+				direct.get(directBytes);
+				check("decodeHex ByteBuffer, length " + length, (count == length) && Arrays.equals(expected, directBytes));
+
+				// lower case, white spaces and 0x prefixes are accepted by every decoder
+				StringBuilder loose = new StringBuilder();
+				for(int x = 0; x < length; x++) {
+					loose.append((x % 3 == 0) ? " 0x" : "\t").append(hex.substring(2 * x, (2 * x) + 2).toLowerCase());
+				}
+				decoded = new byte[length];
+				count = SerialComUtil.decodeHex(loose, 0, loose.length(), decoded, 0);
+				check("decodeHex loose format, length " + length, (count == length) && Arrays.equals(expected, decoded));
+				check("hexStringToByteArray loose format, length " + length,
+						Arrays.equals(expected, SerialComUtil.hexStringToByteArray(loose.toString())));
+
+				// separator is placed between values only
+				sb.setLength(0);
+				SerialComUtil.appendHex(sb, data, offset, length, ", ");
+				check("appendHex, length " + length, sb.toString().equals(SerialComUtil.byteArrayToHexString(expected, ", ")));
+			}
+
+			// invalid input is rejected and destination is left untouched
+			byte[] untouched = new byte[4];
+			try {
+				SerialComUtil.decodeHex("ABC", 0, 3, untouched, 0);
+				check("odd number of digits rejected", false);
+			}catch (IllegalArgumentException e) {
+				check("odd number of digits rejected", true);
+			}
+			try {
+				SerialComUtil.decodeHex("AB G1", 0, 5, untouched, 0);
+				check("invalid character rejected", false);
+			}catch (IllegalArgumentException e) {
+				check("invalid character rejected", true);
+			}
+			check("destination untouched on error", Arrays.equals(new byte[4], untouched));
+			try {
+				SerialComUtil.decodeHex("A1B2C3", 0, 6, untouched, 2);
+				check("small destination rejected", false);
+			}catch (IndexOutOfBoundsException e) {
+				check("small destination rejected", true);
+			}
+
+			// BCD, every value must give same string as String.format
+			System.out.println(SerialComUtil.decodeBCD((short) 0x0200));
+			for(int x = 0; x <= 0xFFFF; x++) {
+				short bcd = (short) x;
+				String expected = String.format("%x.%02x", (bcd & 0xFF00) >> 8, bcd & 0x00FF);
+				if(expected.equals(SerialComUtil.decodeBCD(bcd)) != true) {
+					check("decodeBCD 0x" + Integer.toHexString(x), false);
+				}
+				sb.setLength(0);
+				sb.append('v');
+				SerialComUtil.appendBCD(sb, bcd);
+				if(sb.toString().equals("v" + expected) != true) {
+					check("appendBCD 0x" + Integer.toHexString(x), false);
+				}
+			}
+			check("decodeBCD 2.00", "2.00".equals(SerialComUtil.decodeBCD((short) 0x0200)));
+			check("decodeBCD 11.10", "11.10".equals(SerialComUtil.decodeBCD((short) 0x1110)));
+
+			System.out.println("checks : " + checks + ", failures : " + failures);
+		}catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
@@ -0,0 +1,205 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package test97;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+
+import com.serialpundit.core.util.SerialComUtil;
+import com.serialpundit.serial.frame.ISerialComFrameListener;
+import com.serialpundit.serial.frame.SerialComDelimiterFrameDecoder;
+import com.serialpundit.serial.frame.SerialComFixedLengthFrameDecoder;
+import com.serialpundit.serial.frame.SerialComFrameDecoder;
+import com.serialpundit.serial.frame.SerialComFrameDecodingListener;
+import com.serialpundit.serial.frame.SerialComGapFrameDecoder;
+import com.serialpundit.serial.frame.SerialComLengthFieldFrameDecoder;
+
+// Collects frames as hex strings; decoder reuses its buffers so frame must be copied in callback.
+class FrameCollector implements ISerialComFrameListener {
+
+	final ArrayList<String> frames = new ArrayList<String>();
+
+	@Override
+	public synchronized void onNewSerialFrame(byte[] buffer, int offset, int length) {
+		frames.add(SerialComUtil.byteArrayToHexString(Arrays.copyOfRange(buffer, offset, offset + length), null));
+	}
+
+	@Override
+	public void onDataListenerError(int errorNum) {
+		System.out.println("onDataListenerError : " + errorNum);
+	}
+
+	synchronized String get() {
+		return frames.toString();
+	}
+}
+
+// Verifies frame decoders with frames split across chunks, invalid/oversize frames and timing based
+// Modbus RTU framing, without any serial port.
+public class Test97 {
+
+	static int failures = 0;
+
+	static void check(String name, String expected, String actual) {
+		if(expected.equals(actual)) {
+			System.out.println("PASS : " + name);
+		}else {
+			failures++;
+			System.out.println("FAIL : " + name + " expected " + expected + " got " + actual);
+		}
+	}
+
+	static void check(String name, long expected, long actual) {
+		check(name, Long.toString(expected), Long.toString(actual));
+	}
+
+	static byte[] ascii(String data) throws Exception {
+		return data.getBytes("US-ASCII");
+	}
+
+	static String hex(String data) throws Exception {
+		return SerialComUtil.byteArrayToHexString(ascii(data), null);
+	}
+
+	static byte[] bytes(int... values) {
+		byte[] data = new byte[values.length];
+		for(int x = 0; x < values.length; x++) {
+			data[x] = (byte) values[x];
+		}
+		return data;
+	}
+
+	// feeds data to decoder in chunks of given sizes, last chunk takes rest of data.
+	static String feed(SerialComFrameDecoder decoder, byte[] data, int... chunks) {
+		FrameCollector collector = new FrameCollector();
+		int offset = 0;
+		for(int x = 0; (x < chunks.length) && (offset < data.length); x++) {
+			int length = Math.min(chunks[x], data.length - offset);
+			decoder.decode(data, offset, length, collector);
+			offset += length;
+		}
+		if(offset < data.length) {
+			decoder.decode(data, offset, data.length - offset, collector);
+		}
+		return collector.get();
+	}
+
+	static int[] ones(int count) {
+		int[] chunks = new int[count];
+		Arrays.fill(chunks, 1);
+		return chunks;
+	}
+
+	public static void main(String[] args) {
+		try {
+			/* delimiter decoder */
+
+			byte[] crlf = ascii("\r\n");
+			byte[] lines = ascii("ABC\r\nDEF\r\nGHI\r\n");
+			String expected = "[" + hex("ABC") + ", " + hex("DEF") + ", " + hex("GHI") + "]";
+			// delimiter split between chunks, and every other split point
+			check("delimiter split across chunks", expected, feed(new SerialComDelimiterFrameDecoder(crlf, true, 16), lines, 4, 7, 3));
+			for(int split = 0; split <= lines.length; split++) {
+				check("delimiter, split at " + split, expected, feed(new SerialComDelimiterFrameDecoder(crlf, true, 16), lines, split));
+			}
+			check("delimiter, byte by byte", expected, feed(new SerialComDelimiterFrameDecoder(crlf, true, 16), lines, ones(lines.length)));
+			check("delimiter kept in frame", "[" + hex("ABC\r\n") + ", " + hex("DEF\r\n") + ", " + hex("GHI\r\n") + "]",
+					feed(new SerialComDelimiterFrameDecoder(crlf, false, 16), lines, 4, 7));
+
+			// resynchronization after a frame longer than maxFrameLength, in one chunk and across chunks
+			byte[] oversize = ascii("0123456789AB\nOK\n");
+			SerialComDelimiterFrameDecoder delimiter = new SerialComDelimiterFrameDecoder(ascii("\n"), true, 8);
+			check("oversize frame in one chunk", "[" + hex("OK") + "]", feed(delimiter, oversize));
+			check("oversize frame in one chunk discarded bytes", 13, delimiter.getDiscardedBytes());
+			delimiter = new SerialComDelimiterFrameDecoder(ascii("\n"), true, 8);
+			check("oversize frame across chunks", "[" + hex("OK") + "]", feed(delimiter, oversize, 5, 5));
+			check("oversize frame across chunks discarded bytes", 13, delimiter.getDiscardedBytes());
+			delimiter = new SerialComDelimiterFrameDecoder(ascii("\n"), true, 8);
+			check("oversize frame byte by byte", "[" + hex("OK") + "]", feed(delimiter, oversize, ones(oversize.length)));
+			check("nothing pending after resync", 0, delimiter.getPendingBytes());
+
+			/* length field decoder, [0x7E][LEN][payload of LEN bytes][CRC16] */
+
+			byte[] frames = bytes(0x7E, 0x03, 0x01, 0x02, 0x03, 0xC1, 0xC2, 0x7E, 0x00, 0xD1, 0xD2);
+			expected = "[7E03010203C1C2, 7E00D1D2]";
+			for(int split = 0; split <= frames.length; split++) {
+				check("length field, split at " + split, expected, feed(new SerialComLengthFieldFrameDecoder(16, 1, 1, false, 2), frames, split));
+			}
+			check("length field, byte by byte", expected, feed(new SerialComLengthFieldFrameDecoder(16, 1, 1, false, 2), frames, ones(frames.length)));
+
+			// headers giving length more than maxFrameLength are skipped byte by byte
+			byte[] garbage = bytes(0xF0, 0xF1, 0xF2, 0x7E, 0x03, 0x01, 0x02, 0x03, 0xC1, 0xC2);
+			SerialComLengthFieldFrameDecoder lengthField = new SerialComLengthFieldFrameDecoder(16, 1, 1, false, 2);
+			check("bad length field headers", "[7E03010203C1C2]", feed(lengthField, garbage));
+			check("bad length field headers discarded bytes", 3, lengthField.getDiscardedBytes());
+			lengthField = new SerialComLengthFieldFrameDecoder(16, 1, 1, false, 2);
+			check("bad length field headers byte by byte", "[7E03010203C1C2]", feed(lengthField, garbage, ones(garbage.length)));
+			check("bad length field headers byte by byte discarded bytes", 3, lengthField.getDiscardedBytes());
+
+			// big endian 2 byte length field counting whole frame, headers giving length less than header are skipped
+			byte[] wholeLength = bytes(0x00, 0x00, 0x00, 0x05, 0xAA, 0xBB, 0xCC, 0x00, 0x04, 0xDD, 0xEE);
+			lengthField = new SerialComLengthFieldFrameDecoder(32, 0, 2, true, -2);
+			check("length field less than header", "[0005AABBCC, 0004DDEE]", feed(lengthField, wholeLength, 3, 2));
+			check("length field less than header discarded bytes", 2, lengthField.getDiscardedBytes());
+
+			/* fixed length decoder */
+
+			check("fixed length across chunks", "[" + hex("ABC") + ", " + hex("DEF") + ", " + hex("GHI") + "]",
+					feed(new SerialComFixedLengthFrameDecoder(3), ascii("ABCDEFGHI"), 2, 3));
+
+			/* gap decoder, character time 1 ms and gap 3.5 ms, times are in ms below */
+
+			final long ms = 1000000L;
+			SerialComGapFrameDecoder gap = new SerialComGapFrameDecoder(16, 3500000L);
+			FrameCollector collector = new FrameCollector();
+			byte[] frameA = bytes(0x01, 0x03, 0x00, 0x00, 0x00, 0x02, 0xC4, 0x0B);
+			byte[] frameB = bytes(0x01, 0x03, 0x04, 0x00);
+			// frame A in 2 chunks, last byte of first chunk at 3 and of second at 8. Second chunk's first
+			// byte came at 4, only 1 character time after, so it is same frame.
+			gap.decode(frameA, 0, 3, 3 * ms, collector);
+			gap.decode(frameA, 3, 5, 8 * ms, collector);
+			check("gap, chunked frame not split", "[]", collector.get());
+			check("gap, chunked frame pending", 8, gap.getPendingBytes());
+			// frame B starts at 14, 6 ms after frame A ended
+			gap.decode(frameB, 0, 4, 17 * ms, collector);
+			check("gap, previous frame delivered when next arrives", "[010300000002C40B]", collector.get());
+			check("gap, idle deadline", (17 * ms) + 3500000L, gap.getIdleDeadline());
+			check("gap, not idle before gap", 0, gap.flushIfIdle(20 * ms, collector) ? 1 : 0);
+			check("gap, last frame delivered when idle", 1, gap.flushIfIdle(21 * ms, collector) ? 1 : 0);
+			check("gap, both frames", "[010300000002C40B, 01030400]", collector.get());
+
+			// oversize frame is dropped completely, also its tail, and next frame after gap is fine
+			gap = new SerialComGapFrameDecoder(4, 3500000L, ms);
+			collector = new FrameCollector();
+			gap.decode(frameA, 0, 8, 8 * ms, collector);
+			gap.decode(frameA, 0, 2, 10 * ms, collector);
+			gap.decode(frameB, 0, 4, 20 * ms, collector);
+			gap.flush(collector);
+			check("gap, oversize frame dropped", "[01030400]", collector.get());
+			check("gap, oversize frame discarded bytes", 10, gap.getDiscardedBytes());
+
+			// through listener, last frame is delivered by idle timer without any more data
+			collector = new FrameCollector();
+			SerialComFrameDecodingListener listener = new SerialComFrameDecodingListener(
+					new SerialComGapFrameDecoder(256, SerialComGapFrameDecoder.getModbusRTUFrameGap(9600)), collector);
+			listener.onNewSerialDataAvailable(frameA);
+			Thread.sleep(100);
+			check("gap, idle timer delivers last frame", "[010300000002C40B]", collector.get());
+
+			System.out.println("failures : " + failures);
+		}catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
@@ -0,0 +1,166 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package test98;
+
+import java.util.Arrays;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import com.serialpundit.serial.SerialComLeasedBuffer;
+import com.serialpundit.serial.internal.SerialComBufferPool;
+
+// All threads try to end same lease together, only one of them must succeed.
+class Releaser implements Runnable {
+
+	final SerialComLeasedBuffer buffer;
+	final long leaseId;
+	final CountDownLatch start;
+	final AtomicInteger released;
+
+	public Releaser(SerialComLeasedBuffer buffer, long leaseId, CountDownLatch start, AtomicInteger released) {
+		this.buffer = buffer;
+		this.leaseId = leaseId;
+		this.start = start;
+		this.released = released;
+	}
+
+	@Override
+	public void run() {
+		try {
+			start.await();
+			if(buffer.release(leaseId) == true) {
+				released.incrementAndGet();
+			}
+		} catch (InterruptedException e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+// Verifies lease identifiers of SerialComLeasedBuffer, that a lease ends only once whichever release method
+// is used, and that SerialComBufferPool re-uses released buffers. No serial port is needed.
+public class Test98 {
+
+	static int failures = 0;
+
+	static void check(String name, boolean passed) {
+		System.out.println((passed ? "PASS : " : "FAIL : ") + name);
+		if(passed != true) {
+			failures++;
+		}
+	}
+
+	public static void main(String[] args) {
+		try {
+			SerialComBufferPool pool = new SerialComBufferPool(16, 4);
+
+			// fresh buffer, lease id is odd while leased and becomes even once released
+			SerialComLeasedBuffer a = pool.lease(8);
+			long first = a.getLeaseId();
+			check("new buffer is pooled", a.isPooled() && (a.array().length == 16) && (a.length() == 0));
+			check("lease id odd while leased", (first & 1) == 1);
+			check("release with current lease id", a.release(first) == true);
+			check("lease id even after release", (a.getLeaseId() & 1) == 0);
+			check("second release with same lease id does nothing", a.release(first) == false);
+			a.release();
+			check("release() after lease ended does nothing", (a.getLeaseId() & 1) == 0);
+
+			// released buffer is given again once, with a new lease id and cleared length/timestamp
+			a.setLength(5);
+			a.setTimestamp(1234);
+			SerialComLeasedBuffer b = pool.lease(8);
+			check("released buffer re-used", b == a);
+			check("new lease has new id", (b.getLeaseId() != first) && ((b.getLeaseId() & 1) == 1));
+			check("new lease starts empty", (b.length() == 0) && (b.getTimestamp() == 0));
+			SerialComLeasedBuffer c = pool.lease(8);
+			check("buffer recycled only once though released twice", c != a);
+
+			// stale lease id must not end the new owner's lease
+			long second = b.getLeaseId();
+			check("stale lease id rejected", b.release(first) == false);
+			check("new lease still active", b.getLeaseId() == second);
+			SerialComLeasedBuffer d = pool.lease(8);
+			check("buffer not recycled by stale release", (d != b) && (d != c));
+			b.release();
+			check("release() ends current lease", b.release(second) == false);
+			c.release();
+			d.release();
+
+			// buffer bigger than pool's buffer size is not pooled but release semantics are same
+			SerialComLeasedBuffer big = pool.lease(100);
+			long bigLease = big.getLeaseId();
+			check("big buffer not pooled", (big.isPooled() == false) && (big.array().length == 100));
+			check("big buffer released once", (big.release(bigLease) == true) && (big.release(bigLease) == false));
+
+			// lease with copy
+			byte[] data = new byte[] { 0x10, 0x20, 0x30, 0x40, 0x50 };
+			SerialComLeasedBuffer copy = pool.lease(data, 1, 3);
+			check("leased copy length", copy.length() == 3);
+			check("leased copy data", Arrays.equals(new byte[] { 0x20, 0x30, 0x40 }, copy.toByteArray()));
+			data[2] = 0;
+			check("leased copy independent of source", copy.array()[1] == 0x30);
+			try {
+				copy.setLength(17);
+				check("length more than capacity rejected", false);
+			}catch (IllegalArgumentException e) {
+				check("length more than capacity rejected", true);
+			}
+			copy.release();
+
+			// at the most maxPooled free buffers are kept
+			SerialComBufferPool small = new SerialComBufferPool(16, 2);
+			SerialComLeasedBuffer[] leased = new SerialComLeasedBuffer[3];
+			for(int x = 0; x < 3; x++) {
+				leased[x] = small.lease(16);
+			}
+			for(int x = 0; x < 3; x++) {
+				leased[x].release();
+			}
+			int reused = 0;
+			for(int x = 0; x < 3; x++) {
+				SerialComLeasedBuffer next = small.lease(16);
+				if((next == leased[0]) || (next == leased[1]) || (next == leased[2])) {
+					reused++;
+				}
+			}
+			check("only maxPooled buffers retained", reused == 2);
+
+			// racing releases of same lease, exactly one wins every time
+			int wrong = 0;
+			for(int round = 0; round < 1000; round++) {
+				SerialComLeasedBuffer shared = pool.lease(8);
+				long leaseId = shared.getLeaseId();
+				CountDownLatch start = new CountDownLatch(1);
+				AtomicInteger released = new AtomicInteger(0);
+				Thread[] threads = new Thread[4];
+				for(int x = 0; x < threads.length; x++) {
+					threads[x] = new Thread(new Releaser(shared, leaseId, start, released));
+					threads[x].start();
+				}
+				start.countDown();
+				for(int x = 0; x < threads.length; x++) {
+					threads[x].join();
+				}
+				if(released.get() != 1) {
+					wrong++;
+				}
+			}
+			check("concurrent release(leaseId) ends lease exactly once", wrong == 0);
+
+			System.out.println("failures : " + failures);
+		}catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
@@ -0,0 +1,194 @@
+/*
+ * This file is part of SerialPundit.
+ *
+ * Copyright (C) 2014-2020, Rishi Gupta. All rights reserved.
+ *
+ * The SerialPundit is DUAL LICENSED. It is made available under the terms of the GNU Affero
+ * General Public License (AGPL) v3.0 for non-commercial use and under the terms of a commercial
+ * license for commercial use of this software.
+ *
+ * The SerialPundit is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+package test99;
+
+import java.util.Arrays;
+
+import com.serialpundit.core.SerialComPlatform;
+import com.serialpundit.core.SerialComSystemProperty;
+import com.serialpundit.serial.SerialComInByteStream;
+import com.serialpundit.serial.SerialComManager;
+import com.serialpundit.serial.SerialComManager.BAUDRATE;
+import com.serialpundit.serial.SerialComManager.DATABITS;
+import com.serialpundit.serial.SerialComManager.FLOWCONTROL;
+import com.serialpundit.serial.SerialComManager.PARITY;
+import com.serialpundit.serial.SerialComManager.SMODE;
+import com.serialpundit.serial.SerialComManager.STOPBITS;
+import com.serialpundit.serial.SerialComOutByteStream;
+
+// Reads given number of bytes from input stream while other thread is writing, so that receiver's
+// buffer does not overflow when a large amount of data is sent.
+class Receiver implements Runnable {
+
+	final SerialComInByteStream in;
+	final byte[] data;
+	final long timeout;
+	int count = 0;
+
+	public Receiver(SerialComInByteStream in, int length, long timeout) {
+		this.in = in;
+		this.data = new byte[length];
+		this.timeout = timeout;
+	}
+
+	@Override
+	public void run() {
+		try {
+			long deadline = System.currentTimeMillis() + timeout;
+			while((count < data.length) && (System.currentTimeMillis() < deadline)) {
+				int ret = in.read(data, count, data.length - count);
+				if(ret > 0) {
+					count += ret;
+				}else {
+					Thread.sleep(1);
+				}
+			}
+		} catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}
+
+// Verifies write buffer of SerialComOutByteStream and sending of data which native layer writes partially,
+// using two ports connected through null modem cable (or null modem emulator). Data written on PORT is
+// read back on PORT1.
+public final class Test99 {
+
+	static int failures = 0;
+
+	static void check(String name, boolean passed) {
+		System.out.println((passed ? "PASS : " : "FAIL : ") + name);
+		if(passed != true) {
+			failures++;
+		}
+	}
+
+	static byte[] pattern(int length, int seed) {
+		byte[] data = new byte[length];
+		for(int x = 0; x < length; x++) {
+			data[x] = (byte) ((x * 31) + seed);
+		}
+		return data;
+	}
+
+	static byte[] receive(SerialComInByteStream in, int length) throws Exception {
+		Receiver receiver = new Receiver(in, length, 2000);
+		receiver.run();
+		return Arrays.copyOf(receiver.data, receiver.count);
+	}
+
+	static boolean nothingArrives(SerialComInByteStream in) throws Exception {
+		Thread.sleep(200);
+		return in.available() == 0;
+	}
+
+	public static void main(String[] args) {
+		try {
+			SerialComManager scm = new SerialComManager();
+			SerialComPlatform scp = new SerialComPlatform(new SerialComSystemProperty());
+
+			String PORT = null;
+			String PORT1 = null;
+			int osType = scp.getOSType();
+			if(osType == SerialComPlatform.OS_LINUX) {
+				PORT = "/dev/ttyUSB0";
+				PORT1 = "/dev/ttyUSB1";
+			}else if(osType == SerialComPlatform.OS_WINDOWS) {
+				PORT = "COM51";
+				PORT1 = "COM52";
+			}else if(osType == SerialComPlatform.OS_MAC_OS_X) {
+				PORT = "/dev/cu.usbserial-A70362A3";
+				PORT1 = "/dev/cu.usbserial-A602RDCH";
+			}else if(osType == SerialComPlatform.OS_SOLARIS) {
+				PORT = null;
+				PORT1 = null;
+			}else{
+			}
+
+			long handle = scm.openComPort(PORT, true, true, true);
+			scm.configureComPortData(handle, DATABITS.DB_8, STOPBITS.SB_1, PARITY.P_NONE, BAUDRATE.B115200, 0);
+			scm.configureComPortControl(handle, FLOWCONTROL.NONE, 'x', 'x', false, false);
+			long handle1 = scm.openComPort(PORT1, true, true, true);
+			scm.configureComPortData(handle1, DATABITS.DB_8, STOPBITS.SB_1, PARITY.P_NONE, BAUDRATE.B115200, 0);
+			scm.configureComPortControl(handle1, FLOWCONTROL.NONE, 'x', 'x', false, false);
+
+			SerialComOutByteStream out = (SerialComOutByteStream) scm.getIOStreamInstance(SerialComManager.OutputStream, handle, SMODE.NONBLOCKING);
+			SerialComInByteStream in = (SerialComInByteStream) scm.getIOStreamInstance(SerialComManager.InputStream, handle1, SMODE.NONBLOCKING);
+
+			// small writes are held in write buffer until flush, in the order they were written
+			out.setWriteBufferSize(64);
+			check("write buffer size", out.getWriteBufferSize() == 64);
+			byte[] hello = "HELLO WORLD".getBytes("US-ASCII");
+			out.write(hello[0]);
+			out.write(hello, 1, 4);
+			out.write(hello[5]);
+			out.write(Arrays.copyOfRange(hello, 6, 11));
+			check("buffered bytes not sent before flush", nothingArrives(in));
+			out.flush();
+			check("buffered bytes sent in order on flush", Arrays.equals(hello, receive(in, hello.length)));
+
+			// when next write does not fit, buffered bytes are sent and new bytes start the buffer
+			byte[] chunks = pattern(70, 1);
+			for(int x = 0; x < chunks.length; x += 10) {
+				out.write(chunks, x, 10);
+			}
+			check("full buffer sent when next write does not fit", Arrays.equals(Arrays.copyOf(chunks, 60), receive(in, 60)));
+			check("last write still buffered", nothingArrives(in));
+			out.flush();
+			check("last write sent on flush", Arrays.equals(Arrays.copyOfRange(chunks, 60, 70), receive(in, 10)));
+
+			// write larger than buffer is sent directly, after bytes already buffered
+			byte[] head = pattern(5, 2);
+			byte[] large = pattern(200, 3);
+			out.write(head);
+			out.write(large);
+			byte[] expected = new byte[205];
+			System.arraycopy(head, 0, expected, 0, 5);
+			System.arraycopy(large, 0, expected, 5, 200);
+			check("buffered bytes sent before large write", Arrays.equals(expected, receive(in, 205)));
+
+			// disabling buffer and closing stream both send pending bytes
+			byte[] pending = pattern(20, 4);
+			out.write(pending);
+			out.setWriteBufferSize(0);
+			check("pending bytes sent when buffer disabled", Arrays.equals(pending, receive(in, 20)));
+			out.setWriteBufferSize(32);
+			out.write(pending, 0, 7);
+			out.close();
+			check("pending bytes sent on close", Arrays.equals(Arrays.copyOf(pending, 7), receive(in, 7)));
+
+			// in non-blocking mode native layer sends only what fits in output buffer, so a write much larger
+			// than it is sent in several native calls. Every byte must arrive exactly once and in order.
+			out = (SerialComOutByteStream) scm.getIOStreamInstance(SerialComManager.OutputStream, handle, SMODE.NONBLOCKING);
+			byte[] bulk = pattern(65536, 5);
+			Receiver receiver = new Receiver(in, bulk.length, 20000);
+			Thread t = new Thread(receiver);
+			t.start();
+			long start = System.currentTimeMillis();
+			out.write(bulk);
+			t.join(25000);
+			System.out.println("large write time (ms) : " + (System.currentTimeMillis() - start));
+			check("partially written data sent completely in order", (receiver.count == bulk.length) && Arrays.equals(bulk, receiver.data));
+
+			out.close();
+			in.close();
+			scm.closeComPort(handle);
+			scm.closeComPort(handle1);
+
+			System.out.println("failures : " + failures);
+		} catch (Exception e) {
+			e.printStackTrace();
+		}
+	}
+}